@@ -0,0 +1,26 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <QGuiApplication>
+
+
+int main(int argc, char ** argv) {
+    
+    // pixmaps need a GUI application, but the benchmarks must run without a display
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+    QGuiApplication application{argc, argv};
+    
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    
+    return 0;
+}
@@ -0,0 +1,150 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <rpgmapper/layer/tile_layer.hpp>
+#include <rpgmapper/tile/tile_factory.hpp>
+#include <rpgmapper/field.hpp>
+#include <rpgmapper/map.hpp>
+
+using namespace rpgmapper::model;
+using namespace rpgmapper::model::tile;
+
+
+/**
+ * Fills the first tile layer of a map with a square of color tiles.
+ *
+ * @param   map         the map to fill.
+ * @param   side        number of fields along each side of the square.
+ * @return  the tile layer filled.
+ */
+static layer::TileLayer & fillTileLayer(Map & map, int side) {
+    
+    auto & layer = *map.getLayers().getTileLayers().front();
+    for (int y = 0; y < side; ++y) {
+        for (int x = 0; x < side; ++x) {
+            auto field = FieldPointer{new Field{x, y}};
+            field->getTiles().push_back(TileFactory::create(TileType::color, {{"color", "#ff0000"}}));
+            layer.addField(field);
+        }
+    }
+    return layer;
+}
+
+
+static void TileLayerAddField(benchmark::State & state) {
+    
+    auto side = static_cast<int>(state.range(0));
+    for (auto _ : state) {
+        Map map{"bench"};
+        fillTileLayer(map, side);
+    }
+    state.SetItemsProcessed(state.iterations() * side * side);
+}
+BENCHMARK(TileLayerAddField)->Arg(16)->Arg(64)->Arg(256);
+
+
+static void TileLayerGetField(benchmark::State & state) {
+    
+    auto side = static_cast<int>(state.range(0));
+    Map map{"bench"};
+    auto & layer = fillTileLayer(map, side);
+    
+    int i = 0;
+    for (auto _ : state) {
+        auto field = layer.getField(i % side, (i / side) % side);
+        benchmark::DoNotOptimize(field);
+        ++i;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(TileLayerGetField)->Arg(16)->Arg(64)->Arg(256);
+
+
+static void TileLayerRemoveField(benchmark::State & state) {
+    
+    auto side = static_cast<int>(state.range(0));
+    for (auto _ : state) {
+        state.PauseTiming();
+        Map map{"bench"};
+        auto & layer = fillTileLayer(map, side);
+        state.ResumeTiming();
+        for (int y = 0; y < side; ++y) {
+            for (int x = 0; x < side; ++x) {
+                layer.removeField(x, y);
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * side * side);
+}
+BENCHMARK(TileLayerRemoveField)->Arg(16)->Arg(64)->Arg(256);
+
+
+static void TileLayerIterate(benchmark::State & state) {
+    
+    auto side = static_cast<int>(state.range(0));
+    Map map{"bench"};
+    auto & layer = fillTileLayer(map, side);
+    
+    for (auto _ : state) {
+        std::size_t tiles = 0;
+        for (auto const & pair : layer.getFields()) {
+            tiles += pair.second->getTiles().size();
+        }
+        benchmark::DoNotOptimize(tiles);
+    }
+    state.SetItemsProcessed(state.iterations() * side * side);
+}
+BENCHMARK(TileLayerIterate)->Arg(16)->Arg(64)->Arg(256);
+
+
+static void TileLayerEncode(benchmark::State & state) {
+    
+    auto side = static_cast<int>(state.range(0));
+    Map map{"bench"};
+    auto & layer = fillTileLayer(map, side);
+    
+    for (auto _ : state) {
+        auto json = layer.getJSON();
+        benchmark::DoNotOptimize(json);
+    }
+    state.SetItemsProcessed(state.iterations() * side * side);
+}
+BENCHMARK(TileLayerEncode)->Arg(256)->Arg(1000)->Unit(benchmark::kMillisecond);
+
+
+static void TileLayerDecode(benchmark::State & state) {
+    
+    auto side = static_cast<int>(state.range(0));
+    Map map{"bench"};
+    auto json = fillTileLayer(map, side).getJSON();
+    
+    for (auto _ : state) {
+        Map loadedMap{"bench"};
+        loadedMap.getLayers().getTileLayers().front()->applyJSON(json);
+    }
+    state.SetItemsProcessed(state.iterations() * side * side);
+    state.counters["bytes"] = json["fields"].toString().size();
+}
+BENCHMARK(TileLayerDecode)->Arg(256)->Arg(1000)->Unit(benchmark::kMillisecond);
+
+
+static void FieldIsTilePresent(benchmark::State & state) {
+    
+    auto tiles = static_cast<int>(state.range(0));
+    Field field{0, 0};
+    for (int i = 0; i < tiles; ++i) {
+        auto color = QString{"#%1"}.arg(i, 6, 16, QChar{'0'});
+        field.getTiles().push_back(TileFactory::create(TileType::color, {{"color", color}}));
+    }
+    auto missing = TileFactory::create(TileType::color, {{"color", "#fedcba"}});
+    
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(field.isTilePresent(missing.data()));
+    }
+}
+BENCHMARK(FieldIsTilePresent)->Arg(1)->Arg(4)->Arg(16);
@@ -0,0 +1,72 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <rpgmapper/resource/shape.hpp>
+#include <rpgmapper/numerals.hpp>
+
+using namespace rpgmapper::model;
+using namespace rpgmapper::model::resource;
+
+
+/**
+ * A small but not trivial SVG, similar to the shipped shapes.
+ */
+static QByteArray const SHAPE_SVG{R"(<?xml version="1.0" encoding="UTF-8"?>
+<svg xmlns="http://www.w3.org/2000/svg" width="100" height="100" viewBox="0 0 100 100">
+    <rect x="0" y="0" width="100" height="100" fill="#808080"/>
+    <path d="M10,10 L90,10 L90,90 L10,90 Z M30,30 L70,30 L70,70 L30,70 Z" fill="#303030" fill-rule="evenodd"/>
+    <circle cx="50" cy="50" r="15" fill="#c0c0c0" stroke="#000000" stroke-width="2"/>
+</svg>)"};
+
+
+/**
+ * Numeral converters benchmarked.
+ */
+static char const * NUMERAL_METHODS[] = {"numeric", "alphaSmall", "alphaBig", "roman"};
+
+
+static void ShapePrepareCached(benchmark::State & state) {
+    
+    auto tileSize = static_cast<unsigned int>(state.range(0));
+    auto rotation = static_cast<double>(state.range(1));
+    Shape shape{"/shapes/bench.svg", SHAPE_SVG};
+    shape.getPixmap(tileSize, rotation);
+    
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(shape.getPixmap(tileSize, rotation));
+    }
+}
+BENCHMARK(ShapePrepareCached)->ArgsProduct({{16, 48, 128}, {0, 45, 90}});
+
+
+static void ShapeRender(benchmark::State & state) {
+    
+    auto tileSize = static_cast<unsigned int>(state.range(0));
+    auto rotation = static_cast<double>(state.range(1));
+    
+    for (auto _ : state) {
+        Shape shape{"/shapes/bench.svg", SHAPE_SVG};
+        benchmark::DoNotOptimize(shape.getImage(tileSize, rotation));
+    }
+}
+BENCHMARK(ShapeRender)->ArgsProduct({{16, 48, 128}, {0, 45, 90}});
+
+
+static void NumeralConvert(benchmark::State & state) {
+    
+    auto method = NUMERAL_METHODS[state.range(0)];
+    auto converter = NumeralConverter::create(method);
+    state.SetLabel(method);
+    
+    int value = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(converter->convert(value));
+        value = (value + 1) % 1000;
+    }
+}
+BENCHMARK(NumeralConvert)->DenseRange(0, 3);
@@ -0,0 +1,97 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <QFile>
+#include <QStringList>
+#include <QTemporaryDir>
+
+#include <rpgmapper/atlas.hpp>
+#include <rpgmapper/map.hpp>
+#include <rpgmapper/region.hpp>
+#include <rpgmapper/session.hpp>
+
+using namespace rpgmapper::model;
+
+
+/**
+ * Creates a session with a number of regions each holding a number of maps.
+ *
+ * The session becomes the current session, as resources are resolved through it.
+ *
+ * @param   regions     number of regions to create.
+ * @param   maps        number of maps per region.
+ * @return  the new session.
+ */
+static SessionPointer createSession(int regions, int maps) {
+    
+    auto session = Session::init();
+    Session::setCurrentSession(session);
+    for (int r = 0; r < regions; ++r) {
+        auto region = RegionPointer{new Region{QString{"Region %1"}.arg(r)}};
+        session->getAtlas()->addRegion(region);
+        for (int m = 0; m < maps; ++m) {
+            region->addMap(MapPointer{new Map{QString{"Map %1-%2"}.arg(r).arg(m)}});
+        }
+    }
+    return session;
+}
+
+
+static void SessionFindMap(benchmark::State & state) {
+    
+    auto regions = static_cast<int>(state.range(0));
+    auto session = createSession(regions, 10);
+    auto name = QString{"Map %1-%2"}.arg(regions - 1).arg(9);
+    
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(session->findMap(name));
+    }
+}
+BENCHMARK(SessionFindMap)->Arg(1)->Arg(10)->Arg(100);
+
+
+static void AtlasWrite(benchmark::State & state) {
+    
+    auto session = createSession(static_cast<int>(state.range(0)), 10);
+    QTemporaryDir directory;
+    QFile file{directory.filePath("bench.atlas")};
+    
+    for (auto _ : state) {
+        QStringList log;
+        if (!session->save(file, log)) {
+            state.SkipWithError("Failed to write atlas.");
+            break;
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * file.size());
+}
+BENCHMARK(AtlasWrite)->Arg(1)->Arg(10)->Arg(50);
+
+
+static void AtlasRead(benchmark::State & state) {
+    
+    auto session = createSession(static_cast<int>(state.range(0)), 10);
+    QTemporaryDir directory;
+    QFile file{directory.filePath("bench.atlas")};
+    QStringList log;
+    if (!session->save(file, log)) {
+        state.SkipWithError("Failed to write atlas.");
+        return;
+    }
+    
+    for (auto _ : state) {
+        SessionPointer loaded;
+        log.clear();
+        if (!Session::load(loaded, file, log)) {
+            state.SkipWithError("Failed to read atlas.");
+            break;
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * file.size());
+}
+BENCHMARK(AtlasRead)->Arg(1)->Arg(10)->Arg(50);
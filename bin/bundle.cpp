@@ -0,0 +1,82 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#include <iostream>
+
+#include <boost/program_options.hpp>
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+
+#include <rpgmapper/resource/resource_bundle.hpp>
+
+using namespace rpgmapper::model::resource;
+
+
+#define PROGRAM_DESCRIPTION "\
+Packs a resource folder into a single indexed resource bundle.\n\
+Installed next to the system resources, the bundle replaces the folder scan at startup."
+
+
+int main(int argc, char ** argv) {
+
+    std::string applicationHeader = std::string{"rpgmapper-bundle - Dyle's RPGMapper V"} + VERSION;
+    std::string synopsis = std::string{"Usage: "} + argv[0] + " [OPTIONS] RESOURCE-FOLDER BUNDLE-FILE";
+
+    boost::program_options::options_description options{
+            applicationHeader + "\n" + PROGRAM_DESCRIPTION + "\n\n" + synopsis + "\n\nAllowed Options"};
+    options.add_options()("help,h", "this page");
+    options.add_options()("verbose,v", "print the log");
+
+    boost::program_options::options_description arguments{"Arguments"};
+    arguments.add_options()("RESOURCE-FOLDER", boost::program_options::value<std::string>(), "folder to pack");
+    arguments.add_options()("BUNDLE-FILE", boost::program_options::value<std::string>(), "bundle file to write");
+    boost::program_options::positional_options_description positionalArgumentDescriptions;
+    positionalArgumentDescriptions.add("RESOURCE-FOLDER", 1);
+    positionalArgumentDescriptions.add("BUNDLE-FILE", 1);
+
+    boost::program_options::options_description commandLineOptions{"Command Line"};
+    commandLineOptions.add(options);
+    commandLineOptions.add(arguments);
+
+    boost::program_options::variables_map programOptions;
+    try {
+        boost::program_options::command_line_parser parser{argc, reinterpret_cast<char const * const *>(argv)};
+        boost::program_options::store(
+                parser.options(commandLineOptions).positional(positionalArgumentDescriptions).run(),
+                programOptions);
+        boost::program_options::notify(programOptions);
+    }
+    catch (std::exception & exception) {
+        std::cerr << "error parsing command line: " <<  exception.what()
+                  << "\ntype '--help' for help"
+                  << std::endl;
+        return 1;
+    }
+
+    bool argumentsPresent = programOptions.count("RESOURCE-FOLDER") && programOptions.count("BUNDLE-FILE");
+    if (programOptions.count("help") || !argumentsPresent) {
+        std::cout << options << std::endl;
+        return programOptions.count("help") ? 0 : 1;
+    }
+
+    QCoreApplication application{argc, argv};
+
+    auto folder = QString::fromStdString(programOptions["RESOURCE-FOLDER"].as<std::string>());
+    auto bundleFile = QString::fromStdString(programOptions["BUNDLE-FILE"].as<std::string>());
+    QDir{}.mkpath(QFileInfo{bundleFile}.absolutePath());
+
+    QStringList log;
+    auto success = ResourceBundle::write(bundleFile, folder, log);
+    for (auto const & line : log) {
+        if (!success || programOptions.count("verbose")) {
+            (success ? std::cout : std::cerr) << line.toStdString() << std::endl;
+        }
+    }
+
+    return success ? 0 : 1;
+}
@@ -0,0 +1,113 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#include <iostream>
+
+#include <boost/program_options.hpp>
+
+#include <QCoreApplication>
+#include <QFile>
+
+#include <rpgmapper/resource/resource_loader.hpp>
+#include <rpgmapper/atlas_generator.hpp>
+#include <rpgmapper/session.hpp>
+
+using namespace rpgmapper::model;
+using namespace rpgmapper::model::resource;
+
+
+#define PROGRAM_DESCRIPTION "\
+Generates large synthetic atlases for benchmarks and stress tests.\n\
+The same options always create the same atlas."
+
+
+int main(int argc, char ** argv) {
+
+    AtlasGenerator::Settings settings;
+    std::string resources = SOURCE_PATH "/share/rpgmapper";
+    int width = settings.mapSize.width();
+    int height = settings.mapSize.height();
+
+    std::string applicationHeader = std::string{"rpgmapper-generate - Dyle's RPGMapper V"} + VERSION;
+    std::string synopsis = std::string{"Usage: "} + argv[0] + " [OPTIONS] ATLAS-FILE";
+
+    boost::program_options::options_description options{
+            applicationHeader + "\n" + PROGRAM_DESCRIPTION + "\n\n" + synopsis + "\n\nAllowed Options"};
+    options.add_options()("help,h", "this page");
+    options.add_options()("seed,s", boost::program_options::value(&settings.seed), "random seed");
+    options.add_options()("regions,r", boost::program_options::value(&settings.regions), "number of regions");
+    options.add_options()("maps,m", boost::program_options::value(&settings.mapsPerRegion), "maps per region");
+    options.add_options()("width", boost::program_options::value(&width), "width of each map");
+    options.add_options()("height", boost::program_options::value(&height), "height of each map");
+    options.add_options()("base-density", boost::program_options::value(&settings.baseDensity),
+                          "ratio of fields with a base shape [0.0, 1.0]");
+    options.add_options()("tile-density", boost::program_options::value(&settings.tileDensity),
+                          "ratio of fields with tile shapes [0.0, 1.0]");
+    options.add_options()("stack", boost::program_options::value(&settings.maxTilesPerField),
+                          "maximum tile shapes stacked on a field");
+    options.add_options()("resources", boost::program_options::value(&resources),
+                          "folder holding the 'resources' folder with the shapes to use");
+
+    boost::program_options::options_description arguments{"Arguments"};
+    arguments.add_options()("ATLAS-FILE", boost::program_options::value<std::string>(), "atlas file to write");
+    boost::program_options::positional_options_description positionalArgumentDescriptions;
+    positionalArgumentDescriptions.add("ATLAS-FILE", 1);
+
+    boost::program_options::options_description commandLineOptions{"Command Line"};
+    commandLineOptions.add(options);
+    commandLineOptions.add(arguments);
+
+    boost::program_options::variables_map programOptions;
+    try {
+        boost::program_options::command_line_parser parser{argc, reinterpret_cast<char const * const *>(argv)};
+        boost::program_options::store(
+                parser.options(commandLineOptions).positional(positionalArgumentDescriptions).run(),
+                programOptions);
+        boost::program_options::notify(programOptions);
+    }
+    catch (std::exception & exception) {
+        std::cerr << "error parsing command line: " <<  exception.what()
+                  << "\ntype '--help' for help"
+                  << std::endl;
+        return 1;
+    }
+
+    if (programOptions.count("help") || (programOptions.count("ATLAS-FILE") != 1)) {
+        std::cout << options << std::endl;
+        return programOptions.count("help") ? 0 : 1;
+    }
+    settings.mapSize = QSize{width, height};
+
+    QCoreApplication application{argc, argv};
+    Session::setCurrentSession(Session::init());
+
+    QStringList log;
+    ResourceLoader loader{nullptr};
+    loader.setUserFolders({QString::fromStdString(resources)});
+    loader.load(log);
+
+    try {
+        AtlasGenerator generator{settings};
+        Session::getCurrentSession()->getAtlas() = generator.generate(log);
+    }
+    catch (std::exception & exception) {
+        std::cerr << "failed to generate atlas: " << exception.what() << std::endl;
+        return 1;
+    }
+    for (auto const & line : log) {
+        std::cout << line.toStdString() << std::endl;
+    }
+
+    QFile file{QString::fromStdString(programOptions["ATLAS-FILE"].as<std::string>())};
+    if (!Session::getCurrentSession()->save(file, log)) {
+        for (auto const & line : log) {
+            std::cerr << line.toStdString() << std::endl;
+        }
+        return 1;
+    }
+
+    return 0;
+}
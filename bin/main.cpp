@@ -9,9 +9,16 @@
 #include <boost/program_options.hpp>
 
 #include <QApplication>
+#include <QFile>
 #include <QPixmapCache>
+#include <QStandardPaths>
 
+#include <rpgmapper/resource/raster_cache.hpp>
+#include <rpgmapper/atlas.hpp>
+#include <rpgmapper/map.hpp>
+#include <rpgmapper/region.hpp>
 #include <rpgmapper/session.hpp>
+#include <rpgmapper/trace.hpp>
 
 #include "mainwindow.hpp"
 #include "startupdialog.hpp"
@@ -27,6 +34,15 @@ Licenseed under the GNU General Public License 3\n\
 See: http://www.gnu.org/licenses/ for details."
 
 
+/**
+ * Loads an atlas file and prints the estimated memory usage of the session to stdout.
+ *
+ * @param   fileName            the atlas file to load.
+ * @return  the program exit code.
+ */
+int dumpMemoryReport(QString const & fileName);
+
+
 /**
  * Parses the command line arguments.
  *
@@ -45,7 +61,7 @@ int main(int argc, char ** argv) {
         return 0;
     }
 
-    if (programOptions.count("ATLAS-FILE") == 1) {
+    if ((programOptions.count("ATLAS-FILE") == 1) && (programOptions.count("memory-report") == 0)) {
         // TODO: remove this once we can load an atlas file from the cmd line
         std::cerr << "TO BE IMPLEMENTED: LOAD ATLAS FROM CMD-LINE: "
                   << programOptions["ATLAS-FILE"].as<std::string>()
@@ -61,6 +77,25 @@ int main(int argc, char ** argv) {
     QPixmapCache::insert("region", QPixmap(":/icons/gfx/region.png"));
     QPixmapCache::insert("map", QPixmap(":/icons/gfx/map.png"));
     
+    if (programOptions.count("memory-report")) {
+        if (programOptions.count("ATLAS-FILE") != 1) {
+            std::cerr << "--memory-report needs an ATLAS-FILE" << std::endl;
+            return 1;
+        }
+        return dumpMemoryReport(QString::fromStdString(programOptions["ATLAS-FILE"].as<std::string>()));
+    }
+    
+    QString traceFile;
+    if (programOptions.count("trace") == 1) {
+        traceFile = QString::fromStdString(programOptions["trace"].as<std::string>());
+        Trace::enable();
+    }
+    
+    auto cacheFolder = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (!cacheFolder.isEmpty()) {
+        resource::RasterCache::setFolder(cacheFolder + "/shapes");
+    }
+    
     Session::setCurrentSession(Session::init());
     
     rpgmapper::view::MainWindow mainWindow;
@@ -68,7 +103,41 @@ int main(int argc, char ** argv) {
     startupDialog.show();
     
     application.setQuitOnLastWindowClosed(true);
-    return application.exec();
+    auto result = application.exec();
+    
+    if (!traceFile.isEmpty() && !Trace::writeChromeTrace(traceFile)) {
+        std::cerr << "failed to write trace file: " << traceFile.toStdString() << std::endl;
+    }
+    
+    return result;
+}
+
+
+int dumpMemoryReport(QString const & fileName) {
+    
+    QFile file{fileName};
+    QStringList log;
+    SessionPointer session;
+    if (!Session::load(session, file, log)) {
+        std::cerr << "failed to load atlas file: " << fileName.toStdString() << std::endl;
+        for (auto const & line : log) {
+            std::cerr << line.toStdString() << std::endl;
+        }
+        return 1;
+    }
+    Session::setCurrentSession(session);
+    
+    // maps are loaded lazily: the report covers the atlas as a whole
+    for (auto const & regionPair : session->getAtlas()->getRegions()) {
+        for (auto const & mapPair : regionPair.second->getMaps()) {
+            mapPair.second->load(log);
+        }
+    }
+    
+    for (auto const & line : session->getMemoryReport().toStringList()) {
+        std::cout << line.toStdString() << std::endl;
+    }
+    return 0;
 }
 
 
@@ -82,6 +151,9 @@ bool parseCommandLine(boost::program_options::variables_map & programOptions, in
             applicationHeader + description + "\n\n" + synopsis + "\n\nAllowed Options"};
     options.add_options()("help,h", "this page");
     options.add_options()("version,v", "print version string");
+    options.add_options()("trace", boost::program_options::value<std::string>()->value_name("FILE"),
+                          "record a Chrome trace-event JSON file (see chrome://tracing)");
+    options.add_options()("memory-report", "print the estimated memory usage of ATLAS-FILE and quit");
 
     boost::program_options::options_description arguments{"Arguments"};
     arguments.add_options()("ATLAS-FILE", "atlas file to open");
@@ -50,8 +50,22 @@ MainWindow::MainWindow() : QMainWindow{} {
     ui = std::make_shared<Ui_mainwindow>();
     ui->setupUi(this);
     
+    atlasLoader = new rpgmapper::model::AtlasLoader{this};
+    
+    resourceWatcher = new rpgmapper::model::resource::ResourceWatcher{this};
+    connect(resourceWatcher, &rpgmapper::model::resource::ResourceWatcher::resourcesChanged,
+            this, &MainWindow::reloadedResources);
+    
     zoomSlider = new ZoomSlider{this};
     ui->mainToolBar->insertWidget(ui->actionShowAxis, zoomSlider);
+    
+    shapeSearchLineEdit = new QLineEdit{this};
+    shapeSearchLineEdit->setPlaceholderText(tr("Search shapes..."));
+    shapeSearchLineEdit->setClearButtonEnabled(true);
+    ui->shapesDockWidgetContentLayout->insertWidget(0, shapeSearchLineEdit);
+    shapeSearchResults = new ShapeCatalogWidget{this};
+    shapeSearchResults->setVisible(false);
+    ui->shapesDockWidgetContentLayout->insertWidget(1, shapeSearchResults);
 
     coordinatesWidget = new CoordinatesWidget{this};
     statusBar()->addPermanentWidget(coordinatesWidget);
@@ -99,6 +113,7 @@ void MainWindow::addRecentFileName(QString const & fileName) {
 void MainWindow::applyResources() {
     mapPropertiesDialog->collectBackgroundImages();
     ui->shapeToolBox->applyResources();
+    searchShapes(shapeSearchLineEdit->text());
     ui->colorPickerDockWidgetContents->loadPalettes();
 }
 
@@ -181,6 +196,7 @@ void MainWindow::connectActions() {
     connect(ui->actionZoomMapOut, &QAction::triggered, zoomSlider, &ZoomSlider::decrease);
     
     connect(ui->actionViewResources, &QAction::triggered, this, &MainWindow::showResourcesViewDialog);
+    connect(ui->actionShowMemoryReport, &QAction::triggered, this, &MainWindow::showMemoryReportDialog);
     connect(ui->actionViewMap, &QAction::triggered, this, &MainWindow::viewCurrentMap);
     connect(ui->actionViewColorPicker, &QAction::triggered, this, &MainWindow::visibleColorPicker);
     connect(ui->actionViewMinimap, &QAction::triggered, this, &MainWindow::visibleMinimap);
@@ -195,6 +211,8 @@ void MainWindow::connectActions() {
     
     connect(ui->actionShowAxis, &QAction::toggled, this, &MainWindow::toogleCurrentAxisVisibility);
     connect(ui->actionShowGrid, &QAction::toggled, this, &MainWindow::toogleCurrentGridVisibility);
+    connect(ui->actionShowRenderStatistics, &QAction::toggled,
+            this, &MainWindow::toogleCurrentRenderStatisticsVisibility);
 
     connect(ui->atlasTreeWidget, &StructuralTreeWidget::doubleClickedAtlas,
             ui->actionShowAtlasProperties, &QAction::trigger);
@@ -214,6 +232,13 @@ void MainWindow::connectActions() {
     connect(ui->colorPickerDockWidgetContents, &ColorChooserWidget::colorSelected, this, &MainWindow::colorSelected);
     
     connect(ui->shapeToolBox, &ShapeCatalogsBox::shapeSelected, this, &MainWindow::shapeSelected);
+    connect(shapeSearchLineEdit, &QLineEdit::textChanged, this, &MainWindow::searchShapes);
+    
+    connect(atlasLoader, &AtlasLoader::progress, this, &MainWindow::loadProgress);
+    connect(atlasLoader, &AtlasLoader::finished, this, &MainWindow::loadedAtlas);
+    connect(atlasLoader, &AtlasLoader::failed, this, &MainWindow::loadAtlasFailed);
+    connect(loadProgressDialog, &QProgressDialog::canceled, atlasLoader, &AtlasLoader::cancel);
+    connect(shapeSearchResults, &ShapeCatalogWidget::shapeSelected, this, &MainWindow::shapeSelected);
     
     connect(zoomSlider, &ZoomSlider::zoomChanged, this, &MainWindow::zoomChanged);
 }
@@ -474,6 +499,7 @@ void MainWindow::enableActions() {
     auto mapWidget = getCurrentMapWidget();
     ui->actionShowAxis->setEnabled(mapWidget);
     ui->actionShowGrid->setEnabled(mapWidget);
+    ui->actionShowRenderStatistics->setEnabled(mapWidget);
     
     enableZoomActions();
     enableRotateActions();
@@ -509,10 +535,12 @@ void MainWindow::enableZoomActions() {
     auto zoomOutPossible = false;
     if (mapWidget) {
         zoomSlider->setTileSize(mapWidget->getTileSize());
+        ui->shapeToolBox->setTileSize(mapWidget->getTileSize());
         zoomInPossible = zoomSlider->isZoomInPossible();
         zoomOutPossible = zoomSlider->isZoomOutPossible();
         ui->actionShowAxis->setChecked(mapWidget->isAxisVisible());
         ui->actionShowGrid->setChecked(mapWidget->isGridVisible());
+        ui->actionShowRenderStatistics->setChecked(mapWidget->isRenderStatisticsVisible());
     }
     
     ui->actionZoomMapIn->setEnabled(zoomInPossible);
@@ -548,30 +576,52 @@ void MainWindow::load() {
 
 
 void MainWindow::loadAtlas(QString fileName) {
-
-    QFile file{fileName};
-    QStringList log;
     
-    SessionPointer newSession;
-    if (!Session::load(newSession, file, log)) {
-        logDialog->setWindowTitle(tr("Load atlas failure"));
-        logDialog->clear();
-        logDialog->setMessage(tr("Failed to load atlas file."));
-        logDialog->setLog(log);
-        logDialog->exec();
+    if (!atlasLoader->start(fileName)) {
+        return;
     }
-    else {
     
-        Session::setCurrentSession(newSession);
-        applyResources();
-        
-        ui->mapTabWidget->removeAllMaps();
-        ui->atlasTreeWidget->resetStructure();
-        connectModelSignals();
-        setApplicationWindowTitle();
-        
-        addRecentFileName(fileName);
+    loadProgressDialog->reset();
+    loadProgressDialog->setLabelText(tr("Loading %1 ...").arg(QFileInfo{fileName}.fileName()));
+    loadProgressDialog->setRange(0, 0);
+    loadProgressDialog->setValue(0);
+}
+
+
+void MainWindow::loadAtlasFailed(QStringList log, bool cancelled) {
+    
+    loadProgressDialog->reset();
+    if (cancelled) {
+        return;
     }
+    
+    logDialog->setWindowTitle(tr("Load atlas failure"));
+    logDialog->clear();
+    logDialog->setMessage(tr("Failed to load atlas file."));
+    logDialog->setLog(log);
+    logDialog->exec();
+}
+
+
+void MainWindow::loadedAtlas(SessionPointer session, UNUSED QStringList log) {
+    
+    loadProgressDialog->reset();
+    
+    Session::setCurrentSession(session);
+    applyResources();
+    
+    ui->mapTabWidget->removeAllMaps();
+    ui->atlasTreeWidget->resetStructure();
+    connectModelSignals();
+    setApplicationWindowTitle();
+    
+    addRecentFileName(atlasLoader->getFileName());
+}
+
+
+void MainWindow::loadProgress(int done, int total) {
+    loadProgressDialog->setRange(0, total);
+    loadProgressDialog->setValue(done);
 }
 
 
@@ -631,6 +681,14 @@ void MainWindow::redo() {
 }
 
 
+void MainWindow::reloadedResources() {
+    applyResources();
+    for (auto mapWidget : ui->mapTabWidget->findChildren<MapWidget *>()) {
+        mapWidget->update();
+    }
+}
+
+
 void MainWindow::rotateTileLeft() {
     
     auto session = Session::getCurrentSession();
@@ -737,6 +795,26 @@ void MainWindow::saveSettingsWindow(QSettings & settings) {
 }
 
 
+void MainWindow::searchShapes(QString const & query) {
+    
+    if (query.trimmed().isEmpty()) {
+        shapeSearchResults->setVisible(false);
+        ui->shapeToolBox->setVisible(true);
+        return;
+    }
+    
+    std::vector<std::pair<QString, QString>> shapes;
+    for (auto const & match : ui->shapeToolBox->search(query)) {
+        shapes.emplace_back(match.shapeName, match.shapePath);
+    }
+    shapeSearchResults->setShapes(shapes);
+    shapeSearchResults->renderIcons();
+    
+    ui->shapeToolBox->setVisible(false);
+    shapeSearchResults->setVisible(true);
+}
+
+
 void MainWindow::selectedTile() {
     
     auto session = Session::getCurrentSession();
@@ -775,6 +853,13 @@ void MainWindow::setupDialogs() {
     loadAtlasDialog->setDirectory(recentAtlasFolderName);
 
     logDialog = new LogDialog(this);
+    
+    loadProgressDialog = new QProgressDialog{this};
+    loadProgressDialog->setWindowTitle(tr("Load Atlas file"));
+    loadProgressDialog->setWindowModality(Qt::WindowModal);
+    loadProgressDialog->setMinimumDuration(250);
+    loadProgressDialog->setAutoReset(false);
+    loadProgressDialog->reset();
 
     mapPropertiesDialog = new MapPropertiesDialog(this);
     
@@ -821,6 +906,18 @@ void MainWindow::showCoordinates(int x, int y) {
 }
 
 
+void MainWindow::showMemoryReportDialog() {
+    
+    auto report = Session::getCurrentSession()->getMemoryReport();
+    
+    logDialog->setWindowTitle(tr("Memory Report"));
+    logDialog->clear();
+    logDialog->setMessage(tr("Estimated memory used by the current session."));
+    logDialog->setLog(report.toStringList());
+    logDialog->exec();
+}
+
+
 void MainWindow::showResourcesViewDialog() {
     resourcesViewDialog->exec();
 }
@@ -860,6 +957,14 @@ void MainWindow::toogleCurrentGridVisibility() {
 }
 
 
+void MainWindow::toogleCurrentRenderStatisticsVisibility() {
+    auto mapWidget = getCurrentMapWidget();
+    if (mapWidget) {
+        mapWidget->setRenderStatisticsVisible(ui->actionShowRenderStatistics->isChecked());
+    }
+}
+
+
 void MainWindow::undo() {
     auto session = Session::getCurrentSession();
     auto processer = session->getCommandProcessor();
@@ -901,11 +1006,17 @@ void MainWindow::visibleTiles(bool visible) {
 }
 
 
+void MainWindow::watchResources(QStringList const & folders) {
+    resourceWatcher->watch(folders);
+}
+
+
 void MainWindow::zoomChanged() {
     
     auto mapWidget = getCurrentMapWidget();
     if (mapWidget) {
         mapWidget->setTileSize(zoomSlider->getTileSize());
+        ui->shapeToolBox->setTileSize(zoomSlider->getTileSize());
         ui->actionZoomMapIn->setEnabled(zoomSlider->isZoomInPossible());
         ui->actionZoomMapOut->setEnabled(zoomSlider->isZoomOutPossible());
     }
@@ -10,15 +10,21 @@
 #include <memory>
 
 #include <QFileDialog>
+#include <QLineEdit>
 #include <QMainWindow>
+#include <QProgressDialog>
 #include <QSettings>
 
+#include <rpgmapper/resource/resource_watcher.hpp>
+#include <rpgmapper/atlas_loader.hpp>
+
 #include "aboutdialog.hpp"
 #include "coordinateswidget.hpp"
 #include "logdialog.hpp"
 #include "mappropertiesdialog.hpp"
 #include "mapwidget.hpp"
 #include "resourcesviewdialog.hpp"
+#include "shapecatalogwidget.hpp"
 #include "zoomslider.hpp"
 
 
@@ -53,6 +59,14 @@ class MainWindow : public QMainWindow {
     CoordinatesWidget * coordinatesWidget = nullptr;            /**< Pre-created coordinate widgets. */
     
     ZoomSlider * zoomSlider = nullptr;                          /**< Map Widget Zoom Slider */
+    
+    QLineEdit * shapeSearchLineEdit = nullptr;                  /**< Search field of the shapes dock. */
+    ShapeCatalogWidget * shapeSearchResults = nullptr;          /**< Shapes found, replacing the catalogs while searching. */
+    
+    rpgmapper::model::resource::ResourceWatcher * resourceWatcher = nullptr;   /**< Reloads changed user resources. */
+    
+    rpgmapper::model::AtlasLoader * atlasLoader = nullptr;      /**< Loads atlas files in the background. */
+    QProgressDialog * loadProgressDialog = nullptr;             /**< Shows the progress of loading an atlas. */
 
 public:
 
@@ -67,6 +81,13 @@ public:
      * @return  true, if the user enabled the erase action instead of placing tiles.
      */
     bool isEraseEnabled() const;
+    
+    /**
+     * Reloads resources as they change in the given folders.
+     *
+     * @param   folders     the user resource folders loaded at startup.
+     */
+    void watchResources(QStringList const & folders);
 
 public slots:
     
@@ -143,6 +164,11 @@ public slots:
      */
     void showCoordinates(int x, int y);
     
+    /**
+     * Shows the estimated memory usage of the current session.
+     */
+    void showMemoryReportDialog();
+    
     /**
      * Show the resources view dialog.
      */
@@ -158,6 +184,11 @@ public slots:
      */
     void toogleCurrentGridVisibility();
     
+    /**
+     * Switches the visibility of the render statistics of the current map widget
+     */
+    void toogleCurrentRenderStatisticsVisibility();
+    
     /**
      * Undo the last command.
      */
@@ -256,7 +287,10 @@ private:
     MapWidget * getCurrentMapWidget();
     
     /**
-     * Loads an atlas.
+     * Starts loading an atlas in the background.
+     *
+     * The current session stays in place until the atlas has been loaded.
+     *
      * @param   fileName        the filename to load
      */
     void loadAtlas(QString fileName);
@@ -342,10 +376,39 @@ private slots:
      */
     void executedCommand();
     
+    /**
+     * Some user resources have been reloaded.
+     */
+    void reloadedResources();
+    
     /**
      * Load action.
      */
     void load();
+    
+    /**
+     * Loading an atlas failed or has been cancelled.
+     *
+     * @param   log             the protocol of the load.
+     * @param   cancelled       true, if the user cancelled the load.
+     */
+    void loadAtlasFailed(QStringList log, bool cancelled);
+    
+    /**
+     * An atlas has been loaded: swap in its session.
+     *
+     * @param   session         the session holding the atlas loaded.
+     * @param   log             the protocol of the load.
+     */
+    void loadedAtlas(rpgmapper::model::SessionPointer session, QStringList log);
+    
+    /**
+     * Shows the progress of loading an atlas.
+     *
+     * @param   done            number of entries of the atlas file read so far.
+     * @param   total           total number of entries of the atlas file.
+     */
+    void loadProgress(int done, int total);
 
     /**
      * Loads the last used file.
@@ -366,6 +429,13 @@ private slots:
      */
     bool saveAs();
     
+    /**
+     * The user typed into the shape search field: shows the shapes found instead of the catalogs.
+     *
+     * @param   query       the text of the search field.
+     */
+    void searchShapes(QString const & query);
+    
     /**
      * The user selected a new tile.
      */
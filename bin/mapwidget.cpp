@@ -4,10 +4,13 @@
  * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
  */
 
+#include <chrono>
+#include <map>
 #include <utility>
 
 #include <QApplication>
 #include <QMouseEvent>
+#include <QStringList>
 
 #include <rpgmapper/command/erase_field.hpp>
 #include <rpgmapper/command/place_tile.hpp>
@@ -15,6 +18,7 @@
 #include <rpgmapper/layer/layer.hpp>
 #include <rpgmapper/tile/tile.hpp>
 #include <rpgmapper/coordinate_system.hpp>
+#include <rpgmapper/render_statistics.hpp>
 #include <rpgmapper/session.hpp>
 
 #include "mainwindow.hpp"
@@ -39,6 +43,7 @@ MapWidget::MapWidget(QWidget * parent)
           tileSize{STANDARD_TILE_SIZE},
           axisVisible{true},
           gridVisible{true},
+          renderStatisticsVisible{false},
           hoveredTilePosition{-1, -1} {
     
     setFocusPolicy(Qt::StrongFocus);
@@ -46,36 +51,13 @@ MapWidget::MapWidget(QWidget * parent)
 }
 
 
-std::list<Layer const *> MapWidget::collectVisibleLayers() const {
+std::list<std::pair<QString, Layer const *>> MapWidget::collectVisibleLayers() const {
     
     if (!map || !map->isValid()) {
         throw std::runtime_error("Invalid map to render.");
     }
 
-    auto const & layerStack = map->getLayers();
-    
-    std::list<Layer const *> layers;
-    
-    layers.push_back(layerStack.getBackgroundLayer().data());
-    
-    for (auto & baseLayer : layerStack.getBaseLayers()) {
-        layers.push_back(baseLayer.data());
-    }
-    
-    if (isGridVisible()) {
-        layers.push_back(layerStack.getGridLayer().data());
-    }
-    
-    if (isAxisVisible()) {
-        layers.push_back(layerStack.getAxisLayer().data());
-    }
-    
-    for (auto & tileLayer : layerStack.getTileLayers()) {
-        layers.push_back(tileLayer.data());
-    }
-    layers.push_back(layerStack.getTextLayer().data());
-    
-    return layers;
+    return map->getLayers().getVisibleLayers(isGridVisible(), isAxisVisible());
 }
 
 
@@ -105,6 +87,40 @@ void MapWidget::drawHoveredTile(QPainter & painter) {
 }
 
 
+void MapWidget::drawRenderStatistics(QPainter & painter) {
+    
+    auto report = RenderStatistics::getReport();
+    
+    QStringList lines;
+    lines << QString{"frame p50/p95/p99: %1 / %2 / %3 ms (%4 frames)"}
+            .arg(report.frameMillisecondsP50, 0, 'f', 2)
+            .arg(report.frameMillisecondsP95, 0, 'f', 2)
+            .arg(report.frameMillisecondsP99, 0, 'f', 2)
+            .arg(report.frames);
+    for (auto const & pair : report.layerMilliseconds) {
+        lines << QString{"layer %1: %2 ms"}.arg(pair.first).arg(pair.second, 0, 'f', 2);
+    }
+    lines << QString{"fields drawn/visited: %1 / %2"}.arg(report.fieldsDrawn).arg(report.fieldsVisited);
+    lines << QString{"shape cache hit rate: %1 % (%2 misses)"}
+            .arg(report.getShapeCacheHitRate() * 100.0, 0, 'f', 1)
+            .arg(report.shapeCacheMisses);
+    lines << QString{"pixmaps resident: %1 KiB"}.arg(report.pixmapBytes / 1024);
+    
+    painter.save();
+    painter.resetTransform();
+    painter.setClipping(false);
+    
+    auto text = lines.join("\n");
+    auto topLeft = visibleRegion().boundingRect().topLeft() + QPoint{8, 8};
+    auto textRect = painter.fontMetrics().boundingRect(QRect{topLeft, QSize{1000, 1000}}, Qt::AlignLeft, text);
+    painter.fillRect(textRect.adjusted(-4, -4, 4, 4), QColor{0, 0, 0, 160});
+    painter.setPen(Qt::white);
+    painter.drawText(textRect, Qt::AlignLeft, text);
+    
+    painter.restore();
+}
+
+
 void MapWidget::eraseField() {
     
     if (!map || !map->isValid()) {
@@ -212,26 +228,39 @@ void MapWidget::mouseReleaseEvent(QMouseEvent *event) {
 
 void MapWidget::paintEvent(QPaintEvent * event) {
 
-    auto start = std::chrono::system_clock::now();
+    using Clock = std::chrono::steady_clock;
+    using Milliseconds = std::chrono::duration<float, std::milli>;
+    
+    auto start = Clock::now();
+    RenderStatistics::beginFrame();
 
     QWidget::paintEvent(event);
 
     QPainter painter(this);
     painter.setRenderHint(QPainter::Antialiasing);
+    painter.setClipRect(event->rect());
     
     if (!map || !map->isValid()) {
         throw std::runtime_error("Invalid map to render.");
     }
 
-    for (auto layer : collectVisibleLayers()) {
-        layer->draw(painter, getTileSize());
+    std::map<QString, float> layerTimes;
+    for (auto const & pair : collectVisibleLayers()) {
+        auto layerStart = Clock::now();
+        pair.second->draw(painter, getTileSize());
+        layerTimes[pair.first] += Milliseconds{Clock::now() - layerStart}.count();
+    }
+    for (auto const & pair : layerTimes) {
+        RenderStatistics::addLayerTime(pair.first, pair.second);
     }
     
     drawHoveredTile(painter);
 
-    auto end = std::chrono::system_clock::now();
-    auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
-    averagePaintDuration << milliseconds;
+    RenderStatistics::endFrame(Milliseconds{Clock::now() - start}.count());
+    
+    if (isRenderStatisticsVisible()) {
+        drawRenderStatistics(painter);
+    }
 }
 
 
@@ -282,6 +311,14 @@ void MapWidget::setGridVisible(bool visible) {
 }
 
 
+void MapWidget::setRenderStatisticsVisible(bool visible) {
+    if (isRenderStatisticsVisible() != visible) {
+        renderStatisticsVisible = visible;
+        update();
+    }
+}
+
+
 void MapWidget::setMap(rpgmapper::model::Map * map) {
     
     if (this->map == map) {
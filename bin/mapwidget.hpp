@@ -9,12 +9,12 @@
 
 #include <list>
 #include <memory>
+#include <utility>
 
 #include <QPainter>
 #include <QString>
 #include <QWidget>
 
-#include <rpgmapper/average.hpp>
 #include <rpgmapper/layer/layer.hpp>
 #include <rpgmapper/map.hpp>
 
@@ -34,14 +34,10 @@ class MapWidget : public QWidget {
     
     bool axisVisible;              /**< Visibility flag for the current axis. */
     bool gridVisible;              /**< Visibility flag for the current grid. */
+    bool renderStatisticsVisible;  /**< Visibility flag for the render statistics overlay. */
     
     QPointF hoveredTilePosition;   /**< Position of the currently hovered tile on the map (measured from top/left). */
     
-    /**
-     * This holds the average time of the time durations in milliseconds.
-     */
-    rpgmapper::model::AverageOverSize<float> averagePaintDuration;
-    
     bool leftMouseButtonDown = false;       /**< left mouse button down flag. */
     
 public:
@@ -95,6 +91,15 @@ public:
         return gridVisible;
     }
     
+    /**
+     * Checks if the render statistics overlay is currently visible on this map widget.
+     *
+     * @return  true, if the render statistics should be shown.
+     */
+    bool isRenderStatisticsVisible() const {
+        return renderStatisticsVisible;
+    }
+    
     /**
      * Shows/hides the axis.
      *
@@ -109,6 +114,13 @@ public:
      */
     void setGridVisible(bool visible);
     
+    /**
+     * Shows/hides the render statistics overlay.
+     *
+     * @param   visible         the new render statistics visibility.
+     */
+    void setRenderStatisticsVisible(bool visible);
+    
     /**
      * Sets the map to display.
      *
@@ -184,17 +196,11 @@ protected:
 private:
     
     /**
-     * Collects all layers, which are currently visible, in proper order.
+     * Collects all layers, which are currently visible, in proper order along with their names.
      *
-     * The order is:
-     *      [0] - background
-     *      [1] - base layers (maybe more than 1)
-     *      [2] - grid
-     *      [3] - axis
-     *      [4] - tile layers (maybe more than 1)
-     *      [5] - text
+     * @return  the layers to draw, bottom first.
      */
-    std::list<rpgmapper::model::layer::Layer const *> collectVisibleLayers() const;
+    std::list<std::pair<QString, rpgmapper::model::layer::Layer const *>> collectVisibleLayers() const;
     
     /**
      * Draws the hovering rectangle over a tile.
@@ -203,6 +209,13 @@ private:
      */
     void drawHoveredTile(QPainter & painter);
     
+    /**
+     * Draws the render statistics overlay in the top left corner of the visible area.
+     *
+     * @param   painter     painter used to draw.
+     */
+    void drawRenderStatistics(QPainter & painter);
+    
     /**
      * Erase all tiles under the current hovered field.
      */
@@ -4,6 +4,8 @@
  * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
  */
 
+#include <algorithm>
+
 #include <rpgmapper/resource/resource_db.hpp>
 #include <rpgmapper/resource/resource_type.hpp>
 
@@ -15,6 +17,7 @@ using namespace rpgmapper::view;
 
 
 ShapeCatalogsBox::ShapeCatalogsBox(QWidget * parent) : QToolBox{parent} {
+    connect(this, &QToolBox::currentChanged, this, &ShapeCatalogsBox::renderCurrentIcons);
 }
 
 
@@ -25,6 +28,7 @@ void ShapeCatalogsBox::addCatalog(rpgmapper::model::resource::ShapeCatalog const
     }
     
     auto shapeCatalogWidget = new ShapeCatalogWidget{this};
+    shapeCatalogWidget->setTileSize(tileSize);
     shapeCatalogWidget->setCatalog(catalog->getPath());
     addItem(shapeCatalogWidget, catalog->getName());
     
@@ -35,6 +39,7 @@ void ShapeCatalogsBox::addCatalog(rpgmapper::model::resource::ShapeCatalog const
 void ShapeCatalogsBox::applyResources() {
 
     clear();
+    updateIndex();
     
     auto shapePaths = ResourceDB::getResources(getResourcePrefixForType(ResourceType::shape));
     for (auto const & shapePath : shapePaths) {
@@ -43,6 +48,63 @@ void ShapeCatalogsBox::applyResources() {
         auto const catalog = dynamic_cast<ShapeCatalog const *>(shape.data());
         addCatalog(catalog);
     }
+    
+    // render the visible catalog now, read the shapes of the others in the background
+    renderCurrentIcons();
+    QStringList prefetchPaths;
+    for (int i = 0; i < count(); ++i) {
+        auto shapeCatalogWidget = dynamic_cast<ShapeCatalogWidget *>(widget(i));
+        if (shapeCatalogWidget && (i != currentIndex())) {
+            prefetchPaths.append(shapeCatalogWidget->getShapePaths());
+        }
+    }
+    ResourceDB::prefetch(prefetchPaths);
+}
+
+
+void ShapeCatalogsBox::renderCurrentIcons() {
+    auto shapeCatalogWidget = dynamic_cast<ShapeCatalogWidget *>(currentWidget());
+    if (shapeCatalogWidget) {
+        shapeCatalogWidget->renderIcons();
+    }
+}
+
+
+void ShapeCatalogsBox::setTileSize(int tileSize) {
+    
+    this->tileSize = static_cast<unsigned int>(std::max(tileSize, 0));
+    for (int i = 0; i < count(); ++i) {
+        auto shapeCatalogWidget = dynamic_cast<ShapeCatalogWidget *>(widget(i));
+        if (shapeCatalogWidget) {
+            shapeCatalogWidget->setTileSize(this->tileSize);
+        }
+    }
+}
+
+
+void ShapeCatalogsBox::updateIndex() {
+    
+    std::map<QString, ResourcePointer> catalogs;
+    auto shapePaths = ResourceDB::getResources(getResourcePrefixForType(ResourceType::shape));
+    for (auto const & shapePath : shapePaths) {
+        auto resource = ResourceDB::getResource(shapePath);
+        if (dynamic_cast<ShapeCatalog const *>(resource.data())) {
+            catalogs.emplace(shapePath, resource);
+        }
+    }
+    
+    for (auto const & pair : indexedCatalogs) {
+        if (catalogs.find(pair.first) == catalogs.end()) {
+            shapeIndex.removeCatalog(pair.first);
+        }
+    }
+    for (auto const & pair : catalogs) {
+        auto indexed = indexedCatalogs.find(pair.first);
+        if ((indexed == indexedCatalogs.end()) || ((*indexed).second != pair.second)) {
+            shapeIndex.addCatalog(*dynamic_cast<ShapeCatalog const *>(pair.second.data()));
+        }
+    }
+    indexedCatalogs = std::move(catalogs);
 }
 
 
@@ -7,10 +7,15 @@
 #ifndef RPGMAPPER_VIEW_SHAPECATALOGSBOX_HPP
 #define RPGMAPPER_VIEW_SHAPECATALOGSBOX_HPP
 
+#include <map>
+#include <vector>
+
 #include <QToolBox>
 #include <QString>
 
+#include <rpgmapper/resource/resource_pointer.hpp>
 #include <rpgmapper/resource/shape_catalog.hpp>
+#include <rpgmapper/resource/shape_index.hpp>
 
 
 namespace rpgmapper::view {
@@ -23,6 +28,11 @@ class ShapeCatalogsBox : public QToolBox {
 
     Q_OBJECT
     
+    unsigned int tileSize = 0;          /**< Tile size of the current map to prefetch shapes at. */
+    
+    rpgmapper::model::resource::ShapeIndex shapeIndex;                      /**< Searches the shapes of all catalogs. */
+    std::map<QString, rpgmapper::model::resource::ResourcePointer> indexedCatalogs;     /**< The catalogs indexed. */
+    
 public:
     
     /**
@@ -32,6 +42,16 @@ public:
      */
     explicit ShapeCatalogsBox(QWidget * parent = nullptr);
     
+    /**
+     * Searches the shapes of all catalogs.
+     *
+     * @param   query       what the user typed so far.
+     * @return  the shapes found, best first.
+     */
+    std::vector<rpgmapper::model::resource::ShapeIndex::Match> search(QString const & query) const {
+        return shapeIndex.search(query);
+    }
+    
 public slots:
     
     /**
@@ -43,6 +63,18 @@ public slots:
      * Delete all shape catalogs widgets
      */
     void clear();
+    
+    /**
+     * Renders the shape icons of the catalog currently shown.
+     */
+    void renderCurrentIcons();
+    
+    /**
+     * Sets the tile size of the current map, catalogs listed from now on prefetch their shapes at.
+     *
+     * @param   tileSize        the tile size of the current map.
+     */
+    void setTileSize(int tileSize);
 
 private:
     
@@ -53,6 +85,13 @@ private:
      */
     void addCatalog(rpgmapper::model::resource::ShapeCatalog const * catalog);
     
+    /**
+     * Brings the search index up to date with the catalogs in the ResourceDB.
+     *
+     * Only catalogs added, replaced or removed since the last update are (re)indexed.
+     */
+    void updateIndex();
+    
 signals:
     
     /**
@@ -4,6 +4,11 @@
  * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
  */
 
+#include <QCoreApplication>
+#include <QPixmap>
+#include <QPointer>
+#include <QRunnable>
+
 #include <rpgmapper/resource/resource_db.hpp>
 #include <rpgmapper/resource/shape.hpp>
 
@@ -13,10 +18,61 @@ using namespace rpgmapper::model::resource;
 using namespace rpgmapper::view;
 
 
+/**
+ * Rasterizes a shape for a catalog on a worker thread.
+ *
+ * The images are handed over to the shape (and the icon to the widget, if still alive)
+ * on the GUI thread.
+ */
+class IconRunnable : public QRunnable {
+    
+    QPointer<ShapeCatalogWidget> widget;        /**< The widget waiting for the icon. */
+    ResourcePointer resource;                   /**< The shape to rasterize. */
+    unsigned int tileSize;                      /**< Tile size to prefetch as well (0 for none). */
+    
+public:
+    
+    /**
+     * Constructor.
+     *
+     * @param   widget          the widget waiting for the icon.
+     * @param   resource        the shape to rasterize.
+     * @param   tileSize        tile size to prefetch as well (0 for none).
+     */
+    IconRunnable(QPointer<ShapeCatalogWidget> widget, ResourcePointer resource, unsigned int tileSize)
+            : widget{std::move(widget)}, resource{std::move(resource)}, tileSize{tileSize} {}
+    
+    /**
+     * Rasterizes the shape and posts the images to the GUI thread.
+     */
+    void run() override {
+        
+        auto shape = dynamic_cast<Shape const *>(resource.data());
+        auto iconSize = ShapeCatalogWidget::getIconSize();
+        auto iconImage = shape->rasterize(iconSize);
+        QImage tileImage;
+        if (tileSize > 0) {
+            tileImage = shape->rasterize(tileSize);
+        }
+        
+        // the widget may be gone by then: deliver via the application object
+        QMetaObject::invokeMethod(QCoreApplication::instance(),
+                [widget = widget, resource = resource, tileSize = tileSize, iconSize, iconImage, tileImage] () {
+            auto shape = dynamic_cast<Shape const *>(resource.data());
+            shape->addImage(iconImage, iconSize);
+            shape->addImage(tileImage, tileSize);
+            if (widget) {
+                widget->applyIcon(shape->getPath(), shape->getIcon(iconSize));
+            }
+        }, Qt::QueuedConnection);
+    }
+};
+
+
 ShapeCatalogWidget::ShapeCatalogWidget(QWidget * parent) : QListWidget{parent} {
     
     setFlow(QListView::LeftToRight);
-    setIconSize(QSize{48, 48});
+    setIconSize(QSize{static_cast<int>(getIconSize()), static_cast<int>(getIconSize())});
     setMovement(QListView::Static);
     setResizeMode(QListView::Adjust);
     setSelectionRectVisible(false);
@@ -29,6 +85,31 @@ ShapeCatalogWidget::ShapeCatalogWidget(QWidget * parent) : QListWidget{parent} {
 }
 
 
+ShapeCatalogWidget::~ShapeCatalogWidget() {
+    iconPool.clear();
+    iconPool.waitForDone();
+}
+
+
+void ShapeCatalogWidget::applyIcon(QString const & shapePath, QIcon const & icon) {
+    for (auto const & pair : itemToShape) {
+        if (pair.second == shapePath) {
+            pair.first->setIcon(icon);
+        }
+    }
+}
+
+
+QStringList ShapeCatalogWidget::getShapePaths() const {
+    
+    QStringList shapePaths;
+    for (auto const & pair : itemToShape) {
+        shapePaths.append(pair.second);
+    }
+    return shapePaths;
+}
+
+
 void ShapeCatalogWidget::newShapeSelected() {
 
     auto pair = itemToShape.find(currentItem());
@@ -40,6 +121,40 @@ void ShapeCatalogWidget::newShapeSelected() {
 }
 
 
+void ShapeCatalogWidget::renderIcons() {
+    
+    if (iconsRendered) {
+        return;
+    }
+    
+    QPixmap placeholder{static_cast<int>(getIconSize()), static_cast<int>(getIconSize())};
+    placeholder.fill(Qt::transparent);
+    QIcon placeholderIcon{placeholder};
+    
+    for (auto const & pair : itemToShape) {
+        
+        auto resource = ResourceDB::getResource(pair.second);
+        auto shape = dynamic_cast<rpgmapper::model::resource::Shape *>(resource.data());
+        if (!shape) {
+            continue;
+        }
+        
+        auto prefetchTileSize = tileSize;
+        if ((prefetchTileSize == getIconSize()) || shape->isPrepared(prefetchTileSize)) {
+            prefetchTileSize = 0;
+        }
+        if (shape->isPrepared(getIconSize()) && (prefetchTileSize == 0)) {
+            pair.first->setIcon(shape->getIcon(getIconSize()));
+        }
+        else {
+            pair.first->setIcon(placeholderIcon);
+            iconPool.start(new IconRunnable{this, resource, prefetchTileSize});
+        }
+    }
+    iconsRendered = true;
+}
+
+
 void ShapeCatalogWidget::setCatalog(QString catalog) {
     
     this->catalog = catalog;
@@ -58,17 +173,23 @@ void ShapeCatalogWidget::setCatalog(QString catalog) {
 
 
 void ShapeCatalogWidget::setCatalog(rpgmapper::model::resource::ShapeCatalog * shapeCatalog) {
+    auto const & shapes = shapeCatalog->getShapes();
+    setShapes({shapes.begin(), shapes.end()});
+}
+
+
+void ShapeCatalogWidget::setShapes(std::vector<std::pair<QString, QString>> const & shapes) {
     
     clear();
     itemToShape.clear();
-    for (auto const & pair : shapeCatalog->getShapes()) {
+    iconsRendered = false;
+    for (auto const & pair : shapes) {
         
         auto resource = ResourceDB::getResource(pair.second);
         auto shape = dynamic_cast<rpgmapper::model::resource::Shape *>(resource.data());
         if (shape) {
             
             auto item = new QListWidgetItem{this};
-            item->setIcon(shape->getIcon(48));
             item->setText(pair.first);
             addItem(item);
             
@@ -8,10 +8,14 @@
 #define RPGMAPPER_VIEW_SHAPECATALOGWIDGET_HPP
 
 #include <map>
+#include <utility>
+#include <vector>
 
 #include <QListWidget>
 #include <QListWidgetItem>
 #include <QString>
+#include <QStringList>
+#include <QThreadPool>
 
 #include <rpgmapper/resource/shape_catalog.hpp>
 
@@ -28,6 +32,9 @@ class ShapeCatalogWidget : public QListWidget {
     
     QString catalog;                                        /**< The resource path to the catalog displayed. */
     std::map<QListWidgetItem *, QString> itemToShape;       /**< Holds the items and the shape paths they point to. */
+    bool iconsRendered = false;                             /**< The shape icons have been requested. */
+    unsigned int tileSize = 0;                              /**< Tile size of the current map to prefetch. */
+    QThreadPool iconPool;                                   /**< Rasterizes the icons of this widget. */
 
 public:
     
@@ -37,9 +44,59 @@ public:
      * @param   parent      Parent QWidget instance.
      */
     explicit ShapeCatalogWidget(QWidget * parent = nullptr);
+    
+    /**
+     * Destructor.
+     *
+     * Icons not yet started are dropped, the ones being rasterized are waited for.
+     */
+    ~ShapeCatalogWidget() override;
+    
+    /**
+     * Sets the icon of all items displaying a shape.
+     *
+     * @param   shapePath       the path of the shape.
+     * @param   icon            the icon of the shape.
+     */
+    void applyIcon(QString const & shapePath, QIcon const & icon);
+    
+    /**
+     * Returns the paths of all shapes displayed.
+     *
+     * @return  the shape paths of the catalog.
+     */
+    QStringList getShapePaths() const;
+    
+    /**
+     * Returns the size of the shape icons.
+     *
+     * @return  the width and height of the icons in pixel.
+     */
+    static constexpr unsigned int getIconSize() {
+        return 48;
+    }
 
 public slots:
     
+    /**
+     * Renders the shape icons, if not yet done.
+     *
+     * Icons are rendered on demand, since this reads the SVGs of all shapes in the catalog.
+     * Shapes not yet drawn show a placeholder and are rasterized on a worker pool, along
+     * with their image at the tile size of the current map. The icons are filled in as
+     * the images arrive.
+     */
+    void renderIcons();
+    
+    /**
+     * Sets the tile size of the current map to prefetch the shapes at.
+     *
+     * @param   tileSize        the tile size of the current map (0 for none).
+     */
+    void setTileSize(unsigned int tileSize) {
+        this->tileSize = tileSize;
+    }
+    
     /**
      * Sets a new shape catalog.
      *
@@ -47,6 +104,13 @@ public slots:
      */
     void setCatalog(QString catalog);
     
+    /**
+     * Displays a list of shapes, e.g. the results of a search.
+     *
+     * @param   shapes      pairs of shape name and shape path.
+     */
+    void setShapes(std::vector<std::pair<QString, QString>> const & shapes);
+    
 private:
     
     /**
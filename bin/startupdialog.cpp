@@ -36,6 +36,7 @@ StartupDialog::StartupDialog(MainWindow * mainWindow)
 
 void StartupDialog::doneGood() {
     mainWindow->applyResources();
+    mainWindow->watchResources(loader->getResourceFolders());
     mainWindow->show();
     close();
 }
@@ -65,10 +66,11 @@ void StartupDialog::loadingResource(ResourceLoader::LoadingEvent const & loading
 
 
 void StartupDialog::resourceLoaded() {
+    log = loader->getLog();
     loader->isSuccess() ? doneGood() : doneFailed();
 }
 
 
 void StartupDialog::startup() {
-    loader->load(log);
+    loader->start();
 }
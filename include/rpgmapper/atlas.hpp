@@ -12,6 +12,7 @@
 #include <QString>
 
 #include <rpgmapper/atlas_pointer.hpp>
+#include <rpgmapper/memory_report.hpp>
 #include <rpgmapper/nameable.hpp>
 #include <rpgmapper/region_pointer.hpp>
 #include <rpgmapper/regions.hpp>
@@ -65,6 +66,13 @@ public:
      * @return      a valid JSON  structure from ourselves.
      */
     QJsonObject getJSON() const override;
+
+    /**
+     * Estimates the memory held by all maps and the local resources of this atlas.
+     *
+     * @return  the memory report of this atlas.
+     */
+    MemoryReport getMemoryReport() const;
     
     /**
      * Gets a known region.
@@ -0,0 +1,50 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#ifndef RPGMAPPER_MODEL_ATLAS_CONTENT_HPP
+#define RPGMAPPER_MODEL_ATLAS_CONTENT_HPP
+
+#include <functional>
+#include <vector>
+
+#include <QJsonObject>
+#include <QString>
+
+#include <rpgmapper/resource/resource_pointer.hpp>
+#include <rpgmapper/map_entry.hpp>
+
+
+namespace rpgmapper::model {
+
+
+/**
+ * The content of an atlas file, read without creating any QObject.
+ *
+ * This is what may be read on a worker thread. The atlas itself is then created from it
+ * on the GUI thread (see Session::load()). The maps are not read: only the map index is,
+ * and the maps are loaded from their entries when needed.
+ */
+struct AtlasContent {
+    QString fileName;                                                   /**< The atlas file read. */
+    QJsonObject atlas;                                                  /**< The parsed atlas.json. */
+    std::vector<rpgmapper::model::resource::ResourcePointer> resources; /**< The local resources. */
+    std::vector<MapEntry> maps;                                         /**< The maps stored on their own. */
+};
+
+
+/**
+ * Reports the progress of reading an atlas file.
+ *
+ * Invoked with the number of zip entries read so far and the total number of entries.
+ * Returning false cancels the read.
+ */
+using AtlasReadProgress = std::function<bool(int done, int total)>;
+
+
+}
+
+
+#endif
@@ -0,0 +1,110 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#ifndef RPGMAPPER_MODEL_ATLAS_GENERATOR_HPP
+#define RPGMAPPER_MODEL_ATLAS_GENERATOR_HPP
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <QSize>
+#include <QString>
+#include <QStringList>
+
+#include <rpgmapper/atlas_pointer.hpp>
+
+
+// fwd
+namespace rpgmapper::model { class Map; }
+
+
+namespace rpgmapper::model {
+
+
+/**
+ * Generates large synthetic atlases for benchmarks, profiling and stress tests.
+ *
+ * The atlas is built through the real model: regions, maps and tiles are placed just like the
+ * user would place them. Shape tiles use the shapes currently known to the ResourceDB, so load
+ * the shipped resources first. If no shapes are known, color tiles are placed instead.
+ *
+ * The same settings (including the seed) always yield the same atlas.
+ */
+class AtlasGenerator {
+
+public:
+
+    /**
+     * The knobs of the generator.
+     */
+    struct Settings {
+        std::uint32_t seed = 0;             /**< Seed of the random number generator. */
+        int regions = 4;                    /**< Number of regions. */
+        int mapsPerRegion = 8;              /**< Number of maps in each region. */
+        QSize mapSize{100, 100};            /**< Size of each map. */
+        double baseDensity = 1.0;           /**< Ratio of fields with a base shape in [0.0, 1.0]. */
+        double tileDensity = 0.3;           /**< Ratio of fields with tile shapes in [0.0, 1.0]. */
+        int maxTilesPerField = 3;           /**< Maximum number of tile shapes stacked on a single field. */
+    };
+
+private:
+
+    Settings settings;                      /**< The settings used. */
+
+    std::vector<QString> baseShapes;        /**< Paths of all shapes targeting the base layers. */
+    std::vector<QString> tileShapes;        /**< Paths of all shapes targeting the tile layers. */
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param   settings    the settings of the atlases to generate.
+     */
+    explicit AtlasGenerator(Settings settings);
+
+    /**
+     * Generates a new atlas.
+     *
+     * @param   log         protocol of actions.
+     * @return  the generated atlas.
+     */
+    AtlasPointer generate(QStringList & log);
+
+    /**
+     * Returns the settings of this generator.
+     *
+     * @return  the settings used to generate atlases.
+     */
+    Settings const & getSettings() const {
+        return settings;
+    }
+
+private:
+
+    /**
+     * Collects the shapes known to the ResourceDB.
+     *
+     * @param   log         protocol of actions.
+     */
+    void collectShapes(QStringList & log);
+
+    /**
+     * Fills a map with tiles.
+     *
+     * @param   map         the map to fill.
+     * @param   random      the random number generator.
+     * @return  the number of tiles placed.
+     */
+    unsigned long fillMap(Map * map, std::mt19937 & random) const;
+};
+
+
+}
+
+
+#endif
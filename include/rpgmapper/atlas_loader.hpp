@@ -0,0 +1,135 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#ifndef RPGMAPPER_MODEL_ATLAS_LOADER_HPP
+#define RPGMAPPER_MODEL_ATLAS_LOADER_HPP
+
+#include <atomic>
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+
+#include <rpgmapper/atlas_content.hpp>
+#include <rpgmapper/session_pointer.hpp>
+
+
+namespace rpgmapper::model {
+
+
+/**
+ * Loads an atlas file on a worker thread.
+ *
+ * The worker streams the zip entries into their consumers (see readAtlasContent()) and
+ * reports its progress. Once done, the session is created on the thread owning the loader
+ * (the GUI thread) and handed over with finished(). The current session is not touched:
+ * the receiver swaps the new session in as a whole.
+ */
+class AtlasLoader : public QObject {
+
+    Q_OBJECT
+
+    QThreadPool pool;                           /**< Runs the worker. */
+    std::atomic<bool> cancelRequested{false};   /**< The user cancelled the load. */
+    bool running = false;                       /**< A load is in progress. */
+    QString fileName;                           /**< The atlas file loaded. */
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param   parent      parent QObject.
+     */
+    explicit AtlasLoader(QObject * parent = nullptr);
+
+    /**
+     * Destructor.
+     *
+     * Cancels a running load and waits for the worker.
+     */
+    ~AtlasLoader() override;
+
+    /**
+     * Returns the atlas file loaded (or loaded last).
+     *
+     * @return  the name of the atlas file.
+     */
+    QString const & getFileName() const {
+        return fileName;
+    }
+
+    /**
+     * Checks if a load is in progress.
+     *
+     * @return  true, if the worker has not yet reported back.
+     */
+    bool isRunning() const {
+        return running;
+    }
+
+public slots:
+
+    /**
+     * Cancels the load in progress.
+     *
+     * The worker stops at the next zip entry (or chunk of a large one) and failed() is
+     * emitted with cancelled set.
+     */
+    void cancel();
+
+    /**
+     * Starts loading an atlas file.
+     *
+     * @param   fileName    the atlas file to load.
+     * @return  true, if started (false, if a load is already in progress).
+     */
+    bool start(QString fileName);
+
+signals:
+
+    /**
+     * Loading the atlas failed or has been cancelled.
+     *
+     * @param   log         the protocol of the load.
+     * @param   cancelled   true, if the load has been cancelled.
+     */
+    void failed(QStringList log, bool cancelled);
+
+    /**
+     * The atlas has been loaded.
+     *
+     * @param   session     the new session holding the atlas.
+     * @param   log         the protocol of the load.
+     */
+    void finished(rpgmapper::model::SessionPointer session, QStringList log);
+
+    /**
+     * Progress of the load (emitted by the worker thread).
+     *
+     * @param   done        number of zip entries read so far.
+     * @param   total       total number of zip entries.
+     */
+    void progress(int done, int total);
+
+private:
+
+    /**
+     * Creates the session from the content read (on the thread of the loader).
+     *
+     * @param   content     the content read.
+     * @param   read        true, if the content has been read completely.
+     * @param   log         the protocol so far.
+     */
+    void complete(AtlasContent const & content, bool read, QStringList log);
+};
+
+
+}
+
+
+#endif
@@ -7,16 +7,51 @@
 #ifndef RPGMAPPER_MODEL_AVERAGE_HPP
 #define RPGMAPPER_MODEL_AVERAGE_HPP
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
-#include <list>
+#include <cstdint>
+#include <iterator>
+#include <vector>
 
 
 namespace rpgmapper::model {
 
 
+/**
+ * Picks the value at a percentile of a range of values (nearest rank).
+ *
+ * The range is partially reordered.
+ *
+ * @tparam  Iterator        a random access iterator.
+ * @param   begin           start of the range.
+ * @param   end             end of the range.
+ * @param   percentile      the percentile requested in [0.0, 1.0].
+ * @return  the value at the percentile (or a default value if the range is empty).
+ */
+template<typename Iterator> auto percentileOf(Iterator begin, Iterator end, double percentile) {
+    
+    using Value = typename std::iterator_traits<Iterator>::value_type;
+    
+    auto size = static_cast<std::size_t>(std::distance(begin, end));
+    if (size == 0) {
+        return Value{0};
+    }
+    percentile = std::min(std::max(percentile, 0.0), 1.0);
+    auto rank = static_cast<std::size_t>(percentile * (size - 1) + 0.5);
+    auto nth = begin + static_cast<typename std::iterator_traits<Iterator>::difference_type>(rank);
+    std::nth_element(begin, nth, end);
+    return *nth;
+}
+
+
 /**
  * This template defines a basic moving average.
  *
+ * The values are held in a ring buffer which is allocated at construction. When the ring is full,
+ * makeRoom() decides whether the oldest value is overwritten (the default) or the ring grows.
+ *
  * @tparam  T       type of the values to calculate the average.
  */
 template<typename T> class Average {
@@ -33,19 +68,28 @@ public:
         Clock::time_point timeStamp;        /**< The insertion time into the average. */
     };
 
-    using Container = std::list<Element>;                       /**< This type contains all elements. */
+    using Container = std::vector<Element>;                     /**< This type contains all elements. */
     
 protected:
 
-    mutable Container container;        /**< Holds all values. */
+    mutable Container ring;             /**< Holds all values. */
+    mutable std::size_t first = 0;      /**< Index of the oldest value in the ring. */
+    mutable std::size_t count = 0;      /**< Number of values in the ring. */
     mutable T currentSum = 0;           /**< Intermediate sum of all values. */
 
 public:
 
     /**
      * Constructor
+     *
+     * @param   capacity        maximum number of values held.
      */
-    Average() = default;
+    explicit Average(std::size_t capacity) : ring(std::max<std::size_t>(capacity, 1)) {}
+
+    /**
+     * Destructor.
+     */
+    virtual ~Average() = default;
 
     /**
      * Adds a single value.
@@ -54,7 +98,11 @@ public:
      * @return  *this
      */
     Average & add(T value) {
-        container.push_back({value, Clock::now()});
+        if (count == ring.size()) {
+            makeRoom();
+        }
+        ring[(first + count) % ring.size()] = {value, Clock::now()};
+        ++count;
         currentSum += value;
         return *this;
     }
@@ -66,17 +114,57 @@ public:
      */
     T average() const {
         trim();
-        return container.size() > 0 ? currentSum / container.size() : T{0};
+        return count > 0 ? currentSum / static_cast<T>(count) : T{0};
     }
     
     /**
-     * Returns all items known.
+     * Returns the maximum number of values this average holds.
+     *
+     * @return  the capacity of the ring buffer.
+     */
+    std::size_t capacity() const {
+        return ring.size();
+    }
+    
+    /**
+     * Returns all items known, oldest first.
      *
      * @return  all items of the average structure.
      */
-    Container const & items() const {
+    Container items() const {
         trim();
-        return container;
+        Container result;
+        result.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            result.push_back(ring[(first + i) % ring.size()]);
+        }
+        return result;
+    }
+    
+    /**
+     * Calculates the value at a certain percentile (e.g. 0.95 for p95) of all values.
+     *
+     * @param   percentile      the percentile in [0.0, 1.0].
+     * @return  the value at the given percentile.
+     */
+    T percentile(double percentile) const {
+        trim();
+        std::vector<T> values;
+        values.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            values.push_back(ring[(first + i) % ring.size()].value);
+        }
+        return percentileOf(values.begin(), values.end(), percentile);
+    }
+    
+    /**
+     * Returns the number of values currently held.
+     *
+     * @return  the number of values held.
+     */
+    std::size_t size() const {
+        trim();
+        return count;
     }
 
     /**
@@ -89,6 +177,36 @@ public:
         return currentSum;
     }
 
+protected:
+    
+    /**
+     * Removes the oldest value.
+     */
+    void dropOldest() const {
+        currentSum -= ring[first].value;
+        first = (first + 1) % ring.size();
+        --count;
+    }
+    
+    /**
+     * Doubles the capacity of the ring, keeping all values.
+     */
+    void grow() const {
+        Container grown(ring.size() * 2);
+        for (std::size_t i = 0; i < count; ++i) {
+            grown[i] = ring[(first + i) % ring.size()];
+        }
+        ring.swap(grown);
+        first = 0;
+    }
+    
+    /**
+     * Makes room for one more value in a full ring, by dropping the oldest value.
+     */
+    virtual void makeRoom() {
+        dropOldest();
+    }
+
 private:
 
     /**
@@ -105,8 +223,7 @@ template<typename T> class AverageOverSize : public Average<T> {
 
     unsigned int maxElements = 10;      /**< maximum amount of elements managed. */
 
-    using Average<T>::container;
-    using Average<T>::currentSum;
+    using Average<T>::count;
 
 public:
 
@@ -115,7 +232,7 @@ public:
      *
      * @param   maxElements     maximum Number of elements to calculate the average for.
      */
-    explicit AverageOverSize(unsigned int maxElements = 10) : maxElements{maxElements} {};
+    explicit AverageOverSize(unsigned int maxElements = 10) : Average<T>{maxElements}, maxElements{maxElements} {};
 
 private:
 
@@ -123,10 +240,8 @@ private:
      * Cuts off the excess entries.
      */
     void trim() const override {
-        while (container.size() > maxElements) {
-            auto iter = std::begin(container);
-            currentSum -= (*iter).value;
-            container.erase(std::begin(container));
+        while (count > maxElements) {
+            Average<T>::dropOldest();
         }
     }
 };
@@ -134,13 +249,18 @@ private:
 
 /**
  * This is a moving average over time.
+ *
+ * All values added within the time frame are held. The capacity given is the initial size
+ * of the ring: if more values arrive within the time frame, the ring doubles instead of
+ * dropping values not yet expired. So add() allocates only while the rate of values grows.
  */
 template<typename T> class AverageOverTime : public Average<T> {
 
     std::chrono::milliseconds maxDuration;          /**< maximum lifetime of a value in milliseconds. */
 
-    using Average<T>::container;
-    using Average<T>::currentSum;
+    using Average<T>::count;
+    using Average<T>::first;
+    using Average<T>::ring;
 
 public:
     
@@ -148,27 +268,135 @@ public:
      * Creates a moving average of all values inserted in the last milliseconds.
      *
      * @param   maxDuration     milliseconds managed by this moving average.
+     * @param   capacity        number of values expected within the time frame.
      */
-    explicit AverageOverTime(std::chrono::milliseconds maxDuration = std::chrono::milliseconds(1000))
-            : maxDuration{maxDuration} {};
+    explicit AverageOverTime(std::chrono::milliseconds maxDuration = std::chrono::milliseconds(1000),
+                             std::size_t capacity = 1024)
+            : Average<T>{capacity}, maxDuration{maxDuration} {};
 
 private:
 
+    /**
+     * Drops expired values to make room, or grows the ring if all values are in the time frame.
+     */
+    void makeRoom() override {
+        trim();
+        if (count == ring.size()) {
+            Average<T>::grow();
+        }
+    }
+
     /**
      * Cuts off values too old.
      */
     void trim() const override {
         auto oldest = Average<T>::Clock::now() - maxDuration;
-        auto header = std::begin(container);
-        while ((header != std::end(container)) && ((*header).timeStamp < oldest)) {
-            currentSum -= (*header).value;
-            container.erase(header);
-            header = std::begin(container);
+        while ((count > 0) && (ring[first].timeStamp < oldest)) {
+            Average<T>::dropOldest();
         }
     }
 };
 
 
+/**
+ * A fixed size sample window which one thread writes and any number of threads read without locks.
+ *
+ * The writer never blocks and never allocates. Readers take a snapshot of the window; a snapshot
+ * taken while the writer is active may mix samples of adjacent generations, which is fine for
+ * statistics. Only one thread may call add() at any time.
+ *
+ * @tparam  T           type of the values (must be usable with std::atomic).
+ * @tparam  Capacity    number of samples in the window.
+ */
+template<typename T, std::size_t Capacity = 1024> class ConcurrentAverage {
+
+    static_assert(Capacity > 0, "ConcurrentAverage needs a capacity.");
+
+public:
+    
+    using Snapshot = std::array<T, Capacity>;           /**< A copy of the samples held. */
+
+private:
+
+    std::array<std::atomic<T>, Capacity> samples;       /**< The ring of samples. */
+    std::atomic<std::uint64_t> written{0};              /**< Total number of samples ever written. */
+
+public:
+
+    /**
+     * Constructor.
+     */
+    ConcurrentAverage() {
+        for (auto & sample : samples) {
+            sample.store(T{0}, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Adds a value. Must only be called by the single writer.
+     *
+     * @param   value       the value to add.
+     * @return  *this
+     */
+    ConcurrentAverage & add(T value) {
+        auto index = written.load(std::memory_order_relaxed);
+        samples[index % Capacity].store(value, std::memory_order_relaxed);
+        written.store(index + 1, std::memory_order_release);
+        return *this;
+    }
+
+    /**
+     * Calculate the average of the samples in the window.
+     *
+     * @return  the average of all values held.
+     */
+    T average() const {
+        Snapshot values;
+        auto size = snapshot(values);
+        T sum{0};
+        for (std::size_t i = 0; i < size; ++i) {
+            sum += values[i];
+        }
+        return size > 0 ? sum / static_cast<T>(size) : T{0};
+    }
+
+    /**
+     * Calculates the value at a certain percentile (e.g. 0.95 for p95) of the samples in the window.
+     *
+     * @param   percentile      the percentile in [0.0, 1.0].
+     * @return  the value at the given percentile.
+     */
+    T percentile(double percentile) const {
+        Snapshot values;
+        auto size = snapshot(values);
+        return percentileOf(values.begin(), values.begin() + size, percentile);
+    }
+
+    /**
+     * Returns the number of values currently held.
+     *
+     * @return  the number of values held.
+     */
+    std::size_t size() const {
+        return static_cast<std::size_t>(std::min<std::uint64_t>(written.load(std::memory_order_acquire), Capacity));
+    }
+
+    /**
+     * Copies the samples held (in no particular order).
+     *
+     * @param   values      receives the samples.
+     * @return  the number of samples copied into values.
+     */
+    std::size_t snapshot(Snapshot & values) const {
+        auto size = this->size();
+        for (std::size_t i = 0; i < size; ++i) {
+            values[i] = samples[i].load(std::memory_order_relaxed);
+        }
+        return size;
+    }
+};
+
+
 }
 
 
@@ -187,4 +415,21 @@ template<typename T, typename U> rpgmapper::model::Average<T> & operator<<(rpgma
 }
 
 
+/**
+ * Streams any value into a concurrent moving average instance.
+ *
+ * @tparam  T           type of the moving average values.
+ * @tparam  Capacity    capacity of the moving average.
+ * @tparam  U           type of the value pushed into the average instance.
+ * @param   average     the moving average instance.
+ * @param   value       the value pushed into.
+ * @return  average instance (modified)
+ */
+template<typename T, std::size_t Capacity, typename U>
+rpgmapper::model::ConcurrentAverage<T, Capacity> & operator<<(rpgmapper::model::ConcurrentAverage<T, Capacity> & average,
+                                                              U value) {
+    return average.add(value);
+}
+
+
 #endif
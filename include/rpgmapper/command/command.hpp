@@ -41,6 +41,17 @@ public:
      */
     virtual QString getDescription() const = 0;
 
+    /**
+     * Estimates the memory this command holds for undo and redo.
+     *
+     * Commands holding more than a few plain values (e.g. replaced tiles) override this.
+     *
+     * @return  the estimated number of bytes held by this command.
+     */
+    virtual long long getMemorySize() const {
+        return static_cast<long long>(sizeof(Command)) + 64;
+    }
+
     /**
      * Undo the action, reverse the current state.
      */
@@ -61,6 +61,13 @@ public:
      */
     QString getDescription() const override;
 
+    /**
+     * Estimates the memory this command holds for undo and redo.
+     *
+     * @return  the estimated number of bytes held by this command.
+     */
+    long long getMemorySize() const override;
+
     /**
      * Executes all commands.
      */
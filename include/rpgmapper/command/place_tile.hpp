@@ -70,6 +70,13 @@ public:
      * @return  a string describing this command.
      */
     QString getDescription() const override;
+
+    /**
+     * Estimates the memory this command holds for undo and redo.
+     *
+     * @return  the estimated number of bytes held by this command.
+     */
+    long long getMemorySize() const override;
     
     /**
      * Undoes the command.
@@ -0,0 +1,106 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#ifndef RPGMAPPER_MODEL_JSON_CBOR_READER_HPP
+#define RPGMAPPER_MODEL_JSON_CBOR_READER_HPP
+
+#include <functional>
+
+#include <QByteArray>
+#include <QCborStreamReader>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QString>
+
+
+namespace rpgmapper::model::json {
+
+
+/**
+ * Helpers to read a JSON structure from a CBOR stream as it comes.
+ *
+ * A JSON target reads the keys it knows by itself and lets others build a JSON value
+ * of the parts they do not stream themselves.
+ */
+class CBORReader {
+
+public:
+
+    /**
+     * Reads a single element of an array (has to consume the element).
+     */
+    using ElementReader = std::function<bool(QCborStreamReader & reader)>;
+
+    /**
+     * Reads the value of a key of an object (has to consume the value).
+     */
+    using ValueReader = std::function<bool(QString const & key, QCborStreamReader & reader)>;
+
+    /**
+     * Constructor.
+     */
+    CBORReader() = delete;
+
+    /**
+     * Reads an array element by element.
+     *
+     * @param   reader          the CBOR stream positioned at the array.
+     * @param   readElement     reads each element.
+     * @return  true, if the array has been read.
+     */
+    static bool readArray(QCborStreamReader & reader, ElementReader const & readElement);
+
+    /**
+     * Reads a byte string (or a base64 text string, as JSON holds binary data).
+     *
+     * @param   reader          the CBOR stream positioned at the byte string.
+     * @param   data            receives the data.
+     * @return  true, if the data has been read.
+     */
+    static bool readBytes(QCborStreamReader & reader, QByteArray & data);
+
+    /**
+     * Reads an object key by key.
+     *
+     * @param   reader          the CBOR stream positioned at the object.
+     * @param   readValue       reads the value of each key.
+     * @return  true, if the object has been read.
+     */
+    static bool readObject(QCborStreamReader & reader, ValueReader const & readValue);
+
+    /**
+     * Reads an object into a JSON object.
+     *
+     * @param   reader          the CBOR stream positioned at the object.
+     * @param   json            receives the object.
+     * @return  true, if the object has been read.
+     */
+    static bool readObject(QCborStreamReader & reader, QJsonObject & json);
+
+    /**
+     * Reads a text string.
+     *
+     * @param   reader          the CBOR stream positioned at the string.
+     * @param   string          receives the string.
+     * @return  true, if the string has been read.
+     */
+    static bool readString(QCborStreamReader & reader, QString & string);
+
+    /**
+     * Reads any value into a JSON value.
+     *
+     * @param   reader          the CBOR stream positioned at the value.
+     * @param   value           receives the value.
+     * @return  true, if the value has been read.
+     */
+    static bool readValue(QCborStreamReader & reader, QJsonValue & value);
+};
+
+
+}
+
+
+#endif
@@ -0,0 +1,109 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#ifndef RPGMAPPER_MODEL_JSON_CBOR_WRITER_HPP
+#define RPGMAPPER_MODEL_JSON_CBOR_WRITER_HPP
+
+#include <QCborStreamWriter>
+
+#include <rpgmapper/json/json_writer.hpp>
+
+
+namespace rpgmapper::model::json {
+
+
+/**
+ * Writes the tokens of a JSON structure as CBOR (RFC 7049).
+ *
+ * Containers are written with indefinite length, so nothing is buffered. Binary data
+ * becomes a CBOR byte string.
+ */
+class CBORWriter final : public JSONWriter {
+
+    QCborStreamWriter writer;           /**< The CBOR stream written. */
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param   data        the buffer to append to.
+     */
+    explicit CBORWriter(QByteArray * data);
+
+    /**
+     * Constructor.
+     *
+     * @param   device      the device to write to.
+     */
+    explicit CBORWriter(QIODevice * device);
+
+    /**
+     * Starts an array.
+     */
+    void beginArray() override;
+
+    /**
+     * Starts an object.
+     */
+    void beginObject() override;
+
+    /**
+     * Ends the current array.
+     */
+    void endArray() override;
+
+    /**
+     * Ends the current object.
+     */
+    void endObject() override;
+
+    /**
+     * Writes a boolean value.
+     *
+     * @param   value       the value to write.
+     */
+    void writeBool(bool value) override;
+
+    /**
+     * Writes a CBOR byte string.
+     *
+     * @param   data        the data to write.
+     */
+    void writeBytes(QByteArray const & data) override;
+
+    /**
+     * Writes a number.
+     *
+     * @param   value       the value to write.
+     */
+    void writeDouble(double value) override;
+
+    /**
+     * Writes the key of the next value of the current object.
+     *
+     * @param   key         the key to write.
+     */
+    void writeKey(QString const & key) override;
+
+    /**
+     * Writes a null value.
+     */
+    void writeNull() override;
+
+    /**
+     * Writes a string value.
+     *
+     * @param   value       the value to write.
+     */
+    void writeString(QString const & value) override;
+};
+
+
+}
+
+
+#endif
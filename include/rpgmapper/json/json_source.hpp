@@ -9,6 +9,8 @@
 
 #include <QJsonObject>
 
+#include <rpgmapper/json/json_writer.hpp>
+
 
 namespace rpgmapper::model::json {
 
@@ -27,6 +29,16 @@ public:
      * @return      a valid JSON  structure from ourselves.
      */
     virtual QJsonObject getJSON() const = 0;
+    
+    /**
+     * Writes ourselves as a stream of JSON tokens.
+     *
+     * The default writes getJSON(). Sources holding bulky data override this to write
+     * their parts directly without building a JSON structure first.
+     *
+     * @param   writer      the writer receiving the tokens.
+     */
+    virtual void writeJSON(JSONWriter & writer) const;
 };
 
 
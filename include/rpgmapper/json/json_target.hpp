@@ -7,6 +7,7 @@
 #ifndef RPGMAPPER_MODEL_JSON_JSON_TARGET_HPP
 #define RPGMAPPER_MODEL_JSON_JSON_TARGET_HPP
 
+#include <QCborStreamReader>
 #include <QJsonObject>
 
 
@@ -27,6 +28,17 @@ public:
      * @return  true, if the found values in the JSON data has been applied.
      */
     virtual bool applyJSON(QJsonObject const & json) = 0;
+    
+    /**
+     * Applies a JSON object read from a CBOR stream to this instance.
+     *
+     * The default reads the whole object and calls applyJSON(). Targets holding bulky
+     * data override this to consume their parts directly from the stream.
+     *
+     * @param   reader      the CBOR stream positioned at the object.
+     * @return  true, if the object has been read and applied.
+     */
+    virtual bool readCBOR(QCborStreamReader & reader);
 };
 
 
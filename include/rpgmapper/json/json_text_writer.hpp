@@ -0,0 +1,120 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#ifndef RPGMAPPER_MODEL_JSON_JSON_TEXT_WRITER_HPP
+#define RPGMAPPER_MODEL_JSON_JSON_TEXT_WRITER_HPP
+
+#include <vector>
+
+#include <QIODevice>
+
+#include <rpgmapper/json/json_writer.hpp>
+
+
+namespace rpgmapper::model::json {
+
+
+/**
+ * Writes the tokens of a JSON structure as compact JSON text (UTF-8).
+ *
+ * Each token goes to the device as it comes, so no document is held in memory. Binary
+ * data becomes a base64 string.
+ */
+class JSONTextWriter final : public JSONWriter {
+
+    QIODevice * device;                 /**< The device written to. */
+    std::vector<bool> firstValue;       /**< Per open container: nothing written into it yet. */
+    bool keyWritten = false;            /**< A key has been written, its value is next. */
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param   device      the device to write to (opened for writing).
+     */
+    explicit JSONTextWriter(QIODevice * device);
+
+    /**
+     * Starts an array.
+     */
+    void beginArray() override;
+
+    /**
+     * Starts an object.
+     */
+    void beginObject() override;
+
+    /**
+     * Ends the current array.
+     */
+    void endArray() override;
+
+    /**
+     * Ends the current object.
+     */
+    void endObject() override;
+
+    /**
+     * Writes a boolean value.
+     *
+     * @param   value       the value to write.
+     */
+    void writeBool(bool value) override;
+
+    /**
+     * Writes binary data as base64 string.
+     *
+     * @param   data        the data to write.
+     */
+    void writeBytes(QByteArray const & data) override;
+
+    /**
+     * Writes a number (not finite numbers become null, as JSON has none).
+     *
+     * @param   value       the value to write.
+     */
+    void writeDouble(double value) override;
+
+    /**
+     * Writes the key of the next value of the current object.
+     *
+     * @param   key         the key to write.
+     */
+    void writeKey(QString const & key) override;
+
+    /**
+     * Writes a null value.
+     */
+    void writeNull() override;
+
+    /**
+     * Writes a string value.
+     *
+     * @param   value       the value to write.
+     */
+    void writeString(QString const & value) override;
+
+private:
+
+    /**
+     * Writes the separator in front of a key or value, if any.
+     */
+    void writeSeparator();
+
+    /**
+     * Writes a value token.
+     *
+     * @param   text        the text of the value.
+     */
+    void writeToken(QByteArray const & text);
+};
+
+
+}
+
+
+#endif
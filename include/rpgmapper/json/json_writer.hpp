@@ -0,0 +1,107 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#ifndef RPGMAPPER_MODEL_JSON_JSON_WRITER_HPP
+#define RPGMAPPER_MODEL_JSON_JSON_WRITER_HPP
+
+#include <QByteArray>
+#include <QJsonValue>
+#include <QString>
+
+
+namespace rpgmapper::model::json {
+
+
+/**
+ * A JSONWriter receives a JSON structure token by token.
+ *
+ * This lets a JSON source stream itself without building a QJsonObject first. What the
+ * tokens are turned into (JSON text, CBOR, ...) is up to the writer.
+ */
+class JSONWriter {
+
+public:
+
+    /**
+     * Destructor.
+     */
+    virtual ~JSONWriter() = default;
+
+    /**
+     * Starts an array.
+     */
+    virtual void beginArray() = 0;
+
+    /**
+     * Starts an object: keys and values follow.
+     */
+    virtual void beginObject() = 0;
+
+    /**
+     * Ends the current array.
+     */
+    virtual void endArray() = 0;
+
+    /**
+     * Ends the current object.
+     */
+    virtual void endObject() = 0;
+
+    /**
+     * Writes a boolean value.
+     *
+     * @param   value       the value to write.
+     */
+    virtual void writeBool(bool value) = 0;
+
+    /**
+     * Writes binary data.
+     *
+     * Writers of binary formats keep the data as it is, text writers encode it as base64.
+     *
+     * @param   data        the data to write.
+     */
+    virtual void writeBytes(QByteArray const & data) = 0;
+
+    /**
+     * Writes a number.
+     *
+     * @param   value       the value to write.
+     */
+    virtual void writeDouble(double value) = 0;
+
+    /**
+     * Writes the key of the next value of the current object.
+     *
+     * @param   key         the key to write.
+     */
+    virtual void writeKey(QString const & key) = 0;
+
+    /**
+     * Writes a null value.
+     */
+    virtual void writeNull() = 0;
+
+    /**
+     * Writes a string value.
+     *
+     * @param   value       the value to write.
+     */
+    virtual void writeString(QString const & value) = 0;
+
+    /**
+     * Writes a JSON value, objects and arrays token by token.
+     *
+     * @param   value       the value to write.
+     */
+    void writeValue(QJsonValue const & value);
+};
+
+
+}
+
+
+#endif
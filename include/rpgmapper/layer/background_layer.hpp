@@ -92,6 +92,13 @@ public:
      */
     QJsonObject getJSON() const override;
 
+    /**
+     * Approximates the memory held by the background pixmap.
+     *
+     * @return  the number of bytes of the background pixmap (0 if there is none).
+     */
+    long long getPixmapBytes() const;
+
     /**
      * Gets the image rendering mode setting as string.
      *
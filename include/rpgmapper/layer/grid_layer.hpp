@@ -9,7 +9,10 @@
 
 #include <QColor>
 #include <QJsonObject>
+#include <QLine>
 #include <QPainter>
+#include <QRect>
+#include <QVector>
 
 #include <rpgmapper/layer/layer.hpp>
 
@@ -28,6 +31,18 @@ class GridLayer : public Layer {
 
     Q_OBJECT
 
+    /**
+     * The geometry of a grid for a specific map rectangle and tile size.
+     */
+    struct GridLines {
+        QRect rect;                     /**< The inner rect of the map the lines have been created for. */
+        int tileSize = 0;               /**< The tile size the lines have been created for. */
+        QVector<QLine> innerLines;      /**< The dotted lines within the map. */
+        QVector<QLine> borderLines;     /**< The solid border lines and outer ticks. */
+    };
+    
+    mutable GridLines gridLines;        /**< The cached grid geometry. */
+
 public:
 
     /**
@@ -83,29 +98,28 @@ signals:
 private:
 
     /**
-     * Draws the map border.
+     * Adds the solid map border and the outer ticks to the grid lines.
      *
-     * @param   painter     the painter used for drawing.
-     * @param   tileSize    the size of a single tile square side in pixels.
+     * @param   lines       the grid lines to fill.
      */
-    void drawBorder(QPainter & painter, int tileSize) const;
+    static void createBorderLines(GridLines & lines);
 
     /**
-     * Draws all X-axis.
+     * Adds the dotted lines within the map to the grid lines.
      *
-     * @param   painter     the painter used for drawing.
-     * @param   tileSize    the size of a single tile square side in pixels.
+     * @param   lines       the grid lines to fill.
      */
-    void drawXAxis(QPainter & painter, int tileSize) const;
+    static void createInnerLines(GridLines & lines);
 
     /**
-     * Draws all Y-axis.
+     * Returns the grid geometry for the current map at the given tile size.
+     *
+     * The lines are only recreated if the map size, the map margin or the tile size changed.
      *
-     * @param   painter     the painter used for drawing.
      * @param   tileSize    the size of a single tile square side in pixels.
+     * @return  the grid lines to draw.
      */
-    void drawYAxis(QPainter & painter, int tileSize) const;
-
+    GridLines const & getGridLines(int tileSize) const;
 };
 
 
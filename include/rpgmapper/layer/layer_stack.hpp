@@ -7,17 +7,22 @@
 #ifndef RPGMAPPER_MODEL_LAYER_LAYER_STACK_HPP
 #define RPGMAPPER_MODEL_LAYER_LAYER_STACK_HPP
 
+#include <list>
+#include <utility>
 #include <vector>
 
+#include <QCborStreamReader>
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QSharedPointer>
+#include <QString>
 
 #include <rpgmapper/layer/axis_layer.hpp>
 #include <rpgmapper/layer/background_layer.hpp>
 #include <rpgmapper/layer/grid_layer.hpp>
 #include <rpgmapper/layer/text_layer.hpp>
 #include <rpgmapper/layer/tile_layer.hpp>
+#include <rpgmapper/json/json_writer.hpp>
 
 
 // fwd
@@ -236,12 +241,44 @@ public:
         return tileLayers;
     }
     
+    /**
+     * Collects all layers to draw in proper order along with their names.
+     *
+     * The order is:
+     *      [0] - background
+     *      [1] - base layers (maybe more than 1)
+     *      [2] - grid (if visible)
+     *      [3] - axis (if visible)
+     *      [4] - tile layers (maybe more than 1)
+     *      [5] - text
+     *
+     * @param   gridVisible     include the grid layer.
+     * @param   axisVisible     include the axis layer.
+     * @return  the layers to draw, bottom first.
+     */
+    std::list<std::pair<QString, Layer const *>> getVisibleLayers(bool gridVisible, bool axisVisible) const;
+    
+    /**
+     * Reads all layers from a CBOR stream and applies them to the current stack.
+     *
+     * @param   reader      the CBOR stream positioned at the layer stack object.
+     * @return  true, if all layers have been read.
+     */
+    bool readCBOR(QCborStreamReader & reader);
+    
     /**
      * Sets a new parent map.
      *
      * @parant  map     the new parent map.
      */
     void setMap(Map * map);
+    
+    /**
+     * Writes the layer stack as stream of JSON tokens.
+     *
+     * @param   writer      the writer receiving the tokens.
+     */
+    void writeJSON(rpgmapper::model::json::JSONWriter & writer) const;
 
 private:
     
@@ -261,6 +298,15 @@ private:
      */
     bool applyJSONTileLayers(QJsonArray const & jsonArray);
     
+    /**
+     * Reads an array of tile layers from a CBOR stream.
+     *
+     * @param   reader      the CBOR stream positioned at the array.
+     * @param   layers      receives the layers read.
+     * @return  true, if all layers have been read.
+     */
+    bool readCBORTileLayers(QCborStreamReader & reader, std::vector<QSharedPointer<TileLayer>> & layers);
+    
 };
 
 
@@ -16,6 +16,7 @@
 
 #include <rpgmapper/layer/layer.hpp>
 #include <rpgmapper/field_pointer.hpp>
+#include <rpgmapper/memory_report.hpp>
 
 
 // fwd
@@ -57,6 +58,14 @@ public:
      */
     void addField(rpgmapper::model::FieldPointer field);
 
+    /**
+     * Applies a JSON to this layer, replacing all fields.
+     *
+     * @param   json        the JSON holding the layer data.
+     * @return  true, if the fields have been decoded.
+     */
+    bool applyJSON(QJsonObject const & json) override;
+
     /**
      * Draws the tiles defined on the map.
      *
@@ -118,9 +127,18 @@ public:
     /**
      * Extracts this layer as JSON object.
      *
+     * The fields are binary encoded (see TileLayerCodec) and held as base64 string.
+     *
      * @return  a JSON object holding the layer data.
      */
     QJsonObject getJSON() const override;
+
+    /**
+     * Estimates the memory held by the fields and tiles of this layer.
+     *
+     * @return  the memory report of this layer.
+     */
+    rpgmapper::model::MemoryReport getMemoryReport() const;
     
     /**
      * Checks if there is a field present at the given location.
@@ -151,6 +169,16 @@ public:
         return isFieldPresent(static_cast<int>(position.x()), static_cast<int>(position.y()));
     }
     
+    /**
+     * Reads this layer from a CBOR stream, replacing all fields.
+     *
+     * The encoded fields are taken as CBOR byte string and decoded right away.
+     *
+     * @param   reader      the CBOR stream positioned at the layer object.
+     * @return  true, if the layer has been read.
+     */
+    bool readCBOR(QCborStreamReader & reader) override;
+    
     /**
      * Removes a field from the layer
      *
@@ -183,6 +211,15 @@ public:
     void removeField(QPointF position) {
         removeField(static_cast<int>(position.x()), static_cast<int>(position.y()));
     }
+    
+    /**
+     * Writes this layer as stream of JSON tokens.
+     *
+     * The encoded fields are handed to the writer as binary data.
+     *
+     * @param   writer      the writer receiving the tokens.
+     */
+    void writeJSON(rpgmapper::model::json::JSONWriter & writer) const override;
 
 signals:
     
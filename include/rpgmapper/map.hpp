@@ -8,11 +8,15 @@
 #define RPGMAPPER_MODEL_MAP_HPP
 
 #include <QJsonObject>
+#include <QByteArray>
 #include <QSharedPointer>
 #include <QString>
+#include <QStringList>
 
 #include <rpgmapper/layer/layer_stack.hpp>
+#include <rpgmapper/map_entry.hpp>
 #include <rpgmapper/map_pointer.hpp>
+#include <rpgmapper/memory_report.hpp>
 #include <rpgmapper/nameable.hpp>
 
 
@@ -29,6 +33,11 @@ class CoordinateSystem;
  * This is the heart of the rpgmapper. A map is a collection of layers,
  * which in turn define tiles, background, texts, etc.
  * It has a name and a coordinate system attached.
+ *
+ * A map read from an atlas file may be lazy: it knows the zip entry holding it and
+ * applies the entry on first access to its coordinate system or layers. A lazy map which
+ * has not been modified since it has been loaded (or saved) may be unloaded again. A map
+ * whose entry failed to load stays empty and is not loaded again (see getLoadError()).
  */
 class Map : public Nameable {
     
@@ -36,6 +45,12 @@ class Map : public Nameable {
 
     QSharedPointer<CoordinateSystem> coordinateSystem;      /**< the coordinate system of the map */
     rpgmapper::model::layer::LayerStack layerStack;         /**< The layer stack of this map. */
+    
+    MapEntry entry;                 /**< The zip entry the map is stored in (if any). */
+    bool loaded = true;             /**< The map entry has been applied. */
+    QString loadError;              /**< Why the map entry failed to load (empty, unless it failed). */
+    QByteArray storedDigest;        /**< Digest of the map as loaded from or saved to its entry. */
+    quint64 lastAccess = 0;         /**< When the map has been accessed last (see getLastAccess()). */
 
 public:
 
@@ -60,6 +75,7 @@ public:
      * @return  the coordinate system of the map.
      */
     QSharedPointer<CoordinateSystem> getCoordinateSystem() {
+        ensureLoaded();
         return coordinateSystem;
     }
     
@@ -69,6 +85,7 @@ public:
      * @return  the coordinate system of the map.
      */
     QSharedPointer<CoordinateSystem> const getCoordinateSystem() const {
+        ensureLoaded();
         return coordinateSystem;
     }
     
@@ -79,12 +96,33 @@ public:
      */
     QJsonObject getJSON() const override;
     
+    /**
+     * Returns the zip entry the map is stored in.
+     *
+     * @return  the entry of the map (with an empty entry name, if never stored).
+     */
+    MapEntry const & getEntry() const {
+        return entry;
+    }
+    
+    /**
+     * Returns when the map has been loaded or selected last.
+     *
+     * This is a counter shared by all maps: the least recently used map has the lowest value.
+     *
+     * @return  the last access to the map.
+     */
+    quint64 getLastAccess() const {
+        return lastAccess;
+    }
+    
     /**
      * Gets the layers of this map.
      *
      * @return  all the layers of this map.
      */
     rpgmapper::model::layer::LayerStack & getLayers() {
+        ensureLoaded();
         return layerStack;
     }
     
@@ -94,8 +132,45 @@ public:
      * @return  all the layers of this map.
      */
     rpgmapper::model::layer::LayerStack const & getLayers() const {
+        ensureLoaded();
         return layerStack;
     }
+
+    /**
+     * Estimates the memory held by the map: fields, tiles and the background pixmap.
+     *
+     * A map not loaded holds nothing.
+     *
+     * @return  the memory report of this map.
+     */
+    MemoryReport getMemoryReport() const;
+    
+    /**
+     * Returns why loading the map from its entry failed.
+     *
+     * @return  the failure (empty, if the map has not failed to load).
+     */
+    QString const & getLoadError() const {
+        return loadError;
+    }
+    
+    /**
+     * Checks if the map has been loaded from its entry (or is not lazy at all).
+     *
+     * @return  true, if the coordinate system and layers are present.
+     */
+    bool isLoaded() const {
+        return loaded;
+    }
+    
+    /**
+     * Checks if the map differs from the entry it has been loaded from or saved to.
+     *
+     * This compares the digest of the serialized map, so it is not for free.
+     *
+     * @return  true, if the map has been modified or has never been stored at all.
+     */
+    bool isModified() const;
     
     /**
      * Checks if there is at least a single tile on a field (base or tile layer) present.
@@ -145,6 +220,16 @@ public:
     virtual bool isValid() const {
         return true;
     }
+    
+    /**
+     * Loads the map from its entry, unless already loaded.
+     *
+     * A failure is remembered: the entry is not read again, until a new entry is set.
+     *
+     * @param   log         Protocol of operations.
+     * @return  true, if the map is loaded.
+     */
+    bool load(QStringList & log);
 
     /**
      * Returns the invalid null map pointer.
@@ -155,11 +240,60 @@ public:
      */
     static MapPointer const & null();
     
+    /**
+     * Reads the map from a CBOR stream.
+     *
+     * The tile layers are taken from the stream directly, without building a JSON object.
+     *
+     * @param   reader      the CBOR stream positioned at the map object.
+     * @return  true, if the map has been read.
+     */
+    bool readCBOR(QCborStreamReader & reader) override;
+    
+    /**
+     * Makes this a lazy map: the map is loaded from the given entry on first access.
+     *
+     * @param   entry       the zip entry holding the map.
+     */
+    void setEntry(MapEntry entry);
+    
+    /**
+     * The map has been written to an atlas file.
+     *
+     * A map not loaded is loaded from the new entry from now on, a loaded map is not
+     * modified anymore with respect to the data written.
+     *
+     * @param   entry       the zip entry written.
+     * @param   digest      the SHA-1 digest of the map data (CBOR) written.
+     */
+    void setStored(MapEntry entry, QByteArray const & digest);
+    
+    /**
+     * Marks the map as accessed right now.
+     */
+    void touch();
+    
     /**
      * Triggers the tile placed signal.
      */
     void triggerTilePlaced();
     
+    /**
+     * Drops the coordinate system and layers of the map.
+     *
+     * Only an unmodified map stored in an entry is unloaded. Its next access loads it again.
+     *
+     * @return  true, if the map is not loaded anymore.
+     */
+    bool unload();
+    
+    /**
+     * Writes the map as stream of JSON tokens.
+     *
+     * @param   writer      the writer receiving the tokens.
+     */
+    void writeJSON(rpgmapper::model::json::JSONWriter & writer) const override;
+    
 signals:
     
     /**
@@ -167,6 +301,20 @@ signals:
      */
     void tilePlaced();
 
+private:
+    
+    /**
+     * Loads the map on first access.
+     *
+     * Loading changes the map, even if accessed by a const method: to the outside a lazy
+     * map behaves as if it had been loaded all along. A map failed to load stays empty.
+     */
+    void ensureLoaded() const {
+        if (!loaded && loadError.isEmpty()) {
+            QStringList log;
+            const_cast<Map *>(this)->load(log);
+        }
+    }
 };
 
 
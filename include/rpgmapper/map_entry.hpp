@@ -0,0 +1,38 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#ifndef RPGMAPPER_MODEL_MAP_ENTRY_HPP
+#define RPGMAPPER_MODEL_MAP_ENTRY_HPP
+
+#include <QString>
+
+
+namespace rpgmapper::model {
+
+
+/**
+ * Where a single map is stored inside an atlas file.
+ *
+ * Each map is a zip entry of its own, listed by the map index of the atlas file. The
+ * position of the entry in the zip central directory is taken while the atlas file is
+ * opened, so the map is found again without scanning the directory.
+ */
+struct MapEntry {
+    QString regionName;                 /**< The region of the map. */
+    QString mapName;                    /**< The name of the map. */
+    QString fileName;                   /**< The atlas file holding the map. */
+    QString entryName;                  /**< The name of the zip entry holding the map JSON. */
+    qint64 size = 0;                    /**< Uncompressed size of the entry. */
+    bool positionKnown = false;         /**< The position of the entry is known. */
+    quint64 directoryOffset = 0;        /**< Offset of the entry in the zip central directory. */
+    quint64 entryNumber = 0;            /**< Number of the entry in the zip central directory. */
+};
+
+
+}
+
+
+#endif
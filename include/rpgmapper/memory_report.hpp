@@ -0,0 +1,123 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#ifndef RPGMAPPER_MODEL_MEMORY_REPORT_HPP
+#define RPGMAPPER_MODEL_MEMORY_REPORT_HPP
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+#include <rpgmapper/tile/tiles.hpp>
+
+
+// fwd
+namespace rpgmapper::model { class Field; }
+namespace rpgmapper::model::tile { class Tile; }
+
+
+namespace rpgmapper::model {
+
+
+/**
+ * Estimated resident bytes of the model by category.
+ *
+ * The numbers are estimates: container and allocator overhead is approximated and data
+ * shared between Qt objects (implicitly shared strings, pixmaps) may be counted more than once.
+ */
+struct MemoryReport {
+
+    long long fields = 0;                   /**< Fields and their tile lists in the tile layers. */
+    long long tiles = 0;                    /**< Tile instances placed on fields. */
+    long long attributes = 0;               /**< Attribute keys and values of the tiles. */
+    long long shapeCaches = 0;              /**< Rendered images and pixmaps cached by shapes. */
+    long long backgroundPixmaps = 0;        /**< Background images of maps. */
+    long long resourceBlobs = 0;            /**< Raw data of the resources. */
+    long long commandHistory = 0;           /**< Commands kept for undo and redo. */
+
+    /**
+     * Adds another report to this one.
+     *
+     * @param   rhs     the other report.
+     * @return  *this
+     */
+    MemoryReport & operator+=(MemoryReport const & rhs);
+
+    /**
+     * Adds a field, including all its tiles, to the report.
+     *
+     * @param   field       the field to account for.
+     */
+    void addField(rpgmapper::model::Field const & field);
+
+    /**
+     * Adds a single tile, including its attributes, to the report.
+     *
+     * @param   tile        the tile to account for.
+     */
+    void addTile(rpgmapper::model::tile::Tile const & tile);
+
+    /**
+     * Adds a list of tiles, including their attributes, to the report.
+     *
+     * @param   tiles       the tiles to account for.
+     */
+    void addTiles(rpgmapper::model::tile::Tiles const & tiles);
+
+    /**
+     * Estimates the bytes held by a byte array.
+     *
+     * @param   data        the byte array.
+     * @return  estimated bytes of the byte array.
+     */
+    static long long getBytes(QByteArray const & data);
+
+    /**
+     * Estimates the bytes held by a string.
+     *
+     * @param   string      the string.
+     * @return  estimated bytes of the string.
+     */
+    static long long getBytes(QString const & string);
+
+    /**
+     * Returns the overhead of a single node in a std::map (excluding key and value).
+     *
+     * @return  estimated bytes of a node in a std::map.
+     */
+    static constexpr long long getMapNodeOverhead() {
+        return 32;
+    }
+
+    /**
+     * Returns the overhead of the control block of a QSharedPointer.
+     *
+     * @return  estimated bytes of a QSharedPointer control block.
+     */
+    static constexpr long long getSharedPointerOverhead() {
+        return 24;
+    }
+
+    /**
+     * Sums all categories.
+     *
+     * @return  the total number of estimated bytes.
+     */
+    long long getTotal() const;
+
+    /**
+     * Formats the report human readable, one category per line.
+     *
+     * @return  the report as list of lines.
+     */
+    QStringList toStringList() const;
+};
+
+
+}
+
+
+#endif
@@ -0,0 +1,126 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#ifndef RPGMAPPER_MODEL_RENDER_STATISTICS_HPP
+#define RPGMAPPER_MODEL_RENDER_STATISTICS_HPP
+
+#include <map>
+
+#include <QString>
+
+
+namespace rpgmapper::model {
+
+
+/**
+ * Collects statistics about how maps are rendered.
+ *
+ * The counters are cheap enough to stay enabled in production builds: the field, shape cache and
+ * pixmap counters are atomics and may be touched from any thread. Frames and layer timings are
+ * recorded by the widget painting the map and thus are expected to be fed from the GUI thread only.
+ */
+class RenderStatistics {
+
+public:
+
+    /**
+     * A snapshot of the current render statistics.
+     */
+    struct Report {
+
+        std::map<QString, float> layerMilliseconds;     /**< Average draw time of each layer in milliseconds. */
+
+        unsigned long fieldsVisited = 0;                /**< Fields visited during the last frame. */
+        unsigned long fieldsDrawn = 0;                  /**< Fields actually drawn during the last frame. */
+
+        unsigned long shapeCacheHits = 0;               /**< Number of shape drawings served by the cache. */
+        unsigned long shapeCacheMisses = 0;             /**< Number of shape drawings rendered from SVG. */
+
+        long long pixmapBytes = 0;                      /**< Bytes of cached pixmaps and images resident. */
+
+        unsigned long frames = 0;                       /**< Number of frames in the frame time statistics. */
+        float frameMillisecondsP50 = 0.0;               /**< Median frame time in milliseconds. */
+        float frameMillisecondsP95 = 0.0;               /**< 95th percentile of frame time in milliseconds. */
+        float frameMillisecondsP99 = 0.0;               /**< 99th percentile of frame time in milliseconds. */
+
+        /**
+         * Returns the ratio of shape cache hits in relation to all shape cache lookups.
+         *
+         * @return  the shape cache hit rate in [0.0, 1.0].
+         */
+        double getShapeCacheHitRate() const;
+    };
+
+    /**
+     * Constructor.
+     */
+    RenderStatistics() = delete;
+
+    /**
+     * Adds the number of fields visited and drawn by a layer in the current frame.
+     *
+     * @param   visited     number of fields the layer looked at.
+     * @param   drawn       number of fields the layer actually painted.
+     */
+    static void addFields(unsigned long visited, unsigned long drawn);
+
+    /**
+     * Adds (or removes, if negative) bytes of pixmaps or images held in memory for rendering.
+     *
+     * @param   bytes       the number of bytes added to or removed from the resident pixmaps.
+     */
+    static void addPixmapBytes(long long bytes);
+
+    /**
+     * Adds the time a single layer took to draw in the current frame.
+     *
+     * @param   layer           name of the layer.
+     * @param   milliseconds    the draw duration in milliseconds.
+     */
+    static void addLayerTime(QString const & layer, float milliseconds);
+
+    /**
+     * Counts a shape drawing served from the shape cache.
+     */
+    static void addShapeCacheHit();
+
+    /**
+     * Counts a shape drawing which had to be rendered.
+     */
+    static void addShapeCacheMiss();
+
+    /**
+     * Starts a new frame.
+     *
+     * This resets the per frame counters (fields visited and drawn).
+     */
+    static void beginFrame();
+
+    /**
+     * Ends the current frame.
+     *
+     * @param   milliseconds    the time the whole frame took to draw in milliseconds.
+     */
+    static void endFrame(float milliseconds);
+
+    /**
+     * Creates a snapshot of the current statistics.
+     *
+     * @return  the current render statistics.
+     */
+    static Report getReport();
+
+    /**
+     * Resets all statistics, except for the resident pixmap bytes.
+     */
+    static void reset();
+};
+
+
+}
+
+
+#endif
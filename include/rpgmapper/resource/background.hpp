@@ -7,8 +7,11 @@
 #ifndef RPGMAPPER_MODEL_RESOURCE_BACKGROUND_HPP
 #define RPGMAPPER_MODEL_RESOURCE_BACKGROUND_HPP
 
+#include <mutex>
+
 #include <QByteArray>
 #include <QImage>
+#include <QMimeType>
 #include <QString>
 
 #include <rpgmapper/resource/resource.hpp>
@@ -22,8 +25,9 @@ namespace rpgmapper::model::resource {
  */
 class Background : public Resource {
     
-    QImage image;           /**< The background image. */
-    bool valid = false;     /**< Validity flag. */
+    mutable QImage image;           /**< The background image, decoded on first use. */
+    mutable bool decoded = false;   /**< The image has been decoded. */
+    mutable std::mutex imageMutex;  /**< Guards decoding the image (prefetch threads decode too). */
 
 public:
     
@@ -35,14 +39,22 @@ public:
      */
     Background(QString path, QByteArray const & data);
     
+    /**
+     * Constructor for a background whose image is read on first use.
+     *
+     * @param   path        resource path of the background.
+     * @param   source      the image file.
+     */
+    Background(QString path, Source source);
+    
     /**
      * Gets the internal image of the background.
      *
+     * The image is decoded on the first call.
+     *
      * @return  the image to draw as background.
      */
-    QImage getImage() const {
-        return image;
-    }
+    QImage getImage() const;
     
     /**
      * Checks if the given data array could contain a background image.
@@ -53,12 +65,22 @@ public:
     static bool isBackground(QByteArray const & data);
     
     /**
-     * Checks if this ColorPalette is a valid instance.
+     * Checks if data of the given mime type could contain a background image.
+     *
+     * @param   mimeType    the mime type detected for the data.
+     * @return  return true, if data of this mime type can be treated as a background.
+     */
+    static bool isBackground(QMimeType const & mimeType);
+    
+    /**
+     * Checks if this Background is a valid instance.
+     *
+     * This decodes the image.
      *
      * @return  true if this is a valid instance.
      */
-    bool isValid() const {
-        return valid;
+    bool isValid() const override {
+        return !getImage().isNull();
     }
     
     /**
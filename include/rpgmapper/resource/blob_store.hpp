@@ -0,0 +1,91 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#ifndef RPGMAPPER_MODEL_RESOURCE_BLOB_STORE_HPP
+#define RPGMAPPER_MODEL_RESOURCE_BLOB_STORE_HPP
+
+#include <QByteArray>
+#include <QString>
+
+
+namespace rpgmapper::model::resource {
+
+
+/**
+ * Content addressed storage of resource BLOBs.
+ *
+ * BLOBs are identified by their SHA-256. In memory, identical BLOBs are interned: all
+ * resources holding the same bytes (in any ResourceCollection) share a single buffer.
+ * The pool does not keep BLOBs alive; entries no longer used by any resource are dropped.
+ *
+ * Optionally, an external folder holds BLOBs on disk. Atlas files then merely refer to
+ * their resources by hash and many atlases share the same files.
+ */
+class BlobStore {
+
+public:
+
+    /**
+     * Constructor.
+     */
+    BlobStore() = delete;
+
+    /**
+     * Returns the external folder holding BLOBs.
+     *
+     * @return  the external blob folder (empty, if BLOBs are embedded into the atlas files).
+     */
+    static QString getFolder();
+
+    /**
+     * Returns the number of distinct BLOBs interned and still in use.
+     *
+     * @return  the number of BLOBs in the pool.
+     */
+    static int getInternedCount();
+
+    /**
+     * Returns a BLOB sharing its bytes with an identical BLOB interned before.
+     *
+     * BLOBs referring to foreign memory (QByteArray::fromRawData, e.g. a mapped file)
+     * must not be interned.
+     *
+     * @param   data        the BLOB.
+     * @param   hash        the SHA-256 of the BLOB.
+     * @return  the interned BLOB (equal to data).
+     */
+    static QByteArray intern(QByteArray const & data, QString const & hash);
+
+    /**
+     * Reads a BLOB from the external folder.
+     *
+     * @param   hash        the SHA-256 of the BLOB.
+     * @return  the interned BLOB (empty, if not found or corrupted).
+     */
+    static QByteArray read(QString const & hash);
+
+    /**
+     * Sets the external folder holding BLOBs.
+     *
+     * @param   folder      the external blob folder (empty embeds BLOBs into the atlas files).
+     */
+    static void setFolder(QString folder);
+
+    /**
+     * Writes a BLOB into the external folder, unless already present.
+     *
+     * @param   hash        the SHA-256 of the BLOB.
+     * @param   data        the BLOB.
+     * @return  true, if the BLOB is now present in the external folder.
+     */
+    static bool write(QString const & hash, QByteArray const & data);
+};
+
+
+}
+
+
+#endif
@@ -12,6 +12,7 @@
 #include <QByteArray>
 #include <QColor>
 #include <QJsonDocument>
+#include <QJsonObject>
 #include <QString>
 
 #include <rpgmapper/resource/resource.hpp>
@@ -44,6 +45,15 @@ public:
      */
     ColorPalette(QString path, QByteArray const & data);
     
+    /**
+     * Constructor for an already parsed color palette.
+     *
+     * @param   path        resource path of the color palette.
+     * @param   data        a JSON structure holding the palette.
+     * @param   json        the JSON structure parsed from data.
+     */
+    ColorPalette(QString path, QByteArray const & data, QJsonObject const & json);
+    
     /**
      * Gets the palette managed by this object (const version)
      *
@@ -70,6 +80,14 @@ public:
      */
     static bool isColorPalette(QByteArray const & data);
     
+    /**
+     * Checks if the given parsed JSON could be a color palette.
+     *
+     * @param   json        the JSON object to check.
+     * @return  return true, if this JSON can be treated as a color palette.
+     */
+    static bool isColorPalette(QJsonObject const & json);
+    
     /**
      * Checks if this ColorPalette is a valid instance.
      *
@@ -96,11 +114,13 @@ public:
 private:
     
     /**
-     * Loads a palette from the internal byte array data of the resource.
+     * Loads a palette from the parsed JSON of the resource.
+     *
+     * The JSON should contain a 256 array of colors.
      *
-     * The Byte Array should contain a JSON 256 array of colors.
+     * @param   json        the parsed JSON of the resource.
      */
-    void fromJSON();
+    void fromJSON(QJsonObject const & json);
 };
 
 
@@ -0,0 +1,102 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#ifndef RPGMAPPER_MODEL_RESOURCE_RASTER_CACHE_HPP
+#define RPGMAPPER_MODEL_RESOURCE_RASTER_CACHE_HPP
+
+#include <QImage>
+#include <QString>
+
+
+namespace rpgmapper::model::resource {
+
+
+/**
+ * A persistent on-disk cache of rasterized shapes.
+ *
+ * Images are keyed by the SHA-256 of the SVG, the tile size, the rotation and the stretch.
+ * Each image is a file holding a small header followed by the raw premultiplied ARGB32
+ * pixels, which is mapped into memory on load. Hits refresh the modification time of the
+ * file. If the cache grows beyond its maximum size, the least recently used images are
+ * evicted.
+ *
+ * The cache is disabled until a folder is set. The files are in native byte order and
+ * meant for the machine that wrote them only.
+ */
+class RasterCache {
+
+public:
+
+    /**
+     * Constructor.
+     */
+    RasterCache() = delete;
+
+    /**
+     * Returns the folder holding the cached images.
+     *
+     * @return  the cache folder (empty, if the cache is disabled).
+     */
+    static QString getFolder();
+
+    /**
+     * Returns the maximum size of the cache.
+     *
+     * @return  the maximum number of bytes of all cached images.
+     */
+    static qint64 getMaximumSize();
+
+    /**
+     * Checks if the cache is enabled.
+     *
+     * @return  true, if a cache folder has been set.
+     */
+    static bool isEnabled() {
+        return !getFolder().isEmpty();
+    }
+
+    /**
+     * Loads a cached image.
+     *
+     * @param   hash            the SHA-256 of the SVG.
+     * @param   tileSize        the tile size of the image.
+     * @param   rotation        rotation in degree.
+     * @param   stretch         stretch scaling.
+     * @return  the cached image (a null image, if not cached).
+     */
+    static QImage load(QString const & hash, unsigned int tileSize, double rotation, double stretch);
+
+    /**
+     * Sets the folder holding the cached images.
+     *
+     * @param   folder          the cache folder (empty disables the cache).
+     */
+    static void setFolder(QString folder);
+
+    /**
+     * Sets the maximum size of the cache.
+     *
+     * @param   maximumSize     the maximum number of bytes of all cached images.
+     */
+    static void setMaximumSize(qint64 maximumSize);
+
+    /**
+     * Stores an image, evicting the least recently used images if the cache grows too big.
+     *
+     * @param   hash            the SHA-256 of the SVG.
+     * @param   tileSize        the tile size of the image.
+     * @param   rotation        rotation in degree.
+     * @param   stretch         stretch scaling.
+     * @param   image           the rasterized shape.
+     */
+    static void store(QString const & hash, unsigned int tileSize, double rotation, double stretch, QImage image);
+};
+
+
+}
+
+
+#endif
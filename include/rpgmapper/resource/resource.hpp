@@ -7,13 +7,22 @@
 #ifndef RPGMAPPER_MODEL_RESOURCE_RESOURCE_HPP
 #define RPGMAPPER_MODEL_RESOURCE_RESOURCE_HPP
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+
 #include <QByteArray>
+#include <QDateTime>
 #include <QMimeType>
 #include <QString>
 
 #include <rpgmapper/resource/resource_type.hpp>
 
 
+// fwd
+class QFile;
+
+
 namespace rpgmapper::model::resource {
 
 
@@ -21,12 +30,44 @@ namespace rpgmapper::model::resource {
  * A resource is a named BLOB.
  *
  * A resource has a name and is uniquely identified by a resource path.
+ *
+ * A resource may be created from a file without reading it. The BLOB is then
+ * read on the first access to getData() (or by loadData(), e.g. from a prefetch thread).
+ *
+ * If the source asks for it, the file is memory mapped instead of read: the BLOB then
+ * refers to the mapped pages (zero-copy) and costs address space rather than resident memory.
+ * The mapping lives as long as the resource (or until new data is set). Hence getData() hands
+ * out a deep copy of mapped bytes, which may outlive the mapping. withData() reads the mapped
+ * bytes in place.
  */
 class Resource {
 
-    QByteArray data;        /**< The Blob. */
+public:
+    
+    /**
+     * The file a lazily loaded resource reads its BLOB from.
+     */
+    struct Source {
+        QString fileName;           /**< The file holding the BLOB. */
+        qint64 size = 0;            /**< Size of the file when indexed. */
+        QDateTime modified;         /**< Last modification of the file when indexed. */
+        bool mapped = false;        /**< Map the file into memory instead of reading it. */
+    };
+
+private:
+    
+    mutable QByteArray data;                /**< The Blob. */
+    mutable std::atomic<bool> loaded;       /**< The BLOB is present in data. */
+    mutable std::mutex dataMutex;           /**< Guards reading the BLOB from the source. */
+    mutable std::shared_ptr<QFile> mappedFile;  /**< Owns the mapping the BLOB refers to (if mapped). */
+    mutable QMimeType mimeType;             /**< The detected mime type (invalid, if not yet detected). */
+    mutable std::mutex mimeTypeMutex;       /**< Guards the detected mime type. */
+    mutable QString hash;                   /**< The SHA-256 of the BLOB (empty, if not yet calculated). */
+    mutable std::mutex hashMutex;           /**< Guards the hash. */
+    
     QString name;           /**< The name associated with the BLOB. */
     QString path;           /**< The path relative to the root resource base to the BLOB. */
+    Source source;          /**< Where to read the BLOB from, if not yet loaded. */
 
 public:
     
@@ -37,20 +78,34 @@ public:
      * @param   data        the BLOB.
      */
     Resource(QString path, QByteArray const & data);
+    
+    /**
+     * Constructor for a resource whose BLOB is read on first use.
+     *
+     * @param   path        path to the BLOB.
+     * @param   source      the file holding the BLOB.
+     */
+    Resource(QString path, Source source);
 
     /**
      * Copy constructor.
      */
     Resource(Resource const &) = delete;
 
+    /**
+     * Destructor.
+     */
+    virtual ~Resource();
+
     /**
      * Gets the BLOB.
      *
+     * The BLOB is read from the source file, if this has not been done yet. A BLOB referring
+     * to a memory mapped file is copied: the copy stays valid after the mapping is gone.
+     *
      * @return  the BLOB.
      */
-    QByteArray const & getData() const {
-        return data;
-    }
+    QByteArray getData() const;
 
     /**
      * Gets the name of the BLOB.
@@ -64,11 +119,11 @@ public:
     /**
      * Creates a somehow unique hash value of the BLOB.
      *
+     * The hash is calculated once and cached until new data is set.
+     *
      * @return  A string holding the hash value of the BLOB.
      */
-    QString getHash() const {
-        return getSHA256(getData());
-    }
+    QString getHash() const;
     
     /**
      * Creates a somehow unique hash value of the BLOB.
@@ -83,6 +138,8 @@ public:
     /**
      * Returns the detected mime type of the resource.
      *
+     * The mime type is detected once and cached until new data is set.
+     *
      * @return  the (suggested) mime type of the resource.
      */
     QMimeType getMimeType() const;
@@ -103,6 +160,22 @@ public:
      */
     QString getPrefix() const;
     
+    /**
+     * Returns the size of the BLOB without reading it.
+     *
+     * @return  the size of the BLOB (or of the source file, if not yet loaded).
+     */
+    qint64 getSize() const;
+    
+    /**
+     * Returns the file the BLOB is read from.
+     *
+     * @return  the source of the BLOB (an empty file name, if the BLOB has been passed in directly).
+     */
+    Source const & getSource() const {
+        return source;
+    }
+    
     /**
      * Calculate the SHA256 value of a BLOB.
      *
@@ -118,6 +191,22 @@ public:
      */
     ResourceType getType() const;
     
+    /**
+     * Checks if the BLOB is present in memory.
+     *
+     * @return  true, if the BLOB has been read or passed in.
+     */
+    bool isLoaded() const {
+        return loaded.load(std::memory_order_acquire);
+    }
+    
+    /**
+     * Checks if the BLOB refers to a memory mapped file.
+     *
+     * @return  true, if the BLOB is mapped and not held in memory.
+     */
+    bool isMapped() const;
+    
     /**
      * Checks if this is a valid resource.
      *
@@ -127,6 +216,23 @@ public:
         return false;
     }
     
+    /**
+     * Keeps the memory mapped file the BLOB refers to alive.
+     *
+     * For resources created with raw data (QByteArray::fromRawData) pointing into a mapping
+     * shared by many resources, e.g. a resource bundle.
+     *
+     * @param   mapping     the file owning the mapping.
+     */
+    void keepMapping(std::shared_ptr<QFile> mapping);
+    
+    /**
+     * Reads the BLOB from the source file, if this has not been done yet.
+     *
+     * This is thread-safe and may be called from any thread.
+     */
+    void loadData() const;
+    
     /**
      * Sets a new data to this resource.
      *
@@ -134,6 +240,22 @@ public:
      */
     virtual void setData(QByteArray const & data);
     
+    /**
+     * Shares the BLOB with all other resources holding identical bytes (see BlobStore).
+     *
+     * Mapped BLOBs and BLOBs not yet read are left alone.
+     */
+    void shareData() const;
+    
+    /**
+     * Sets the mime type already detected for the data of this resource.
+     *
+     * This spares sniffing the data again in getMimeType().
+     *
+     * @param   mimeType    the mime type of the data.
+     */
+    void setMimeType(QMimeType mimeType);
+    
     /**
      * Sets a new name for this resource.
      *
@@ -147,6 +269,23 @@ public:
      * @return  the path without the known prefix.
      */
     QString stripPrefixFromPath() const;
+    
+    /**
+     * Passes the BLOB to a function without copying it, even if it is memory mapped.
+     *
+     * The BLOB is read from the source file, if this has not been done yet. The BLOB is
+     * neither replaced nor unmapped while the function runs. The function must not keep
+     * the bytes (take a deep copy instead) and must not access the BLOB of this resource.
+     *
+     * @param   function    called with the BLOB (QByteArray const &).
+     */
+    template<typename Function> void withData(Function function) const {
+        if (!loaded.load(std::memory_order_acquire)) {
+            loadData();
+        }
+        std::lock_guard<std::mutex> lock{dataMutex};
+        function(static_cast<QByteArray const &>(data));
+    }
 };
 
 
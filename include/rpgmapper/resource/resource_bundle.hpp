@@ -0,0 +1,75 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#ifndef RPGMAPPER_MODEL_RESOURCE_RESOURCE_BUNDLE_HPP
+#define RPGMAPPER_MODEL_RESOURCE_RESOURCE_BUNDLE_HPP
+
+#include <QString>
+#include <QStringList>
+
+#include <rpgmapper/resource/resource_loader.hpp>
+
+
+namespace rpgmapper::model::resource {
+
+
+/**
+ * A resource bundle packs a whole resource folder into a single indexed file.
+ *
+ * The bundle is created at build time from share/rpgmapper/resources. Each entry is
+ * classified and validated when the bundle is written, and parsed catalogs and palettes
+ * are stored as CBOR. Reading a bundle maps the file once and registers all entries without
+ * walking a directory tree or sniffing any data. Shapes, backgrounds and unknown resources
+ * refer to the mapped bundle (zero-copy).
+ *
+ * Layout: magic, version, size of the index, the index (QDataStream), the BLOBs.
+ */
+class ResourceBundle {
+
+public:
+
+    /**
+     * Constructor.
+     */
+    ResourceBundle() = delete;
+
+    /**
+     * Returns the file name of the system resource bundle.
+     *
+     * @return  the name of the bundle file as installed next to the system resource folders.
+     */
+    static QString getFileName() {
+        return "resources.rpgmbundle";
+    }
+
+    /**
+     * Reads all entries of a bundle.
+     *
+     * @param   fileName        the bundle file.
+     * @param   loadedFiles     receives one loaded file per entry.
+     * @param   log             the log of actions.
+     * @return  true, if the bundle has been read.
+     */
+    static bool read(QString const & fileName, ResourceLoader::LoadedFiles & loadedFiles, QStringList & log);
+
+    /**
+     * Packs a resource folder into a bundle.
+     *
+     * Files which fail to classify as the resource type their path claims are left out.
+     *
+     * @param   fileName        the bundle file to write.
+     * @param   folder          the resource folder to pack (e.g. share/rpgmapper/resources).
+     * @param   log             the log of actions.
+     * @return  true, if the bundle has been written.
+     */
+    static bool write(QString const & fileName, QString const & folder, QStringList & log);
+};
+
+
+}
+
+
+#endif
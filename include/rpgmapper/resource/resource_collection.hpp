@@ -7,12 +7,15 @@
 #ifndef RPGMAPPER_MODEL_RESOURCE_RESOURCE_COLLECTION_HPP
 #define RPGMAPPER_MODEL_RESOURCE_RESOURCE_COLLECTION_HPP
 
+#include <atomic>
+#include <cstdint>
 #include <map>
 #include <set>
 
 #include <QString>
 
 #include <rpgmapper/resource/resource_pointer.hpp>
+#include <rpgmapper/memory_report.hpp>
 
 
 namespace rpgmapper::model::resource {
@@ -20,6 +23,14 @@ namespace rpgmapper::model::resource {
 
 /**
  * This class represents a set of resources.
+ *
+ * The resources are kept sorted by path, so all resources sharing a path prefix
+ * form a contiguous range (see collectPaths()).
+ *
+ * Each modification draws a new generation number, unique across all collections, and
+ * records it for the path modified. A cached lookup result of a path stays valid as long
+ * as no generation newer than the lookup has been recorded for the path (see
+ * getPathGeneration()).
  */
 class ResourceCollection {
     
@@ -27,13 +38,18 @@ class ResourceCollection {
      * The resources an object of this class manages by paths.
      */
     std::map<QString, ResourcePointer> resources;
+    
+    /**
+     * The current generation of this collection.
+     */
+    std::atomic<std::uint64_t> generation;
 
 public:
 
     /**
      * Constructor.
      */
-    ResourceCollection() = default;
+    ResourceCollection();
 
     /**
      * Copy constructor.
@@ -52,6 +68,52 @@ public:
      */
     void addResource(ResourcePointer resource);
     
+    /**
+     * Adds the paths of all resources starting with a prefix.
+     *
+     * This is O(log n + k) for k matching resources.
+     *
+     * @param   paths       the set of paths to extend.
+     * @param   prefix      the prefix of the paths (e.g. '/backgrounds').
+     */
+    void collectPaths(std::set<QString> & paths, QString const & prefix) const;
+    
+    /**
+     * Returns the generation of this collection.
+     *
+     * @return  a number changing with every modification of this collection.
+     */
+    std::uint64_t getGeneration() const {
+        return generation.load(std::memory_order_acquire);
+    }
+    
+    /**
+     * Returns the generation number drawn last by any collection.
+     *
+     * @return  a number changing with every modification of any collection.
+     */
+    static std::uint64_t getLatestGeneration();
+    
+    /**
+     * Returns the generation number drawn last for a modification affecting a path.
+     *
+     * This is the newer of the last modification of the path in any collection and the
+     * last generation drawn by nextGeneration() for all paths.
+     *
+     * @param   path        the path of a resource.
+     * @return  a number changing with every modification affecting the path.
+     */
+    static std::uint64_t getPathGeneration(QString const & path);
+    
+    /**
+     * Estimates the memory held by the resource data and the caches of the shapes.
+     *
+     * Resources not yet read from disk count with their path only.
+     *
+     * @return  the memory report of this collection.
+     */
+    rpgmapper::model::MemoryReport getMemoryReport() const;
+
     /**
      * Returns the paths of all resources in this collection.
      *
@@ -67,6 +129,32 @@ public:
     std::map<QString, ResourcePointer> const & getResources() const {
         return resources;
     }
+    
+    /**
+     * Removes a resource from the database.
+     *
+     * @param   path        the path of the resource to remove.
+     * @return  true, if the resource has been removed.
+     */
+    bool removeResource(QString const & path);
+    
+    /**
+     * Draws a new generation number affecting all paths.
+     *
+     * This is also called when a collection is swapped, so all cached lookups are dropped.
+     *
+     * @return  a generation number never handed out before.
+     */
+    static std::uint64_t nextGeneration();
+
+private:
+    
+    /**
+     * Draws a new generation number affecting a single path and sets it for this collection.
+     *
+     * @param   path        the path modified.
+     */
+    void nextGeneration(QString const & path);
 };
 
 
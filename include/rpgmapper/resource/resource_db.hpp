@@ -7,9 +7,11 @@
 #ifndef RPGMAPPER_MODEL_RESOURCE_RESOURCE_DB_HPP
 #define RPGMAPPER_MODEL_RESOURCE_RESOURCE_DB_HPP
 
+#include <cstdint>
 #include <set>
 
 #include <QString>
+#include <QStringList>
 
 #include <rpgmapper/resource/resource_collection_pointer.hpp>
 #include <rpgmapper/resource/resource_type.hpp>
@@ -21,6 +23,12 @@ namespace rpgmapper::model::resource {
 
 /**
  * This is the place where all resources in the RPGMapper are managed.
+ *
+ * Resolved paths are memorized in a merged index, which maps each path to the winning
+ * resource of the local, user and system collections. Every modification of a collection
+ * draws a new generation number for the path modified: only the paths modified are
+ * resolved again (see getGeneration(QString const &)). Swapping a collection affects all
+ * paths (see invalidate()).
  */
 class ResourceDB {
     
@@ -40,6 +48,30 @@ public:
      * Constructor
      */
     ResourceDB() = delete;
+    
+    /**
+     * Returns the generation of the ResourceDB.
+     *
+     * The generation changes whenever a resource is added to or removed from any of the
+     * local, user or system collections or the local collection is swapped. A resource
+     * pointer resolved by getResource() may be kept as long as the generation is unchanged.
+     * This is a single atomic read, cheap enough to be checked for every tile drawn.
+     *
+     * @return  the current generation of the ResourceDB.
+     */
+    static std::uint64_t getGeneration();
+    
+    /**
+     * Returns the generation of the last modification affecting a path.
+     *
+     * A resource pointer resolved by getResource() in generation g (see getGeneration())
+     * may still be kept, as long as the generation of its path is not newer than g. This
+     * takes a lock: check getGeneration() first.
+     *
+     * @param   path        the path to the resource.
+     * @return  the generation of the last modification affecting the path.
+     */
+    static std::uint64_t getGeneration(QString const & path);
 
     /**
      * Gets the local, atlas resource (loaded from an atlas file)
@@ -87,6 +119,23 @@ public:
      * @return  the resources found in the user folder.
      */
     static ResourceCollectionPointer getUserResources();
+    
+    /**
+     * Drops all resolved paths and moves the generation on.
+     *
+     * Call this when a collection is swapped (e.g. a session with a different atlas becomes current).
+     */
+    static void invalidate();
+    
+    /**
+     * Reads the data of resources in the background, ahead of their first use.
+     *
+     * The resources are looked up on the calling thread. Unknown paths and resources
+     * already loaded are skipped.
+     *
+     * @param   paths       the paths of the resources to read.
+     */
+    static void prefetch(QStringList const & paths);
 };
 
 
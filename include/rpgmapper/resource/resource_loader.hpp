@@ -9,14 +9,20 @@
 
 #include <list>
 #include <tuple>
+#include <vector>
 
 #include <QByteArray>
+#include <QJsonObject>
+#include <QMetaType>
+#include <QMimeType>
 #include <QObject>
 #include <QString>
 #include <QStringList>
+#include <QThreadPool>
 
 #include <rpgmapper/resource/resource_pointer.hpp>
 #include <rpgmapper/resource/resource_collection_pointer.hpp>
+#include <rpgmapper/resource/resource_type.hpp>
 
 
 namespace rpgmapper::model::resource {
@@ -24,13 +30,55 @@ namespace rpgmapper::model::resource {
 
 /**
  * The resource loader class loads the system and user defined resources.
+ *
+ * Scanning the folders, reading the files and parsing the resources is done by a pool of
+ * worker threads. The resources are merged into the ResourceDB on the thread which called
+ * load() or, for start(), on the thread the loader lives in, once all files have been read.
  */
 class ResourceLoader : public QObject {
 
     Q_OBJECT
     
+public:
+    
+    /**
+     * The result of sniffing and parsing resource data exactly once.
+     */
+    struct Classification {
+        QString path;                   /**< The resource path. */
+        QByteArray data;                /**< The resource data. */
+        ResourceType type = ResourceType::unknown;  /**< The resource type suggested by the path. */
+        QMimeType mimeType;             /**< The mime type detected for the data. */
+        QJsonObject json;               /**< The parsed JSON (empty, if the data is not a JSON object). */
+    };
+    
+    /**
+     * A file read and parsed by a worker.
+     */
+    struct LoadedFile {
+        QString path;                   /**< The resource path. */
+        Classification classification;  /**< The classified file data, kept for shape catalogs only. */
+        ResourcePointer resource;       /**< The resource created (nullptr for shape catalogs and on failure). */
+        bool shapeCatalog = false;      /**< The file is a shape catalog, created when merged. */
+        QStringList log;                /**< The log of the worker. */
+    };
+    
+    /**
+     * All files read by the workers in the order they have been found.
+     */
+    using LoadedFiles = std::vector<LoadedFile>;
+
+private:
+    
     QStringList userFolders;        /**< List of paths where user resources are may located. */
     bool success = false;           /**< Success of loading the resources flag. */
+    
+    QStringList backgroundLog;              /**< Log of the loading started with start(). */
+    LoadedFiles loadedSystemFiles;          /**< The system resource files read, but not yet merged. */
+    LoadedFiles loadedUserFiles;            /**< The user resource files read, but not yet merged. */
+    
+    QThreadPool workerPool;                 /**< Workers scanning folders, reading and parsing files. */
+    QThreadPool backgroundPool;             /**< Runs the loading started with start(). */
 
 public:
     
@@ -55,6 +103,13 @@ public:
      */
     explicit ResourceLoader(QObject * parent);
     
+    /**
+     * Destructor.
+     *
+     * Waits for a loading started with start() to finish.
+     */
+    ~ResourceLoader() override;
+    
     /**
      * Applies all loaded shape catalog values to the shapes currently found in the system.
      *
@@ -62,6 +117,17 @@ public:
      */
     void applyShapeCatalogs(QStringList & log);
     
+    /**
+     * Sniffs the mime type of the data and parses JSON data.
+     *
+     * JSON is only parsed for color palettes and shape catalogs.
+     *
+     * @param   path        the resource path, identifying the resource.
+     * @param   data        the resource data.
+     * @return  the classification of the data.
+     */
+    static Classification classify(QString path, QByteArray data);
+    
     /**
      * Creates the resource with the given path and the given data.
      *
@@ -74,6 +140,33 @@ public:
      */
     static ResourcePointer createResource(QString path, QByteArray const & data, QStringList & log);
     
+    /**
+     * Creates the resource of classified data.
+     *
+     * This is a factory method.
+     *
+     * @param   classification      the classified resource data.
+     * @param   log                 actions to log.
+     * @return  a resource (or nullptr on fail).
+     */
+    static ResourcePointer createResource(Classification const & classification, QStringList & log);
+    
+    /**
+     * Returns the log of the loading started with start().
+     *
+     * @return  the log of actions.
+     */
+    QStringList const & getLog() const {
+        return backgroundLog;
+    }
+    
+    /**
+     * Returns the resource folders searched within the user folders.
+     *
+     * @return  the user resource folders (e.g. to watch them for changes).
+     */
+    QStringList getResourceFolders() const;
+    
     /**
      * Returns the list of user folders.
      *
@@ -93,7 +186,7 @@ public:
     }
 
     /**
-     * Starts loading resources.
+     * Loads the resources and waits until all resources have been merged into the ResourceDB.
      *
      * @param   log         a list of log entries to be filled.
      */
@@ -109,6 +202,18 @@ public:
      */
     static ResourcePointer load(QString filePath, QString fileRoot, QStringList & log);
     
+    /**
+     * Reads a single resource file, but leaves shape catalogs to be created when merged.
+     *
+     * Unlike load() this is safe to be called by a worker: a shape catalog is only
+     * classified and has to be created with createResource() on the thread merging it.
+     *
+     * @param   filePath        the file path to read.
+     * @param   fileRoot        root of the resource (filePath - fileRoot is the resource path)
+     * @return  the file read (without a resource, if the file is no valid resource).
+     */
+    static LoadedFile read(QString const & filePath, QString const & fileRoot);
+    
     /**
      * Sets the list of user folders to search.
      *
@@ -118,66 +223,112 @@ public:
         userFolders = folders;
     }
     
+    /**
+     * Starts loading the resources in the background and returns immediately.
+     *
+     * Progress is reported by loading(). When the resources have been merged into the ResourceDB
+     * done() is emitted and the log is available via getLog().
+     */
+    void start();
+    
 private:
     
     /**
      * Creates a background resource.
      *
-     * @param   path        the resource path, identifying the resource.
-     * @param   data        the resource data.
-     * @param   log         actions to log.
+     * @param   classification      the classified resource data.
+     * @param   log                 actions to log.
      * @return  a resource (or nullptr on fail).
      */
-    static ResourcePointer createBackground(QString path, QByteArray const & data, QStringList & log);
+    static ResourcePointer createBackground(Classification const & classification, QStringList & log);
     
     /**
      * Creates a color palette resource.
      *
-     * @param   path        the resource path, identifying the resource.
-     * @param   data        the resource data.
-     * @param   log         actions to log.
+     * @param   classification      the classified resource data.
+     * @param   log                 actions to log.
      * @return  a resource (or nullptr on fail).
      */
-    static ResourcePointer createColorPalette(QString path, QByteArray const & data, QStringList & log);
+    static ResourcePointer createColorPalette(Classification const & classification, QStringList & log);
     
     /**
      * Creates a shape resource.
      *
-     * @param   path        the resource path, identifying the resource.
-     * @param   data        the resource data.
-     * @param   log         actions to log.
+     * @param   classification      the classified resource data.
+     * @param   log                 actions to log.
      * @return  a resource (or nullptr on fail).
      */
-    static ResourcePointer createShape(QString path, QByteArray const & data, QStringList & log);
+    static ResourcePointer createShape(Classification const & classification, QStringList & log);
     
     /**
      * Creates a shape catalog resource.
      *
-     * @param   path        the resource path, identifying the resource.
-     * @param   data        the resource data.
-     * @param   log         actions to log.
+     * @param   classification      the classified resource data.
+     * @param   log                 actions to log.
      * @return  a resource (or nullptr on fail).
      */
-    static ResourcePointer createShapeCatalog(QString path, QByteArray const & data, QStringList & log);
+    static ResourcePointer createShapeCatalog(Classification const & classification, QStringList & log);
     
     /**
      * Creates a resource of unknown type
      *
-     * @param   path        the resource path, identifying the resource.
-     * @param   data        the resource data.
-     * @param   log         actions to log.
+     * @param   classification      the classified resource data.
      * @return  a resource (or nullptr on fail).
      */
-    static ResourcePointer createUnknownResource(QString path, QByteArray const & data);
+    static ResourcePointer createUnknownResource(Classification const & classification);
     
     /**
-     * Loads the resources.
+     * Merges the files read into a resource collection.
      *
-     * @param   fileCollection      the list of found files to load.
-     * @param   collection          the resource collection to fill
+     * @param   loadedFiles         the files read by the workers.
+     * @param   collection          the resource collection to fill.
      * @param   log                 the log of actions.
      */
-    void loadResources(FileCollection const & fileCollection, ResourceCollectionPointer collection, QStringList & log);
+    static void mergeFiles(LoadedFiles & loadedFiles, ResourceCollectionPointer collection, QStringList & log);
+    
+    /**
+     * Merges all files read into the ResourceDB and finishes loading.
+     *
+     * @param   log         the log of actions.
+     */
+    void mergeResources(QStringList & log);
+    
+    /**
+     * Reads and parses the files with the workers.
+     *
+     * Only files nobody changes while the application runs may be memory mapped: a mapped
+     * file truncated on disk crashes the process on the next access (SIGBUS).
+     *
+     * @param   fileCollection      the files to read.
+     * @param   mappable            large files may be memory mapped (read-only system resources).
+     * @param   step                the number of files read so far (progress), will be advanced.
+     * @param   maxSteps            the number of files to read in total (progress).
+     * @return  the files read, in the order of the file collection.
+     */
+    LoadedFiles readFiles(FileCollection const & fileCollection, bool mappable, int & step, int maxSteps);
+    
+    /**
+     * Scans the system and user folders and reads all resource files found.
+     *
+     * @param   log         the log of actions.
+     */
+    void readResources(QStringList & log);
+    
+    /**
+     * Scans folders for resource files with the workers.
+     *
+     * @param   folders     the resource folders to scan.
+     * @param   log         the log of actions.
+     * @return  all files found, in the order of the folders.
+     */
+    FileCollection scanFolders(QStringList const & folders, QStringList & log);
+    
+private slots:
+    
+    /**
+     * The loading started with start() has read all files.
+     */
+    void backgroundLoaded();
     
 signals:
     
@@ -186,6 +337,11 @@ signals:
      */
     void done();
     
+    /**
+     * All files of a loading started with start() have been read (emitted by a worker thread).
+     */
+    void filesRead();
+    
     /**
      * What we are current about to load.
      *
@@ -198,4 +354,7 @@ signals:
 }
 
 
+Q_DECLARE_METATYPE(rpgmapper::model::resource::ResourceLoader::LoadingEvent)
+
+
 #endif
@@ -0,0 +1,178 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#ifndef RPGMAPPER_MODEL_RESOURCE_RESOURCE_WATCHER_HPP
+#define RPGMAPPER_MODEL_RESOURCE_RESOURCE_WATCHER_HPP
+
+#include <map>
+
+#include <QDateTime>
+#include <QFileSystemWatcher>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <QTimer>
+
+#include <rpgmapper/resource/resource_loader.hpp>
+
+
+namespace rpgmapper::model::resource {
+
+
+/**
+ * Watches the user resource folders and reloads changed resources in place.
+ *
+ * Only files added, changed or removed since the last scan are read. They are put into
+ * (or removed from) the user collection of the ResourceDB, which drops the replaced shapes
+ * along with their rasterization caches. Tiles resolve their shapes again as the generation
+ * of the ResourceDB changed. Only the shape catalogs listing a changed shape are reapplied.
+ *
+ * Changes reported by the file system watcher are collected for a short while and the
+ * changed files are then read on a worker thread. A file which fails to read (e.g. as it
+ * is still being written) keeps its previous resource and is read again with its next change.
+ */
+class ResourceWatcher : public QObject {
+
+    Q_OBJECT
+
+    /**
+     * The state of a resource file when last scanned.
+     */
+    struct FileState {
+        QString fileName;           /**< The resource file. */
+        QString folder;             /**< The resource folder of the file. */
+        qint64 size = 0;            /**< Size of the file. */
+        QDateTime modified;         /**< Last modification of the file. */
+    };
+
+    /**
+     * Resource path to file state.
+     */
+    using FileStates = std::map<QString, FileState>;
+
+    QStringList folders;                /**< The resource folders watched. */
+    FileStates files;                   /**< The files found with the last scan. */
+    QFileSystemWatcher watcher;         /**< Reports changes of folders and files. */
+    QTimer rescanTimer;                 /**< Collects bursts of changes into a single rescan. */
+    QThreadPool pool;                   /**< Reads the changed files. */
+    bool reading = false;               /**< The files of a rescan are being read. */
+    bool rescanPending = false;         /**< Changes have been reported while reading. */
+    QStringList log;                    /**< The log of the rescans. */
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param   parent      parent QObject.
+     */
+    explicit ResourceWatcher(QObject * parent = nullptr);
+
+    /**
+     * Destructor.
+     *
+     * Waits for the files of a running rescan to be read.
+     */
+    ~ResourceWatcher() override;
+
+    /**
+     * Returns the log of all rescans so far.
+     *
+     * @return  the log of actions.
+     */
+    QStringList const & getLog() const {
+        return log;
+    }
+
+    /**
+     * Scans the watched folders and applies all changes found to the ResourceDB.
+     *
+     * The changed files are read on the calling thread. The watcher itself rescans
+     * in the background (see startRescan()).
+     *
+     * @return  the resource paths added, changed or removed.
+     */
+    QStringList rescan();
+
+    /**
+     * Starts watching resource folders, which have just been loaded.
+     *
+     * @param   folders     the resource folders (e.g. ResourceLoader::getUserResourceFolders()).
+     */
+    void watch(QStringList const & folders);
+
+signals:
+
+    /**
+     * Resources have been added, changed or removed.
+     *
+     * @param   paths       the resource paths affected.
+     */
+    void resourcesChanged(QStringList const & paths);
+
+private slots:
+
+    /**
+     * Scans the watched folders and reads the changed files on the pool.
+     *
+     * The changes are applied once the files have been read. If a rescan is already
+     * reading, another one is started after it.
+     */
+    void startRescan();
+
+private:
+
+    /**
+     * Applies the files read to the ResourceDB and memorizes the scanned files.
+     *
+     * @param   current         the files found with the scan.
+     * @param   loadedFiles     the changed files read.
+     * @return  the resource paths added, changed or removed.
+     */
+    QStringList apply(FileStates current, ResourceLoader::LoadedFiles const & loadedFiles);
+
+    /**
+     * Returns the files added or changed since the last scan.
+     *
+     * @param   current     the files found with the scan.
+     * @return  the files to read.
+     */
+    FileStates getChangedFiles(FileStates const & current) const;
+
+    /**
+     * Reapplies the shape catalogs listing one of the given paths.
+     *
+     * @param   paths       the resource paths changed.
+     */
+    static void reapplyShapeCatalogs(QStringList const & paths);
+
+    /**
+     * Reads files (may run on a worker thread).
+     *
+     * @param   changed     the files to read.
+     * @return  the files read.
+     */
+    static ResourceLoader::LoadedFiles readFiles(FileStates const & changed);
+
+    /**
+     * Scans the watched folders.
+     *
+     * @return  the files found.
+     */
+    FileStates scan() const;
+
+    /**
+     * Watches all folders and files found with the last scan.
+     */
+    void updateWatchedPaths();
+};
+
+
+}
+
+
+#endif
@@ -7,11 +7,13 @@
 #ifndef RPGMAPPER_MODEL_RESOURCE_SHAPE_HPP
 #define RPGMAPPER_MODEL_RESOURCE_SHAPE_HPP
 
+#include <atomic>
 #include <map>
 
 #include <QByteArray>
 #include <QIcon>
 #include <QImage>
+#include <QMimeType>
 #include <QPixmap>
 #include <QString>
 
@@ -46,6 +48,17 @@ public:
     
 private:
     
+    /**
+     * What is known about the SVG of the shape.
+     */
+    enum class SvgState {
+        unknown,                /**< The SVG has not been parsed yet. */
+        valid,                  /**< The SVG has been parsed successfully. */
+        invalid                 /**< The SVG failed to parse. */
+    };
+    
+    mutable std::atomic<SvgState> svgState{SvgState::unknown};  /**< Result of parsing the SVG. */
+    
     mutable std::map<QString, QIcon> icons;               /**< The shape icon at "scale@rotation-stretch". */
     mutable std::map<QString, QImage> images;             /**< The shape image at "scale@rotation-stretch". */
     mutable std::map<QString, QPixmap> pixmaps;           /**< The shape pixmap at "scale@rotation-stretch". */
@@ -53,8 +66,6 @@ private:
     TargetLayer targetLayer = TargetLayer::tile;          /**< Where to place this shape. */
     unsigned int zOrdering = 0;                           /**< Z-Order position of the shape in the target layer. */
     
-    bool valid = false;                                   /**< Validity flag. */
-    
     rpgmapper::model::tile::TileInsertMode insertMode;    /**< Insert mode of tile based on this shape. */
 
 public:
@@ -67,6 +78,39 @@ public:
      */
     Shape(QString path, QByteArray const & data);
     
+    /**
+     * Constructor for a shape whose SVG is read on first use.
+     *
+     * @param   path        path to the shape resource.
+     * @param   source      the SVG file.
+     */
+    Shape(QString path, Source source);
+
+    /**
+     * Destructor.
+     */
+    ~Shape() override;
+    
+    /**
+     * Adds an image rasterized elsewhere (see rasterize()) to the drawings of this shape.
+     *
+     * This creates a pixmap and must be called on the GUI thread. Nothing is done if the
+     * drawings at this tile size, rotation and stretch are already present.
+     *
+     * @param   image           the image returned by rasterize().
+     * @param   tileSize        the tile size of the image.
+     * @param   rotation        rotation in degree.
+     * @param   stretch         stretch scaling.
+     */
+    void addImage(QImage image, unsigned int tileSize, double rotation = 0.0, double stretch = 1.0) const;
+    
+    /**
+     * Approximates the memory held by the cached images and pixmaps of this shape.
+     *
+     * @return  the number of bytes of all cached drawings.
+     */
+    long long getCacheBytes() const;
+
     /**
      * Gets the icon of this shape at a specific tile size, rotation and stretch.
      *
@@ -143,6 +187,16 @@ public:
         return zOrdering;
     }
     
+    /**
+     * Checks if the drawings at a specific tile size, rotation and stretch are present.
+     *
+     * @param   tileSize        the tile size of the image.
+     * @param   rotation        rotation in degree.
+     * @param   stretch         stretch scaling.
+     * @return  true, if the icon, image and pixmap are cached.
+     */
+    bool isPrepared(unsigned int tileSize, double rotation = 0.0, double stretch = 1.0) const;
+    
     /**
      * Checks if the given data array could contain a shape.
      *
@@ -152,13 +206,36 @@ public:
     static bool isShape(QByteArray const & data);
     
     /**
-     * Checks if this ColorPalette is a valid instance.
+     * Checks if data of the given mime type could contain a shape.
+     *
+     * @param   mimeType    the mime type detected for the data.
+     * @return  return true, if data of this mime type can be treated as a shape.
+     */
+    static bool isShape(QMimeType const & mimeType);
+    
+    /**
+     * Checks if this Shape is a valid instance.
+     *
+     * This does not read the SVG of a lazily loaded shape: until the SVG has been read, a
+     * shape with some data is taken as valid. Once read, the SVG is parsed once and a shape
+     * whose SVG fails to parse is invalid.
      *
      * @return  true if this is a valid instance.
      */
-    bool isValid() const override {
-        return valid;
-    }
+    bool isValid() const override;
+    
+    /**
+     * Rasterizes the shape without touching the drawings cached.
+     *
+     * The image is taken from the RasterCache or rendered from the SVG. This is thread-safe
+     * and may run on a worker thread; hand the result to addImage() on the GUI thread.
+     *
+     * @param   tileSize        the tile size of the image requested.
+     * @param   rotation        rotation in degree.
+     * @param   stretch         stretch scaling.
+     * @return  the shape as QImage at the given scale, rotation and stretch.
+     */
+    QImage rasterize(unsigned int tileSize, double rotation = 0.0, double stretch = 1.0) const;
     
     /**
      * Sets a new data to this resource.
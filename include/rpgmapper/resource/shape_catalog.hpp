@@ -21,10 +21,15 @@ namespace rpgmapper::model::resource {
 
 /**
  * A shape catalog lists known shapes with their names.
+ *
+ * Creating a catalog only parses it and may happen on any thread (e.g. while an atlas
+ * is loaded by a worker). The catalog values are applied to the shapes in the ResourceDB
+ * with applyShapes(), on the thread owning the ResourceDB, once the catalog is handed over.
  */
 class ShapeCatalog : public Resource {
     
     std::map<QString, QString> shapes;      /**< Map of shape name to shape path of this catalog. */
+    QJsonObject json;                       /**< The parsed catalog, kept to reapply it to the shapes. */
     bool valid = false;                     /**< Validity flag. */
 
 public:
@@ -37,15 +42,29 @@ public:
      */
     ShapeCatalog(QString path, QByteArray const & data);
     
+    /**
+     * Constructor for an already parsed shape catalog.
+     *
+     * @param   path        path to the shape catalog resource.
+     * @param   data        a JSON structure holding the shape catalog.
+     * @param   json        the JSON structure parsed from data.
+     */
+    ShapeCatalog(QString path, QByteArray const & data, QJsonObject json);
+    
     /**
      * Adds a single shape as defined in the JSON.
      *
-     * This method will also adjust the shape resource accordingly.
+     * The shape resource is adjusted with applyShapes() only.
      *
      * @param   json        the JSON object defining the shape.
      */
     void addShape(QJsonObject const & json);
     
+    /**
+     * Applies the catalog values to the shapes currently in the ResourceDB (again).
+     */
+    void applyShapes() const;
+    
     /**
      * Returns the catalog base path.
      *
@@ -72,6 +91,14 @@ public:
      */
     static bool isShapeCatalog(QByteArray const & data);
     
+    /**
+     * Checks if the given parsed JSON could be a shape catalog.
+     *
+     * @param   json        the JSON object to check.
+     * @return  return true, if this JSON can be treated as a shape catalog.
+     */
+    static bool isShapeCatalog(QJsonObject const & json);
+    
     /**
      * Checks if this ColorPalette is a valid instance.
      *
@@ -82,7 +109,7 @@ public:
     }
     
     /**
-     * Sets a new data to this resource.
+     * Sets a new data to this resource and applies it to the shapes in the ResourceDB.
      *
      * @param   data        the new data.
      */
@@ -91,9 +118,29 @@ public:
 private:
     
     /**
-     * Loads a shape catalog from the internal byte array data of the resource.
+     * Adjusts a single shape resource as defined in the JSON.
+     *
+     * @param   json        the JSON object defining the shape.
+     */
+    void applyShape(QJsonObject const & json) const;
+    
+    /**
+     * Loads a shape catalog from the parsed JSON of the resource.
      */
     void fromJSON();
+    
+    /**
+     * Returns the path of the shape resource defined in the JSON.
+     *
+     * @param   json        the JSON object defining the shape.
+     * @return  the path of the shape resource (empty, if none is given).
+     */
+    QString getShapePath(QJsonObject const & json) const;
+    
+    /**
+     * Parses the internal byte array data of the resource.
+     */
+    void parseData();
 };
 
 
@@ -0,0 +1,124 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#ifndef RPGMAPPER_MODEL_RESOURCE_SHAPE_INDEX_HPP
+#define RPGMAPPER_MODEL_RESOURCE_SHAPE_INDEX_HPP
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include <QHash>
+#include <QString>
+
+#include <rpgmapper/resource/shape_catalog.hpp>
+
+
+namespace rpgmapper::model::resource {
+
+
+/**
+ * A fuzzy search index over the shapes of all shape catalogs.
+ *
+ * Each shape of a catalog is indexed by the trigrams of its name, the catalog name and
+ * its path. Each word is padded, so the leading trigrams of a word act as a prefix index.
+ * A query matches entries sharing enough of its trigrams, which tolerates typos and
+ * swapped letters. Catalogs are added and removed incrementally.
+ */
+class ShapeIndex {
+
+public:
+
+    /**
+     * A single shape found.
+     */
+    struct Match {
+        QString shapePath;          /**< The resource path of the shape. */
+        QString shapeName;          /**< The name of the shape in the catalog. */
+        QString catalogPath;        /**< The resource path of the catalog. */
+        QString catalogName;        /**< The name of the catalog. */
+        float score = 0.0f;         /**< Relevance of the match (higher is better). */
+    };
+
+private:
+
+    /**
+     * A shape of a catalog indexed.
+     */
+    struct Entry {
+        QString shapePath;          /**< The resource path of the shape. */
+        QString shapeName;          /**< The name of the shape in the catalog. */
+        QString catalogPath;        /**< The resource path of the catalog. */
+        QString catalogName;        /**< The name of the catalog. */
+        QString text;               /**< The lower case text searched. */
+        bool removed = false;       /**< The catalog of the entry has been removed. */
+    };
+
+    std::vector<Entry> entries;                                     /**< All entries indexed. */
+    QHash<quint64, std::vector<std::uint32_t>> trigrams;            /**< Trigram to entries holding it. */
+    std::map<QString, std::vector<std::uint32_t>> catalogs;         /**< Catalog path to its entries. */
+    std::size_t removedEntries = 0;                                 /**< Number of entries removed. */
+
+public:
+
+    /**
+     * Adds (or replaces) the shapes of a catalog.
+     *
+     * @param   catalog     the shape catalog to index.
+     */
+    void addCatalog(ShapeCatalog const & catalog);
+
+    /**
+     * Removes all entries.
+     */
+    void clear();
+
+    /**
+     * Returns the number of shapes indexed.
+     *
+     * @return  the number of shapes of all catalogs indexed.
+     */
+    std::size_t getSize() const {
+        return entries.size() - removedEntries;
+    }
+
+    /**
+     * Removes the shapes of a catalog.
+     *
+     * @param   catalogPath     the resource path of the catalog.
+     * @return  true, if the catalog had been indexed.
+     */
+    bool removeCatalog(QString const & catalogPath);
+
+    /**
+     * Searches for shapes.
+     *
+     * @param   query           what the user typed so far.
+     * @param   maxResults      maximum number of matches returned.
+     * @return  the matches, best first.
+     */
+    std::vector<Match> search(QString const & query, std::size_t maxResults = 100) const;
+
+private:
+
+    /**
+     * Adds an entry to the trigram index.
+     *
+     * @param   id          the index of the entry.
+     */
+    void indexEntry(std::uint32_t id);
+
+    /**
+     * Rebuilds the trigram index from the entries not removed.
+     */
+    void rebuild();
+};
+
+
+}
+
+
+#endif
@@ -18,8 +18,10 @@
 
 #include <rpgmapper/command/processor_pointer.hpp>
 #include <rpgmapper/tile/tile_pointer.hpp>
+#include <rpgmapper/atlas_content.hpp>
 #include <rpgmapper/atlas_pointer.hpp>
 #include <rpgmapper/map_pointer.hpp>
+#include <rpgmapper/memory_report.hpp>
 #include <rpgmapper/region_pointer.hpp>
 #include <rpgmapper/session_pointer.hpp>
 
@@ -48,6 +50,8 @@ private:
     
     QString fileName;                   /**< Filename of the atlas loaded or recently saved. */
     
+    long long mapMemoryLimit = 256ll * 1024 * 1024;     /**< Memory the loaded maps may hold. */
+    
     rpgmapper::model::tile::TilePointer currentTile;        /**< Current selected tile. */
     rpgmapper::model::tile::TilePointer lastAppliedTile;    /**< The tile the user has just applied. */
 
@@ -215,6 +219,24 @@ public:
         return lastAppliedTile;
     }
     
+    /**
+     * Returns the memory the loaded maps may hold before maps are unloaded.
+     *
+     * @return  the memory limit of the loaded maps in bytes.
+     */
+    long long getMapMemoryLimit() const {
+        return mapMemoryLimit;
+    }
+    
+    /**
+     * Estimates the memory held by this session.
+     *
+     * This covers the atlas, the system and user resources and the undo and redo history.
+     *
+     * @return  the memory report of this session.
+     */
+    MemoryReport getMemoryReport() const;
+
     /**
      * Gets the region name of a given map.
      *
@@ -249,6 +271,19 @@ public:
      */
     static bool load(SessionPointer & session, QFile & file, QStringList & log);
     
+    /**
+     * Creates a session from the content of an atlas file read before (e.g. by an AtlasLoader).
+     *
+     * This creates the atlas and has to run on the GUI thread.
+     *
+     * @param   session     the loaded session.
+     * @param   content     the content of the atlas file.
+     * @param   fileName    the atlas file the content has been read from.
+     * @param   log         Protocol of operations.
+     * @return  true, if successfully loaded.
+     */
+    static bool load(SessionPointer & session, AtlasContent const & content, QString fileName, QStringList & log);
+    
     /**
      * Saves the current session to an atlas file on disk.
      *
@@ -268,6 +303,9 @@ public:
     /**
      * Selects a new current map.
      *
+     * The map is loaded, if it has not been yet, and other maps are unloaded if the
+     * loaded maps hold more memory than allowed (see unloadMaps()).
+     *
      * @param   name        the name of the new selected map.
      */
     void selectMap(QString name);
@@ -281,10 +319,23 @@ public:
     
     /**
      * Sets a new current session.
+     *
+     * The shape catalogs local to the atlas of the session are applied to the shapes
+     * they now resolve to.
+     *
      * @param   session     the new current session
      */
     static void setCurrentSession(SessionPointer session);
     
+    /**
+     * Sets the memory the loaded maps may hold before maps are unloaded.
+     *
+     * @param   limit       the memory limit of the loaded maps in bytes.
+     */
+    void setMapMemoryLimit(long long limit) {
+        mapMemoryLimit = limit;
+    }
+    
     /**
      * Sets a new current tile.
      *
@@ -298,6 +349,15 @@ public:
      * @param   tile        the last applied tile.
      */
     void setLastAppliedTile(rpgmapper::model::tile::TilePointer & tile);
+    
+    /**
+     * Unloads the least recently used maps while the loaded maps hold more memory than allowed.
+     *
+     * The current map and modified maps stay loaded.
+     *
+     * @return  the number of maps unloaded.
+     */
+    int unloadMaps();
 
 private:
     
@@ -21,6 +21,7 @@
 
 // fwd
 namespace rpgmapper::model { class Map; }
+namespace rpgmapper::model::layer { class TileLayerCodec; }
 
 
 namespace rpgmapper::model::tile {
@@ -34,6 +35,11 @@ namespace rpgmapper::model::tile {
  */
 class Tile : public rpgmapper::model::Base {
 
+    /**
+     * Decoded tiles are placed without going through place().
+     */
+    friend class rpgmapper::model::layer::TileLayerCodec;
+
 public:
     
     /**
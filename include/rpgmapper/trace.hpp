@@ -0,0 +1,143 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#ifndef RPGMAPPER_MODEL_TRACE_HPP
+#define RPGMAPPER_MODEL_TRACE_HPP
+
+#include <atomic>
+#include <chrono>
+
+#include <QByteArray>
+#include <QString>
+
+
+namespace rpgmapper::model {
+
+
+/**
+ * Collects timed spans of the program's activities and exports them as Chrome trace-event JSON.
+ *
+ * Tracing is off by default. When disabled a span costs a single relaxed atomic load. When
+ * enabled, each thread appends to its own buffer, so threads never contend with each other.
+ * The resulting file can be opened in chrome://tracing or https://ui.perfetto.dev.
+ */
+class Trace {
+
+    static std::atomic<bool> enabled;       /**< Tracing enabled flag. */
+
+public:
+
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * Constructor.
+     */
+    Trace() = delete;
+
+    /**
+     * Records a finished span in the buffer of the calling thread.
+     *
+     * @param   name        name of the span (must be a string literal or otherwise outlive the trace).
+     * @param   start       when the span started.
+     * @param   end         when the span ended.
+     */
+    static void addSpan(char const * name, Clock::time_point start, Clock::time_point end);
+
+    /**
+     * Drops all spans recorded so far.
+     */
+    static void clear();
+
+    /**
+     * Enables or disables tracing.
+     *
+     * @param   enable      the new tracing state.
+     */
+    static void enable(bool enable = true);
+
+    /**
+     * Returns all spans recorded so far as Chrome trace-event JSON.
+     *
+     * @return  the trace as JSON document.
+     */
+    static QByteArray getChromeTrace();
+
+    /**
+     * Checks if tracing is enabled.
+     *
+     * @return  true, if spans are recorded.
+     */
+    static bool isEnabled() {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Writes all spans recorded so far as Chrome trace-event JSON file.
+     *
+     * @param   fileName    the file to write.
+     * @return  true, if the file has been written.
+     */
+    static bool writeChromeTrace(QString const & fileName);
+};
+
+
+/**
+ * Records the lifetime of an instance as a span in the trace.
+ */
+class TraceSpan {
+
+    char const * name;                  /**< The name of the span. */
+    Trace::Clock::time_point start;     /**< When the span started (only set if tracing is enabled). */
+    bool active;                        /**< True, if tracing was enabled when the span started. */
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param   name        name of the span (must be a string literal).
+     */
+    explicit TraceSpan(char const * name) : name{name}, active{Trace::isEnabled()} {
+        if (active) {
+            start = Trace::Clock::now();
+        }
+    }
+
+    /**
+     * Copy constructor.
+     */
+    TraceSpan(TraceSpan const &) = delete;
+
+    /**
+     * Destructor.
+     */
+    ~TraceSpan() {
+        if (active) {
+            Trace::addSpan(name, start, Trace::Clock::now());
+        }
+    }
+
+    /**
+     * Assignment.
+     */
+    TraceSpan & operator=(TraceSpan const &) = delete;
+};
+
+
+}
+
+
+#define RPGMAPPER_TRACE_CONCAT_IMPL(a, b)   a##b
+#define RPGMAPPER_TRACE_CONCAT(a, b)        RPGMAPPER_TRACE_CONCAT_IMPL(a, b)
+
+/**
+ * Traces the enclosing scope under the given name.
+ */
+#define RPGMAPPER_TRACE_SCOPE(name) \
+    rpgmapper::model::TraceSpan RPGMAPPER_TRACE_CONCAT(traceSpan, __LINE__){name}
+
+
+#endif
@@ -10,6 +10,7 @@
 #include <rpgmapper/exception/invalid_regionname.hpp>
 #include <rpgmapper/atlas.hpp>
 #include <rpgmapper/atlas_name_validator.hpp>
+#include <rpgmapper/map.hpp>
 #include <rpgmapper/region.hpp>
 #include <rpgmapper/resource/resource_collection.hpp>
 
@@ -96,6 +97,22 @@ QJsonObject Atlas::getJSON() const {
 }
 
 
+MemoryReport Atlas::getMemoryReport() const {
+
+    MemoryReport report;
+    for (auto const & regionPair : regions) {
+        for (auto const & mapPair : regionPair.second->getMaps()) {
+            report += mapPair.second->getMemoryReport();
+        }
+    }
+    if (resources) {
+        report += resources->getMemoryReport();
+    }
+
+    return report;
+}
+
+
 RegionPointer Atlas::getRegion(QString name) {
     auto iter = regions.find(name);
     if (iter == regions.end()) {
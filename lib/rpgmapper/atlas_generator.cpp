@@ -0,0 +1,184 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include <rpgmapper/resource/resource_db.hpp>
+#include <rpgmapper/resource/shape.hpp>
+#include <rpgmapper/tile/tile_factory.hpp>
+#include <rpgmapper/tile/tiles.hpp>
+#include <rpgmapper/atlas.hpp>
+#include <rpgmapper/atlas_generator.hpp>
+#include <rpgmapper/coordinate_system.hpp>
+#include <rpgmapper/map.hpp>
+#include <rpgmapper/region.hpp>
+
+using namespace rpgmapper::model;
+using namespace rpgmapper::model::resource;
+using namespace rpgmapper::model::tile;
+
+
+/**
+ * Colors used for color tiles, if there are no shapes.
+ */
+static char const * COLORS[] = {"#808080", "#a0522d", "#228b22", "#4682b4", "#daa520", "#2f4f4f"};
+
+
+/**
+ * Picks a random number in [0, count).
+ *
+ * std::uniform_int_distribution differs between standard libraries, this does not.
+ *
+ * @param   random      the random number generator.
+ * @param   count       the number of choices.
+ * @return  a number in [0, count).
+ */
+static std::size_t pick(std::mt19937 & random, std::size_t count) {
+    return count > 0 ? random() % count : 0;
+}
+
+
+/**
+ * Draws a random number in [0.0, 1.0).
+ *
+ * @param   random      the random number generator.
+ * @return  a number in [0.0, 1.0).
+ */
+static double chance(std::mt19937 & random) {
+    return random() / 4294967296.0;
+}
+
+
+/**
+ * Places a tile with a random rotation on the map.
+ *
+ * @param   tile        the tile to place.
+ * @param   map         the map to place the tile on.
+ * @param   position    the position of the tile.
+ * @param   random      the random number generator.
+ * @return  true, if the tile has been placed.
+ */
+static bool placeTile(TilePointer tile, Map * map, QPointF position, std::mt19937 & random) {
+
+    tile->getAttributes()["rotation"] = QString::number(90 * pick(random, 4));
+    if (!tile->isPlaceable(map, position)) {
+        return false;
+    }
+    Tiles replaced;
+    tile->place(replaced, map, position);
+    return true;
+}
+
+
+AtlasGenerator::AtlasGenerator(Settings settings) : settings{std::move(settings)} {
+    this->settings.baseDensity = std::min(std::max(this->settings.baseDensity, 0.0), 1.0);
+    this->settings.tileDensity = std::min(std::max(this->settings.tileDensity, 0.0), 1.0);
+    this->settings.maxTilesPerField = std::max(this->settings.maxTilesPerField, 1);
+}
+
+
+void AtlasGenerator::collectShapes(QStringList & log) {
+
+    baseShapes.clear();
+    tileShapes.clear();
+
+    for (auto const & path : ResourceDB::getResources("/shapes")) {
+        auto resource = ResourceDB::getResource(path);
+        auto shape = dynamic_cast<Shape *>(resource.data());
+        if (!shape || !shape->isValid()) {
+            continue;
+        }
+        switch (shape->getTargetLayer()) {
+
+            case Shape::TargetLayer::base:
+                baseShapes.push_back(path);
+                break;
+
+            case Shape::TargetLayer::tile:
+                tileShapes.push_back(path);
+                break;
+
+            case Shape::TargetLayer::unknown:
+                break;
+        }
+    }
+
+    log.append(QString{"Generator uses %1 base shapes and %2 tile shapes."}
+            .arg(baseShapes.size())
+            .arg(tileShapes.size()));
+}
+
+
+unsigned long AtlasGenerator::fillMap(Map * map, std::mt19937 & random) const {
+
+    unsigned long placed = 0;
+
+    map->getCoordinateSystem()->resize(settings.mapSize);
+    for (int y = 0; y < settings.mapSize.height(); ++y) {
+        for (int x = 0; x < settings.mapSize.width(); ++x) {
+
+            QPointF position{static_cast<qreal>(x), static_cast<qreal>(y)};
+
+            if (chance(random) < settings.baseDensity) {
+                TilePointer tile;
+                if (!baseShapes.empty()) {
+                    tile = TileFactory::create(TileType::shape, {{"path", baseShapes[pick(random, baseShapes.size())]}});
+                }
+                else {
+                    auto color = COLORS[pick(random, sizeof(COLORS) / sizeof(COLORS[0]))];
+                    tile = TileFactory::create(TileType::color, {{"color", color}});
+                }
+                placed += placeTile(tile, map, position, random) ? 1 : 0;
+            }
+
+            if (!tileShapes.empty() && (chance(random) < settings.tileDensity)) {
+                auto count = 1 + pick(random, static_cast<std::size_t>(settings.maxTilesPerField));
+                for (std::size_t i = 0; i < count; ++i) {
+                    auto path = tileShapes[pick(random, tileShapes.size())];
+                    auto tile = TileFactory::create(TileType::shape, {{"path", path}});
+                    placed += placeTile(tile, map, position, random) ? 1 : 0;
+                }
+            }
+        }
+    }
+
+    return placed;
+}
+
+
+AtlasPointer AtlasGenerator::generate(QStringList & log) {
+
+    if (!CoordinateSystem::isValidSize(settings.mapSize)) {
+        throw std::runtime_error{"Invalid map size for generated atlas."};
+    }
+
+    collectShapes(log);
+
+    std::mt19937 random{settings.seed};
+    auto atlas = AtlasPointer{new Atlas{QString{"Generated Atlas %1"}.arg(settings.seed)}};
+
+    unsigned long tiles = 0;
+    for (int r = 0; r < settings.regions; ++r) {
+
+        auto region = RegionPointer{new Region{QString{"Region %1"}.arg(r + 1)}};
+        atlas->addRegion(region);
+
+        for (int m = 0; m < settings.mapsPerRegion; ++m) {
+            auto map = MapPointer{new Map{QString{"Map %1-%2"}.arg(r + 1).arg(m + 1)}};
+            region->addMap(map);
+            tiles += fillMap(map.data(), random);
+        }
+    }
+
+    log.append(QString{"Generated %1 regions with %2 maps each, %3 tiles placed."}
+            .arg(settings.regions)
+            .arg(settings.mapsPerRegion)
+            .arg(tiles));
+
+    return atlas;
+}
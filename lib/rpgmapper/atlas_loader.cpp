@@ -0,0 +1,117 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#include <QFile>
+#include <QRunnable>
+
+#include <rpgmapper/atlas_loader.hpp>
+#include <rpgmapper/session.hpp>
+#include <rpgmapper/trace.hpp>
+
+#include "zip.hpp"
+
+using namespace rpgmapper::model;
+
+
+/**
+ * Reads an atlas file on the worker thread and reports back to the loader.
+ */
+class AtlasLoaderRunnable : public QRunnable {
+
+    AtlasLoader * loader;                       /**< The loader to report to. */
+    std::atomic<bool> & cancelRequested;        /**< Set, if the user cancelled. */
+    QString fileName;                           /**< The atlas file to read. */
+    std::function<void(AtlasContent, bool, QStringList)> complete;     /**< Completes the load on the loader thread. */
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param   loader              the loader to report to.
+     * @param   cancelRequested     set, if the user cancelled.
+     * @param   fileName            the atlas file to read.
+     * @param   complete            completes the load on the loader thread.
+     */
+    AtlasLoaderRunnable(AtlasLoader * loader,
+            std::atomic<bool> & cancelRequested,
+            QString fileName,
+            std::function<void(AtlasContent, bool, QStringList)> complete)
+            : loader{loader}, cancelRequested{cancelRequested}, fileName{std::move(fileName)},
+              complete{std::move(complete)} {}
+
+    /**
+     * Reads the atlas file.
+     */
+    void run() override {
+        RPGMAPPER_TRACE_SCOPE("AtlasLoader::run");
+
+        QStringList log;
+        AtlasContent content;
+        QFile file{fileName};
+        auto progress = [this] (int done, int total) {
+            emit loader->progress(done, total);
+            return !cancelRequested.load();
+        };
+        bool read = readAtlasContent(content, file, progress, log);
+
+        QMetaObject::invokeMethod(loader, [complete = complete, content, read, log] () {
+            complete(content, read, log);
+        }, Qt::QueuedConnection);
+    }
+};
+
+
+AtlasLoader::AtlasLoader(QObject * parent) : QObject{parent} {
+    pool.setMaxThreadCount(1);
+}
+
+
+AtlasLoader::~AtlasLoader() {
+    cancel();
+    pool.waitForDone();
+}
+
+
+void AtlasLoader::cancel() {
+    cancelRequested = true;
+}
+
+
+void AtlasLoader::complete(AtlasContent const & content, bool read, QStringList log) {
+
+    running = false;
+    if (!read) {
+        emit failed(log, cancelRequested.load());
+        return;
+    }
+
+    SessionPointer session;
+    if (!Session::load(session, content, fileName, log)) {
+        emit failed(log, false);
+        return;
+    }
+
+    emit finished(session, log);
+}
+
+
+bool AtlasLoader::start(QString fileName) {
+
+    if (running) {
+        return false;
+    }
+
+    running = true;
+    cancelRequested = false;
+    this->fileName = fileName;
+    pool.start(new AtlasLoaderRunnable{this, cancelRequested, std::move(fileName),
+            [this] (AtlasContent content, bool read, QStringList log) {
+                complete(content, read, std::move(log));
+            }});
+
+    return true;
+}
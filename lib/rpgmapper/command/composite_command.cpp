@@ -5,7 +5,9 @@
  */
 
 #include <rpgmapper/command/composite_command.hpp>
+#include <rpgmapper/memory_report.hpp>
 
+using namespace rpgmapper::model;
 using namespace rpgmapper::model::command;
 
 
@@ -30,6 +32,15 @@ QString CompositeCommand::getDescription() const {
 }
 
 
+long long CompositeCommand::getMemorySize() const {
+    auto size = static_cast<long long>(sizeof(CompositeCommand));
+    for (auto const & command : commands) {
+        size += command->getMemorySize() + MemoryReport::getSharedPointerOverhead();
+    }
+    return size;
+}
+
+
 void CompositeCommand::execute() {
     for (auto & command : commands) {
         command->execute();
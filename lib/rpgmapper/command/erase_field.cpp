@@ -10,6 +10,7 @@
 #include <rpgmapper/exception/invalid_map.hpp>
 #include <rpgmapper/field.hpp>
 #include <rpgmapper/map.hpp>
+#include <rpgmapper/memory_report.hpp>
 
 using namespace rpgmapper::model;
 using namespace rpgmapper::model::command;
@@ -45,6 +46,19 @@ QString EraseField::getDescription() const {
 }
 
 
+long long EraseField::getMemorySize() const {
+    MemoryReport report;
+    for (auto const & pair : removedBaseTiles) {
+        report.addTiles(pair.second);
+    }
+    for (auto const & pair : removedTileTiles) {
+        report.addTiles(pair.second);
+    }
+    auto nodes = static_cast<long long>(removedBaseTiles.size() + removedTileTiles.size());
+    return static_cast<long long>(sizeof(EraseField)) + nodes * MemoryReport::getMapNodeOverhead() + report.getTotal();
+}
+
+
 void EraseField::remove(std::map<unsigned int, rpgmapper::model::tile::Tiles> & backup,
         std::vector<QSharedPointer<rpgmapper::model::layer::TileLayer>> & layers) {
 
@@ -11,6 +11,7 @@
 #include <rpgmapper/tile/tile.hpp>
 #include <rpgmapper/tile/tiles.hpp>
 #include <rpgmapper/map.hpp>
+#include <rpgmapper/memory_report.hpp>
 #include <rpgmapper/session.hpp>
 
 using namespace rpgmapper::model;
@@ -49,6 +50,16 @@ QString PlaceTile::getDescription() const {
 }
 
 
+long long PlaceTile::getMemorySize() const {
+    MemoryReport report;
+    if (tile) {
+        report.addTile(*tile);
+    }
+    report.addTiles(replacedTiles);
+    return static_cast<long long>(sizeof(PlaceTile)) + report.getTotal();
+}
+
+
 void PlaceTile::undo() {
     
     if (!map || !map->isValid()) {
@@ -5,6 +5,7 @@
  */
 
 #include <rpgmapper/command/processor.hpp>
+#include <rpgmapper/trace.hpp>
 #include "processor_impl.hpp"
 
 using namespace rpgmapper::model::command;
@@ -16,6 +17,7 @@ Processor::Processor(QObject * parent) : QObject(parent) {
 
 
 void Processor::execute(CommandPointer command) {
+    RPGMAPPER_TRACE_SCOPE("Processor::execute");
     impl->execute(command);
     emit commandExecuted();
 }
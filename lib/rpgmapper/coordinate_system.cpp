@@ -132,10 +132,7 @@ bool CoordinateSystem::applyJSONSize(QJsonObject const & json) {
         size.setHeight(static_cast<int>(json["height"].toDouble()));
     }
 
-    if (size.width() < getMinimumSize().width() || size.width() >= getMaximumSize().width()) {
-        return false;
-    }
-    if (size.height() < getMinimumSize().height() || size.height() >= getMaximumSize().height()) {
+    if (!isValidSize(size)) {
         return false;
     }
 
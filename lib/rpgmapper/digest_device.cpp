@@ -0,0 +1,26 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#include "digest_device.hpp"
+
+using namespace rpgmapper::model;
+
+
+DigestDevice::DigestDevice(QIODevice * target) : target{target} {
+    open(QIODevice::WriteOnly | QIODevice::Unbuffered);
+}
+
+
+qint64 DigestDevice::writeData(char const * data, qint64 size) {
+
+    if (target && (target->write(data, size) != size)) {
+        return -1;
+    }
+    hash.addData(data, static_cast<int>(size));
+    written += size;
+
+    return size;
+}
@@ -0,0 +1,91 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#ifndef RPGMAPPER_MODEL_DIGEST_DEVICE_HPP
+#define RPGMAPPER_MODEL_DIGEST_DEVICE_HPP
+
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <QIODevice>
+
+
+namespace rpgmapper::model {
+
+
+/**
+ * A write only device computing the SHA-1 digest of all data written.
+ *
+ * The data is passed on to a target device, if any. This way a stream is hashed (and
+ * measured) on its way to the target without holding it in memory.
+ */
+class DigestDevice : public QIODevice {
+
+    QIODevice * target;                                         /**< Receives the data written (may be nullptr). */
+    QCryptographicHash hash{QCryptographicHash::Sha1};          /**< The digest so far. */
+    qint64 written = 0;                                         /**< Number of bytes written. */
+
+public:
+
+    /**
+     * Constructor: the device is opened for writing right away.
+     *
+     * @param   target      the device receiving the data written (may be nullptr).
+     */
+    explicit DigestDevice(QIODevice * target = nullptr);
+
+    /**
+     * Returns the digest of all data written so far.
+     *
+     * @return  the SHA-1 digest.
+     */
+    QByteArray getDigest() const {
+        return hash.result();
+    }
+
+    /**
+     * Returns the number of bytes written so far.
+     *
+     * @return  the number of bytes written.
+     */
+    qint64 getWritten() const {
+        return written;
+    }
+
+    /**
+     * This device is a stream.
+     *
+     * @return  always true.
+     */
+    bool isSequential() const override {
+        return true;
+    }
+
+protected:
+
+    /**
+     * Reading is not supported.
+     *
+     * @return  always -1.
+     */
+    qint64 readData(char *, qint64) override {
+        return -1;
+    }
+
+    /**
+     * Hashes the data and passes it on to the target.
+     *
+     * @param   data        the data to write.
+     * @param   size        the number of bytes to write.
+     * @return  the number of bytes written (-1 if the target failed).
+     */
+    qint64 writeData(char const * data, qint64 size) override;
+};
+
+
+}
+
+
+#endif
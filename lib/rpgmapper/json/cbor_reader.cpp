@@ -0,0 +1,102 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#include <QCborMap>
+#include <QCborValue>
+
+#include <rpgmapper/json/cbor_reader.hpp>
+
+using namespace rpgmapper::model::json;
+
+
+bool CBORReader::readArray(QCborStreamReader & reader, ElementReader const & readElement) {
+
+    if (!reader.isArray() || !reader.enterContainer()) {
+        return false;
+    }
+    while (reader.hasNext()) {
+        if (!readElement(reader)) {
+            return false;
+        }
+    }
+
+    return (reader.lastError() == QCborError::NoError) && reader.leaveContainer();
+}
+
+
+bool CBORReader::readBytes(QCborStreamReader & reader, QByteArray & data) {
+
+    if (reader.isString()) {
+        QString string;
+        if (!readString(reader, string)) {
+            return false;
+        }
+        data = QByteArray::fromBase64(string.toLatin1());
+        return true;
+    }
+
+    if (!reader.isByteArray()) {
+        return false;
+    }
+    data.clear();
+    auto chunk = reader.readByteArray();
+    while (chunk.status == QCborStreamReader::Ok) {
+        data.append(chunk.data);
+        chunk = reader.readByteArray();
+    }
+
+    return chunk.status == QCborStreamReader::EndOfString;
+}
+
+
+bool CBORReader::readObject(QCborStreamReader & reader, ValueReader const & readValue) {
+
+    if (!reader.isMap() || !reader.enterContainer()) {
+        return false;
+    }
+    while (reader.hasNext()) {
+        QString key;
+        if (!readString(reader, key) || !readValue(key, reader)) {
+            return false;
+        }
+    }
+
+    return (reader.lastError() == QCborError::NoError) && reader.leaveContainer();
+}
+
+
+bool CBORReader::readObject(QCborStreamReader & reader, QJsonObject & json) {
+
+    if (!reader.isMap()) {
+        return false;
+    }
+    auto value = QCborValue::fromCbor(reader);
+    json = value.toMap().toJsonObject();
+
+    return reader.lastError() == QCborError::NoError;
+}
+
+
+bool CBORReader::readString(QCborStreamReader & reader, QString & string) {
+
+    if (!reader.isString()) {
+        return false;
+    }
+    string.clear();
+    auto chunk = reader.readString();
+    while (chunk.status == QCborStreamReader::Ok) {
+        string.append(chunk.data);
+        chunk = reader.readString();
+    }
+
+    return chunk.status == QCborStreamReader::EndOfString;
+}
+
+
+bool CBORReader::readValue(QCborStreamReader & reader, QJsonValue & value) {
+    value = QCborValue::fromCbor(reader).toJsonValue();
+    return reader.lastError() == QCborError::NoError;
+}
@@ -0,0 +1,76 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#include <cmath>
+
+#include <rpgmapper/json/cbor_writer.hpp>
+
+using namespace rpgmapper::model::json;
+
+
+CBORWriter::CBORWriter(QByteArray * data) : writer{data} {
+}
+
+
+CBORWriter::CBORWriter(QIODevice * device) : writer{device} {
+}
+
+
+void CBORWriter::beginArray() {
+    writer.startArray();
+}
+
+
+void CBORWriter::beginObject() {
+    writer.startMap();
+}
+
+
+void CBORWriter::endArray() {
+    writer.endArray();
+}
+
+
+void CBORWriter::endObject() {
+    writer.endMap();
+}
+
+
+void CBORWriter::writeBool(bool value) {
+    writer.append(value);
+}
+
+
+void CBORWriter::writeBytes(QByteArray const & data) {
+    writer.append(data);
+}
+
+
+void CBORWriter::writeDouble(double value) {
+
+    // integral numbers (sizes, positions, ...) take far less space as integers
+    if (std::isfinite(value) && (std::trunc(value) == value) && (std::fabs(value) <= 9007199254740992.0)) {
+        writer.append(static_cast<qint64>(value));
+    }
+    else {
+        writer.append(value);
+    }
+}
+
+
+void CBORWriter::writeKey(QString const & key) {
+    writer.append(key);
+}
+
+
+void CBORWriter::writeNull() {
+    writer.appendNull();
+}
+
+
+void CBORWriter::writeString(QString const & value) {
+    writer.append(value);
+}
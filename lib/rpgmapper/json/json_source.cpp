@@ -0,0 +1,14 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#include <rpgmapper/json/json_source.hpp>
+
+using namespace rpgmapper::model::json;
+
+
+void JSONSource::writeJSON(JSONWriter & writer) const {
+    writer.writeValue(getJSON());
+}
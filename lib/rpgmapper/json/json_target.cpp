@@ -0,0 +1,16 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#include <rpgmapper/json/cbor_reader.hpp>
+#include <rpgmapper/json/json_target.hpp>
+
+using namespace rpgmapper::model::json;
+
+
+bool JSONTarget::readCBOR(QCborStreamReader & reader) {
+    QJsonObject json;
+    return CBORReader::readObject(reader, json) && applyJSON(json);
+}
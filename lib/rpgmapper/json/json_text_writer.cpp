@@ -0,0 +1,161 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#include <cmath>
+
+#include <QLocale>
+
+#include <rpgmapper/json/json_text_writer.hpp>
+
+using namespace rpgmapper::model::json;
+
+
+/**
+ * Quotes a string as JSON string.
+ *
+ * @param   string      the string to quote.
+ * @return  the quoted and escaped string as UTF-8.
+ */
+static QByteArray quote(QString const & string);
+
+
+JSONTextWriter::JSONTextWriter(QIODevice * device) : device{device} {
+}
+
+
+void JSONTextWriter::beginArray() {
+    writeToken("[");
+    firstValue.push_back(true);
+}
+
+
+void JSONTextWriter::beginObject() {
+    writeToken("{");
+    firstValue.push_back(true);
+}
+
+
+void JSONTextWriter::endArray() {
+    firstValue.pop_back();
+    device->write("]");
+}
+
+
+void JSONTextWriter::endObject() {
+    firstValue.pop_back();
+    device->write("}");
+}
+
+
+void JSONTextWriter::writeBool(bool value) {
+    writeToken(value ? "true" : "false");
+}
+
+
+void JSONTextWriter::writeBytes(QByteArray const & data) {
+    writeToken('"' + data.toBase64() + '"');
+}
+
+
+void JSONTextWriter::writeDouble(double value) {
+
+    if (!std::isfinite(value)) {
+        writeToken("null");
+    }
+    else
+    if ((std::trunc(value) == value) && (std::fabs(value) <= 9007199254740992.0)) {
+        writeToken(QByteArray::number(static_cast<qint64>(value)));
+    }
+    else {
+        writeToken(QByteArray::number(value, 'g', QLocale::FloatingPointShortest));
+    }
+}
+
+
+void JSONTextWriter::writeKey(QString const & key) {
+    writeSeparator();
+    device->write(quote(key) + ':');
+    keyWritten = true;
+}
+
+
+void JSONTextWriter::writeNull() {
+    writeToken("null");
+}
+
+
+void JSONTextWriter::writeSeparator() {
+
+    if (keyWritten) {
+        keyWritten = false;
+        return;
+    }
+    if (!firstValue.empty()) {
+        if (!firstValue.back()) {
+            device->write(",");
+        }
+        firstValue.back() = false;
+    }
+}
+
+
+void JSONTextWriter::writeString(QString const & value) {
+    writeToken(quote(value));
+}
+
+
+void JSONTextWriter::writeToken(QByteArray const & text) {
+    writeSeparator();
+    device->write(text);
+}
+
+
+QByteArray quote(QString const & string) {
+
+    static char const * hexDigits = "0123456789abcdef";
+
+    auto utf8 = string.toUtf8();
+    QByteArray quoted;
+    quoted.reserve(utf8.size() + 2);
+    quoted.append('"');
+    for (auto c : utf8) {
+        switch (c) {
+            case '"':
+                quoted.append("\\\"");
+                break;
+            case '\\':
+                quoted.append("\\\\");
+                break;
+            case '\b':
+                quoted.append("\\b");
+                break;
+            case '\f':
+                quoted.append("\\f");
+                break;
+            case '\n':
+                quoted.append("\\n");
+                break;
+            case '\r':
+                quoted.append("\\r");
+                break;
+            case '\t':
+                quoted.append("\\t");
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    quoted.append("\\u00");
+                    quoted.append(hexDigits[c >> 4]);
+                    quoted.append(hexDigits[c & 0x0f]);
+                }
+                else {
+                    quoted.append(c);
+                }
+        }
+    }
+    quoted.append('"');
+
+    return quoted;
+}
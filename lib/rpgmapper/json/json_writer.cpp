@@ -0,0 +1,55 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#include <QJsonArray>
+#include <QJsonObject>
+
+#include <rpgmapper/json/json_writer.hpp>
+
+using namespace rpgmapper::model::json;
+
+
+void JSONWriter::writeValue(QJsonValue const & value) {
+
+    switch (value.type()) {
+
+        case QJsonValue::Array:
+            beginArray();
+            for (auto const & element : value.toArray()) {
+                writeValue(element);
+            }
+            endArray();
+            break;
+
+        case QJsonValue::Bool:
+            writeBool(value.toBool());
+            break;
+
+        case QJsonValue::Double:
+            writeDouble(value.toDouble());
+            break;
+
+        case QJsonValue::Object: {
+            beginObject();
+            auto object = value.toObject();
+            for (auto iter = object.constBegin(); iter != object.constEnd(); ++iter) {
+                writeKey(iter.key());
+                writeValue(iter.value());
+            }
+            endObject();
+            break;
+        }
+
+        case QJsonValue::String:
+            writeString(value.toString());
+            break;
+
+        case QJsonValue::Null:
+        case QJsonValue::Undefined:
+            writeNull();
+            break;
+    }
+}
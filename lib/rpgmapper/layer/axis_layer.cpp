@@ -7,6 +7,7 @@
 #include <rpgmapper/exception/invalid_map.hpp>
 #include <rpgmapper/coordinate_system.hpp>
 #include <rpgmapper/map.hpp>
+#include <rpgmapper/trace.hpp>
 
 using namespace rpgmapper::model::layer;
 
@@ -26,6 +27,7 @@ AxisLayer::AxisLayer(Map * map) : Layer{map} {
 
 
 void AxisLayer::draw(QPainter & painter, int tileSize) const {
+    RPGMAPPER_TRACE_SCOPE("AxisLayer::draw");
     drawXAnnotation(painter, tileSize);
     drawYAnnotation(painter, tileSize);
 }
@@ -16,6 +16,8 @@
 #include <rpgmapper/coordinate_system.hpp>
 #include <rpgmapper/map.hpp>
 #include <rpgmapper/region.hpp>
+#include <rpgmapper/render_statistics.hpp>
+#include <rpgmapper/trace.hpp>
 
 using namespace rpgmapper::model;
 using namespace rpgmapper::model::layer;
@@ -34,6 +36,17 @@ using namespace rpgmapper::model::resource;
 static char const * BACKGROUND_COLOR_DEFAULT = "#dddddd";
 
 
+/**
+ * Approximates the memory held by a pixmap.
+ *
+ * @param   pixmap      the pixmap.
+ * @return  the number of bytes held by the pixmap.
+ */
+static long long getBytes(QPixmap const * pixmap) {
+    return static_cast<long long>(pixmap->width()) * pixmap->height() * pixmap->depth() / 8;
+}
+
+
 BackgroundLayer::BackgroundLayer(Map * map) : Layer{map}, backgroundPixmap{nullptr} {
     getAttributes()["color"] = BACKGROUND_COLOR_DEFAULT;
     getAttributes()["rendering"] = "color";
@@ -44,6 +57,7 @@ BackgroundLayer::BackgroundLayer(Map * map) : Layer{map}, backgroundPixmap{nullp
 
 BackgroundLayer::~BackgroundLayer() {
     if (backgroundPixmap) {
+        RenderStatistics::addPixmapBytes(-getBytes(backgroundPixmap));
         delete backgroundPixmap;
     }
 }
@@ -70,6 +84,7 @@ bool BackgroundLayer::applyJSON(QJsonObject const & json) {
 }
 
 void BackgroundLayer::draw(QPainter & painter, int tileSize) const {
+    RPGMAPPER_TRACE_SCOPE("BackgroundLayer::draw");
     
     auto map = getMap();
     if (!map) {
@@ -134,6 +149,11 @@ QJsonObject BackgroundLayer::getJSON() const {
 }
 
 
+long long BackgroundLayer::getPixmapBytes() const {
+    return backgroundPixmap ? getBytes(backgroundPixmap) : 0;
+}
+
+
 QString BackgroundLayer::getRendering() const {
     auto pair = getAttributes().find("rendering");
     if (pair == getAttributes().end()) {
@@ -182,6 +202,7 @@ void BackgroundLayer::setImageResource(QString path) {
         if (resource) {
     
             if (backgroundPixmap) {
+                RenderStatistics::addPixmapBytes(-getBytes(backgroundPixmap));
                 delete backgroundPixmap;
                 backgroundPixmap = nullptr;
             }
@@ -189,6 +210,7 @@ void BackgroundLayer::setImageResource(QString path) {
             auto backgroundResource = dynamic_cast<rpgmapper::model::resource::Background *>(resource.data());
             if (backgroundResource->isValid()) {
                 backgroundPixmap = new QPixmap{QPixmap::fromImage(backgroundResource->getImage())};
+                RenderStatistics::addPixmapBytes(getBytes(backgroundPixmap));
             }
         }
         
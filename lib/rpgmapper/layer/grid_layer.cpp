@@ -7,6 +7,7 @@
 #include <rpgmapper/exception/invalid_map.hpp>
 #include <rpgmapper/coordinate_system.hpp>
 #include <rpgmapper/map.hpp>
+#include <rpgmapper/trace.hpp>
 
 using namespace rpgmapper::model::layer;
 
@@ -22,63 +23,54 @@ GridLayer::GridLayer(Map * map) : Layer{map} {
 }
 
 
-void GridLayer::draw(QPainter & painter, int tileSize) const {
-    drawXAxis(painter, tileSize);
-    drawYAxis(painter, tileSize);
-    drawBorder(painter, tileSize);
-}
-
-
-void GridLayer::drawBorder(QPainter & painter, int tileSize) const {
+void GridLayer::createBorderLines(GridLines & lines) {
     
-    auto map = getMap();
-    if (!map) {
-        throw exception::invalid_map{};
-    }
+    auto const & rect = lines.rect;
+    auto tileSize = lines.tileSize;
+    auto right = rect.x() + rect.width();
+    auto bottom = rect.y() + rect.height();
+    
+    lines.borderLines.append(QLine{rect.x(), rect.y(), right, rect.y()});
+    lines.borderLines.append(QLine{rect.x(), bottom, right, bottom});
+    lines.borderLines.append(QLine{rect.x(), rect.y(), rect.x(), bottom});
+    lines.borderLines.append(QLine{right, rect.y(), right, bottom});
     
-    auto rect = map->getCoordinateSystem()->getInnerRect(tileSize);
-    painter.setPen(QPen(getColor(), 1, Qt::SolidLine, Qt::FlatCap));
-    painter.drawRect(rect);
-
     auto nOuterTickLength = tileSize / 4;
     for (int x = 0; x <= rect.width(); x += tileSize) {
-        painter.drawLine(rect.x() + x, rect.y() - nOuterTickLength, rect.x() + x, rect.y());
-        painter.drawLine(rect.x() + x, rect.bottom(), rect.x() + x, rect.bottom() + nOuterTickLength);
+        lines.borderLines.append(QLine{rect.x() + x, rect.y() - nOuterTickLength, rect.x() + x, rect.y()});
+        lines.borderLines.append(QLine{rect.x() + x, rect.bottom(), rect.x() + x, rect.bottom() + nOuterTickLength});
     }
     for (int y = 0; y <= rect.height(); y += tileSize) {
-        painter.drawLine(rect.x() - nOuterTickLength, rect.y() + y, rect.x(), rect.y() + y);
-        painter.drawLine(rect.right(), rect.y() + y, rect.right() + nOuterTickLength, rect.y() + y);
+        lines.borderLines.append(QLine{rect.x() - nOuterTickLength, rect.y() + y, rect.x(), rect.y() + y});
+        lines.borderLines.append(QLine{rect.right(), rect.y() + y, rect.right() + nOuterTickLength, rect.y() + y});
     }
 }
 
 
-void GridLayer::drawXAxis(QPainter & painter, int tileSize) const {
+void GridLayer::createInnerLines(GridLines & lines) {
     
-    auto map = getMap();
-    if (!map) {
-        throw exception::invalid_map{};
-    }
+    auto const & rect = lines.rect;
+    auto tileSize = lines.tileSize;
     
-    auto rect = map->getCoordinateSystem()->getInnerRect(tileSize);
-    painter.setPen(QPen(getColor(), 1, Qt::DotLine, Qt::FlatCap));
     for (int y = tileSize; y <= rect.height() - tileSize; y += tileSize) {
-        painter.drawLine(rect.x(), rect.y() + y, rect.x() + rect.width(), rect.y() + y);
+        lines.innerLines.append(QLine{rect.x(), rect.y() + y, rect.x() + rect.width(), rect.y() + y});
+    }
+    for (int x = tileSize; x <= rect.width() - tileSize; x += tileSize) {
+        lines.innerLines.append(QLine{rect.x() + x, rect.y(), rect.x() + x, rect.y() + rect.height()});
     }
 }
 
 
-void GridLayer::drawYAxis(QPainter & painter, int tileSize) const {
+void GridLayer::draw(QPainter & painter, int tileSize) const {
+    RPGMAPPER_TRACE_SCOPE("GridLayer::draw");
     
-    auto map = getMap();
-    if (!map) {
-        throw exception::invalid_map{};
-    }
+    auto const & lines = getGridLines(tileSize);
+    auto color = getColor();
     
-    auto rect = map->getCoordinateSystem()->getInnerRect(tileSize);
-    painter.setPen(QPen(getColor(), 1, Qt::DotLine, Qt::FlatCap));
-    for (int x = tileSize; x <= rect.width() - tileSize; x += tileSize) {
-        painter.drawLine(rect.x() + x, rect.y(), rect.x() + x, rect.y() + rect.height());
-    }
+    painter.setPen(QPen(color, 1, Qt::DotLine, Qt::FlatCap));
+    painter.drawLines(lines.innerLines);
+    painter.setPen(QPen(color, 1, Qt::SolidLine, Qt::FlatCap));
+    painter.drawLines(lines.borderLines);
 }
 
 
@@ -91,6 +83,32 @@ QColor GridLayer::getColor() const {
 }
 
 
+GridLayer::GridLines const & GridLayer::getGridLines(int tileSize) const {
+    
+    auto map = getMap();
+    if (!map) {
+        throw exception::invalid_map{};
+    }
+    
+    if (tileSize <= 0) {
+        gridLines = GridLines{};
+        return gridLines;
+    }
+    
+    auto rect = map->getCoordinateSystem()->getInnerRect(tileSize);
+    if ((gridLines.rect != rect) || (gridLines.tileSize != tileSize)) {
+        
+        gridLines = GridLines{};
+        gridLines.rect = rect;
+        gridLines.tileSize = tileSize;
+        createInnerLines(gridLines);
+        createBorderLines(gridLines);
+    }
+    
+    return gridLines;
+}
+
+
 QJsonObject GridLayer::getJSON() const {
     QJsonObject jsonObject = Layer::getJSON();
     jsonObject["color"] = getColor().name(QColor::HexArgb);
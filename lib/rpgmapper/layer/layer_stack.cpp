@@ -4,8 +4,10 @@
  * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
  */
 
+#include <rpgmapper/json/cbor_reader.hpp>
 #include <rpgmapper/layer/layer_stack.hpp>
 
+using namespace rpgmapper::model::json;
 using namespace rpgmapper::model::layer;
 
 
@@ -71,9 +73,9 @@ bool LayerStack::applyJSONTileLayers(QJsonArray const & jsonArray) {
     bool applied = true;
     tileLayers.clear();
     for (auto && json : jsonArray) {
-        auto baseLayer = QSharedPointer<TileLayer>{new TileLayer{getMap()}};
-        applied = applied && baseLayer->applyJSON(json.toObject());
-        baseLayers.push_back(baseLayer);
+        auto tileLayer = QSharedPointer<TileLayer>{new TileLayer{getMap()}};
+        applied = applied && tileLayer->applyJSON(json.toObject());
+        tileLayers.push_back(tileLayer);
     }
     
     return applied;
@@ -105,6 +107,71 @@ QJsonObject LayerStack::getJSON() const {
 }
 
 
+std::list<std::pair<QString, Layer const *>> LayerStack::getVisibleLayers(bool gridVisible, bool axisVisible) const {
+    
+    std::list<std::pair<QString, Layer const *>> layers;
+    
+    layers.emplace_back("background", getBackgroundLayer().data());
+    for (auto const & baseLayer : getBaseLayers()) {
+        layers.emplace_back("base", baseLayer.data());
+    }
+    if (gridVisible) {
+        layers.emplace_back("grid", getGridLayer().data());
+    }
+    if (axisVisible) {
+        layers.emplace_back("axis", getAxisLayer().data());
+    }
+    for (auto const & tileLayer : getTileLayers()) {
+        layers.emplace_back("tile", tileLayer.data());
+    }
+    layers.emplace_back("text", getTextLayer().data());
+    
+    return layers;
+}
+
+
+bool LayerStack::readCBOR(QCborStreamReader & reader) {
+    
+    auto readLayer = [&] (QString const & key, QCborStreamReader & layerReader) -> bool {
+        if (key == "background") {
+            return getBackgroundLayer()->readCBOR(layerReader);
+        }
+        if (key == "base") {
+            return readCBORTileLayers(layerReader, baseLayers);
+        }
+        if (key == "grid") {
+            return getGridLayer()->readCBOR(layerReader);
+        }
+        if (key == "axis") {
+            return getAxisLayer()->readCBOR(layerReader);
+        }
+        if (key == "tile") {
+            return readCBORTileLayers(layerReader, tileLayers);
+        }
+        if (key == "text") {
+            return getTextLayer()->readCBOR(layerReader);
+        }
+        QJsonValue unknown;
+        return CBORReader::readValue(layerReader, unknown);
+    };
+    
+    return CBORReader::readObject(reader, readLayer);
+}
+
+
+bool LayerStack::readCBORTileLayers(QCborStreamReader & reader, std::vector<QSharedPointer<TileLayer>> & layers) {
+    
+    layers.clear();
+    auto readLayer = [&] (QCborStreamReader & layerReader) -> bool {
+        auto tileLayer = QSharedPointer<TileLayer>{new TileLayer{getMap()}};
+        layers.push_back(tileLayer);
+        return tileLayer->readCBOR(layerReader);
+    };
+    
+    return CBORReader::readArray(reader, readLayer);
+}
+
+
 void LayerStack::setMap(Map * map) {
     
     this->map = map;
@@ -120,3 +187,34 @@ void LayerStack::setMap(Map * map) {
     }
     textLayer->setMap(map);
 }
+
+
+void LayerStack::writeJSON(JSONWriter & writer) const {
+    
+    writer.beginObject();
+    
+    writer.writeKey("background");
+    getBackgroundLayer()->writeJSON(writer);
+    
+    writer.writeKey("base");
+    writer.beginArray();
+    for (auto const & baseLayer: getBaseLayers()) {
+        baseLayer->writeJSON(writer);
+    }
+    writer.endArray();
+    writer.writeKey("grid");
+    getGridLayer()->writeJSON(writer);
+    writer.writeKey("axis");
+    getAxisLayer()->writeJSON(writer);
+    
+    writer.writeKey("tile");
+    writer.beginArray();
+    for (auto const & tileLayer: getTileLayers()) {
+        tileLayer->writeJSON(writer);
+    }
+    writer.endArray();
+    writer.writeKey("text");
+    getTextLayer()->writeJSON(writer);
+    
+    writer.endObject();
+}
@@ -5,6 +5,7 @@
  */
 
 #include <rpgmapper/layer/text_layer.hpp>
+#include <rpgmapper/trace.hpp>
 
 using namespace rpgmapper::model::layer;
 
@@ -21,6 +22,7 @@ TextLayer::TextLayer(Map * map) : Layer{map} {
 
 
 void TextLayer::draw(UNUSED QPainter & painter, UNUSED int tileSize) const {
+    RPGMAPPER_TRACE_SCOPE("TextLayer::draw");
 
 }
 
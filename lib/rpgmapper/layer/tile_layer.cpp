@@ -5,13 +5,19 @@
  */
 
 #include <rpgmapper/exception/invalid_field.hpp>
+#include <rpgmapper/json/cbor_reader.hpp>
 #include <rpgmapper/layer/tile_layer.hpp>
 #include <rpgmapper/tile/tile.hpp>
 #include <rpgmapper/coordinate_system.hpp>
 #include <rpgmapper/field.hpp>
 #include <rpgmapper/map.hpp>
+#include <rpgmapper/render_statistics.hpp>
+#include <rpgmapper/trace.hpp>
+
+#include "tile_layer_codec.hpp"
 
 using namespace rpgmapper::model;
+using namespace rpgmapper::model::json;
 using namespace rpgmapper::model::layer;
 
 
@@ -33,6 +39,26 @@ void TileLayer::addField(rpgmapper::model::FieldPointer field) {
 }
 
 
+bool TileLayer::applyJSON(QJsonObject const & json) {
+    RPGMAPPER_TRACE_SCOPE("TileLayer::applyJSON");
+    
+    Layer::applyJSON(json);
+    
+    if (json.contains("fields") && json["fields"].isString()) {
+        
+        std::map<int, rpgmapper::model::FieldPointer> decodedFields;
+        QStringList log;
+        auto data = QByteArray::fromBase64(json["fields"].toString().toLatin1());
+        if (!TileLayerCodec::decode(data, decodedFields, getMap(), log)) {
+            return false;
+        }
+        fields = std::move(decodedFields);
+    }
+    
+    return true;
+}
+
+
 rpgmapper::model::FieldPointer const TileLayer::getField(int index) const {
     static QSharedPointer<Field> invalidField{new InvalidField};
     auto iter = fields.find(index);
@@ -49,37 +75,105 @@ rpgmapper::model::FieldPointer const TileLayer::getField(int x, int y) const {
 
 
 void TileLayer::draw(QPainter & painter, int tileSize) const {
+    RPGMAPPER_TRACE_SCOPE("TileLayer::draw");
     
     painter.save();
     
+    // fields outside the clip region are skipped; tiles may be stretched, so keep a tile of slack
+    QRect clipRect;
+    if (painter.hasClipping()) {
+        clipRect = painter.clipBoundingRect().toAlignedRect().adjusted(-tileSize, -tileSize, tileSize, tileSize);
+    }
+    
+    unsigned long fieldsVisited = 0;
+    unsigned long fieldsDrawn = 0;
+    
     auto innerRect = getMap()->getCoordinateSystem()->getInnerRect(tileSize);
     for (auto const & pair : getFields()) {
         
+        ++fieldsVisited;
         auto field = pair.second;
         auto position = field->getPosition();
         QPoint moveBy{innerRect.left() + position.x() * tileSize, innerRect.top() + position.y() * tileSize};
+        if (!clipRect.isNull() && !clipRect.intersects(QRect{moveBy, QSize{tileSize, tileSize}})) {
+            continue;
+        }
+        
+        ++fieldsDrawn;
         painter.translate(moveBy);
         for (auto const & tile : field->getTiles()) {
             tile->draw(painter, tileSize);
         }
-        painter.resetTransform();
+        painter.translate(-moveBy);
     }
     
     painter.restore();
+    
+    RenderStatistics::addFields(fieldsVisited, fieldsDrawn);
 }
 
 
 QJsonObject TileLayer::getJSON() const {
+    RPGMAPPER_TRACE_SCOPE("TileLayer::getJSON");
+    
     QJsonObject jsonObject = Layer::getJSON();
+    if (!fields.empty()) {
+        jsonObject["fields"] = QString::fromLatin1(TileLayerCodec::encode(fields).toBase64());
+    }
     return jsonObject;
 }
 
 
+MemoryReport TileLayer::getMemoryReport() const {
+    MemoryReport report;
+    for (auto const & pair : fields) {
+        report.addField(*pair.second);
+    }
+    return report;
+}
+
+
 bool TileLayer::isFieldPresent(int x, int y) const {
     return getField(Field::getIndex(x, y))->isValid();
 }
 
 
+bool TileLayer::readCBOR(QCborStreamReader & reader) {
+    RPGMAPPER_TRACE_SCOPE("TileLayer::readCBOR");
+    
+    QJsonObject json;
+    QByteArray data;
+    bool fieldsFound = false;
+    auto readValue = [&] (QString const & key, QCborStreamReader & valueReader) -> bool {
+        if (key == "fields") {
+            fieldsFound = true;
+            return CBORReader::readBytes(valueReader, data);
+        }
+        QJsonValue value;
+        if (!CBORReader::readValue(valueReader, value)) {
+            return false;
+        }
+        json[key] = value;
+        return true;
+    };
+    if (!CBORReader::readObject(reader, readValue)) {
+        return false;
+    }
+    
+    Layer::applyJSON(json);
+    if (fieldsFound) {
+        std::map<int, rpgmapper::model::FieldPointer> decodedFields;
+        QStringList log;
+        if (!TileLayerCodec::decode(data, decodedFields, getMap(), log)) {
+            return false;
+        }
+        fields = std::move(decodedFields);
+    }
+    
+    return true;
+}
+
+
 void TileLayer::removeField(int index) {
     
     auto iter = fields.find(index);
@@ -93,3 +187,20 @@ void TileLayer::removeField(int index) {
 void TileLayer::removeField(int x, int y) {
     removeField(Field::getIndex(x, y));
 }
+
+
+void TileLayer::writeJSON(JSONWriter & writer) const {
+    RPGMAPPER_TRACE_SCOPE("TileLayer::writeJSON");
+    
+    writer.beginObject();
+    auto jsonObject = Layer::getJSON();
+    for (auto iter = jsonObject.constBegin(); iter != jsonObject.constEnd(); ++iter) {
+        writer.writeKey(iter.key());
+        writer.writeValue(iter.value());
+    }
+    if (!fields.empty()) {
+        writer.writeKey("fields");
+        writer.writeBytes(TileLayerCodec::encode(fields));
+    }
+    writer.endObject();
+}
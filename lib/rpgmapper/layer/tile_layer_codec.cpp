@@ -0,0 +1,461 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include <QHash>
+#include <QPointF>
+
+#include <rpgmapper/tile/tile.hpp>
+#include <rpgmapper/tile/tile_factory.hpp>
+#include <rpgmapper/field.hpp>
+
+#include "tile_layer_codec.hpp"
+
+using namespace rpgmapper::model;
+using namespace rpgmapper::model::layer;
+using namespace rpgmapper::model::tile;
+
+
+/**
+ * Magic bytes starting an encoded tile layer.
+ */
+static char const MAGIC[] = {'R', 'P', 'T', 'L'};
+
+/**
+ * The format version written.
+ */
+static int const FORMAT_VERSION = 1;
+
+/**
+ * Number of rows of cells in a chunk.
+ */
+static quint64 const CHUNK_ROWS = 16;
+
+
+/**
+ * A tile of the palette.
+ */
+struct PaletteTile {
+    TileType type;                  /**< The type of the tile. */
+    Tile::Attributes attributes;    /**< The attributes of the tile. */
+};
+
+
+/**
+ * Reads an encoded tile layer.
+ */
+struct Reader {
+    char const * current;           /**< The next byte to read. */
+    char const * end;               /**< Past the last byte. */
+    bool ok = true;                 /**< Nothing read past the end so far. */
+};
+
+
+/**
+ * Appends a string to an encoded tile layer: the size in bytes and the UTF-8 bytes.
+ *
+ * @param   data        the encoded tile layer.
+ * @param   string      the string to append.
+ */
+static void appendString(QByteArray & data, QString const & string);
+
+
+/**
+ * Appends an unsigned number as varint (7 bits a byte, least significant first).
+ *
+ * @param   data        the encoded tile layer.
+ * @param   value       the number to append.
+ */
+static void appendVarint(QByteArray & data, quint64 value);
+
+
+/**
+ * Encodes the tiles of a field: the number of tiles and the attributes of each tile.
+ *
+ * @param   field       the field to encode.
+ * @return  the encoded tiles of the field.
+ */
+static QByteArray encodeStack(Field const & field);
+
+
+/**
+ * Checks if two fields hold tiles with the very same attributes.
+ *
+ * @param   lhs         the first field.
+ * @param   rhs         the second field.
+ * @return  true, if the field contents are encoded the same.
+ */
+static bool isSameStack(Field const & lhs, Field const & rhs);
+
+
+/**
+ * Reads a string written by appendString().
+ *
+ * @param   reader      the reader.
+ * @return  the string read.
+ */
+static QString readString(Reader & reader);
+
+
+/**
+ * Reads a varint written by appendVarint().
+ *
+ * @param   reader      the reader.
+ * @return  the number read.
+ */
+static quint64 readVarint(Reader & reader);
+
+
+/**
+ * Returns the number of bytes not yet read.
+ *
+ * @param   reader      the reader.
+ * @return  the number of bytes left.
+ */
+static quint64 remaining(Reader const & reader);
+
+
+/**
+ * Converts a signed number to an unsigned one, small negative numbers staying small.
+ *
+ * @param   value       the signed number.
+ * @return  the zigzag encoded number.
+ */
+static quint64 zigzag(qint64 value);
+
+
+/**
+ * Reverts zigzag().
+ *
+ * @param   value       the zigzag encoded number.
+ * @return  the signed number.
+ */
+static qint64 unzigzag(quint64 value);
+
+
+bool TileLayerCodec::decode(QByteArray const & data,
+        std::map<int, FieldPointer> & fields,
+        rpgmapper::model::Map * map,
+        QStringList & log) {
+
+    if ((data.size() <= static_cast<int>(sizeof(MAGIC))) || !std::equal(MAGIC, MAGIC + sizeof(MAGIC), data.constData())) {
+        log.append("Tile layer data corrupted.");
+        return false;
+    }
+    auto version = static_cast<int>(static_cast<unsigned char>(data[sizeof(MAGIC)]));
+    if (version > FORMAT_VERSION) {
+        log.append(QString{"Tile layer data of unknown version %1."}.arg(version));
+        return false;
+    }
+    Reader reader{data.constData() + sizeof(MAGIC) + 1, data.constData() + data.size()};
+
+    // each palette entry takes at least a byte: a corrupted size must not allocate
+    auto paletteSize = readVarint(reader);
+    if (paletteSize > remaining(reader)) {
+        log.append("Tile layer data corrupted.");
+        return false;
+    }
+    std::vector<std::vector<PaletteTile>> palette(paletteSize);
+    for (auto & stack : palette) {
+
+        auto tileCount = readVarint(reader);
+        for (quint64 i = 0; reader.ok && (i < tileCount); ++i) {
+
+            PaletteTile tile;
+            auto attributeCount = readVarint(reader);
+            for (quint64 j = 0; reader.ok && (j < attributeCount); ++j) {
+                auto key = readString(reader);
+                tile.attributes[key] = readString(reader);
+            }
+
+            auto type = tile.attributes["type"];
+            if (type == "color") {
+                tile.type = TileType::color;
+            }
+            else
+            if (type == "shape") {
+                tile.type = TileType::shape;
+            }
+            else {
+                log.append(QString{"Skipping tile of unknown type '"} + type + "'.");
+                continue;
+            }
+            stack.push_back(std::move(tile));
+        }
+    }
+
+    auto left = unzigzag(readVarint(reader));
+    auto top = unzigzag(readVarint(reader));
+    auto width = readVarint(reader);
+    auto height = readVarint(reader);
+    auto chunks = readVarint(reader);
+    auto maximum = static_cast<quint64>(std::numeric_limits<int>::max());
+    if (!reader.ok || (width > maximum) || (height > maximum) || (chunks > (height + CHUNK_ROWS - 1) / CHUNK_ROWS)) {
+        log.append("Tile layer data corrupted.");
+        return false;
+    }
+
+    for (quint64 chunk = 0; chunk < chunks; ++chunk) {
+
+        auto size = readVarint(reader);
+        if (!reader.ok || (size > remaining(reader))) {
+            log.append("Tile layer data corrupted.");
+            return false;
+        }
+
+        auto chunkEnd = reader.current + size;
+        auto chunkTop = top + static_cast<qint64>(chunk * CHUNK_ROWS);
+        auto cells = std::min(CHUNK_ROWS, height - chunk * CHUNK_ROWS) * width;
+        quint64 cell = 0;
+        while (reader.current < chunkEnd) {
+
+            auto runLength = readVarint(reader);
+            auto value = readVarint(reader);
+            if (!reader.ok || (reader.current > chunkEnd) || (value > palette.size()) || (runLength > cells - cell)) {
+                log.append("Tile layer data corrupted.");
+                return false;
+            }
+            if (value == 0) {
+                cell += runLength;
+                continue;
+            }
+
+            auto const & stack = palette[value - 1];
+            for (auto end = cell + runLength; cell < end; ++cell) {
+
+                auto x = static_cast<int>(left + static_cast<qint64>(cell % width));
+                auto y = static_cast<int>(chunkTop + static_cast<qint64>(cell / width));
+                auto field = FieldPointer{new Field{x, y}};
+                field->getTiles().reserve(stack.size());
+                for (auto const & paletteTile : stack) {
+                    auto tile = TileFactory::create(paletteTile.type, paletteTile.attributes);
+                    tile->setMap(map);
+                    tile->setPosition(QPointF(x, y));
+                    field->getTiles().push_back(tile);
+                }
+
+                // cells come in the order of the field indices
+                fields.emplace_hint(fields.end(), Field::getIndex(x, y), field);
+            }
+        }
+    }
+
+    return true;
+}
+
+
+QByteArray TileLayerCodec::encode(std::map<int, FieldPointer> const & fields) {
+
+    QByteArray data;
+    data.append(MAGIC, sizeof(MAGIC));
+    data.append(static_cast<char>(FORMAT_VERSION));
+
+    // neighbouring fields often hold the same: compare before encoding the field content
+    QHash<QByteArray, quint64> paletteIndices;
+    QByteArray palette;
+    std::vector<quint64> values;
+    values.reserve(fields.size());
+    Field const * previous = nullptr;
+    int left = std::numeric_limits<int>::max();
+    int top = std::numeric_limits<int>::max();
+    int right = std::numeric_limits<int>::min();
+    int bottom = std::numeric_limits<int>::min();
+    for (auto const & pair : fields) {
+
+        auto const & field = *pair.second;
+        if (previous && isSameStack(*previous, field)) {
+            values.push_back(values.back());
+        }
+        else {
+            auto stack = encodeStack(field);
+            auto iter = paletteIndices.find(stack);
+            if (iter == paletteIndices.end()) {
+                iter = paletteIndices.insert(stack, static_cast<quint64>(paletteIndices.size()) + 1);
+                palette.append(stack);
+            }
+            values.push_back(*iter);
+        }
+        previous = &field;
+
+        auto position = field.getPosition();
+        left = std::min(left, position.x());
+        top = std::min(top, position.y());
+        right = std::max(right, position.x());
+        bottom = std::max(bottom, position.y());
+    }
+    appendVarint(data, static_cast<quint64>(paletteIndices.size()));
+    data.append(palette);
+
+    quint64 width = 0;
+    quint64 height = 0;
+    if (fields.empty()) {
+        left = 0;
+        top = 0;
+    }
+    else {
+        width = static_cast<quint64>(static_cast<qint64>(right) - left + 1);
+        height = static_cast<quint64>(static_cast<qint64>(bottom) - top + 1);
+    }
+    appendVarint(data, zigzag(left));
+    appendVarint(data, zigzag(top));
+    appendVarint(data, width);
+    appendVarint(data, height);
+
+    auto chunks = (height + CHUNK_ROWS - 1) / CHUNK_ROWS;
+    appendVarint(data, chunks);
+
+    auto iter = fields.begin();
+    std::size_t i = 0;
+    for (quint64 chunk = 0; chunk < chunks; ++chunk) {
+
+        QByteArray runs;
+        quint64 runValue = 0;
+        quint64 runLength = 0;
+        auto flush = [&] (quint64 value) {
+            if (runLength > 0) {
+                appendVarint(runs, runLength);
+                appendVarint(runs, runValue);
+            }
+            runValue = value;
+            runLength = 0;
+        };
+
+        quint64 cell = 0;
+        auto chunkTop = top + static_cast<qint64>(chunk * CHUNK_ROWS);
+        auto chunkBottom = chunkTop + static_cast<qint64>(CHUNK_ROWS);
+        for (; (iter != fields.end()) && ((*iter).second->getPosition().y() < chunkBottom); ++iter, ++i) {
+
+            auto position = (*iter).second->getPosition();
+            auto offset = static_cast<quint64>(position.y() - chunkTop) * width + static_cast<quint64>(position.x() - left);
+            if (offset > cell) {
+                if (runValue != 0) {
+                    flush(0);
+                }
+                runLength += offset - cell;
+            }
+            if (runValue != values[i]) {
+                flush(values[i]);
+            }
+            ++runLength;
+            cell = offset + 1;
+        }
+
+        // empty cells up to the end of the chunk are implicit
+        if (runValue != 0) {
+            flush(0);
+        }
+        appendVarint(data, static_cast<quint64>(runs.size()));
+        data.append(runs);
+    }
+
+    return data;
+}
+
+
+int TileLayerCodec::getFormatVersion() {
+    return FORMAT_VERSION;
+}
+
+
+void appendString(QByteArray & data, QString const & string) {
+    auto utf8 = string.toUtf8();
+    appendVarint(data, static_cast<quint64>(utf8.size()));
+    data.append(utf8);
+}
+
+
+void appendVarint(QByteArray & data, quint64 value) {
+    while (value >= 0x80) {
+        data.append(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    data.append(static_cast<char>(value));
+}
+
+
+QByteArray encodeStack(Field const & field) {
+
+    QByteArray stack;
+    appendVarint(stack, field.getTiles().size());
+    for (auto const & tile : field.getTiles()) {
+        auto const & attributes = tile->getAttributes();
+        appendVarint(stack, attributes.size());
+        for (auto const & pair : attributes) {
+            appendString(stack, pair.first);
+            appendString(stack, pair.second);
+        }
+    }
+
+    return stack;
+}
+
+
+bool isSameStack(Field const & lhs, Field const & rhs) {
+
+    auto const & lhsTiles = lhs.getTiles();
+    auto const & rhsTiles = rhs.getTiles();
+    if (lhsTiles.size() != rhsTiles.size()) {
+        return false;
+    }
+    for (std::size_t i = 0; i < lhsTiles.size(); ++i) {
+        if (lhsTiles[i]->getAttributes() != rhsTiles[i]->getAttributes()) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+QString readString(Reader & reader) {
+
+    auto size = readVarint(reader);
+    if (!reader.ok || (size > remaining(reader))) {
+        reader.ok = false;
+        return QString{};
+    }
+
+    auto string = QString::fromUtf8(reader.current, static_cast<int>(size));
+    reader.current += size;
+    return string;
+}
+
+
+quint64 readVarint(Reader & reader) {
+
+    quint64 value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (reader.current >= reader.end) {
+            break;
+        }
+        auto byte = static_cast<unsigned char>(*reader.current++);
+        value |= static_cast<quint64>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+    }
+
+    reader.ok = false;
+    return 0;
+}
+
+
+quint64 remaining(Reader const & reader) {
+    return reader.current < reader.end ? static_cast<quint64>(reader.end - reader.current) : 0;
+}
+
+
+quint64 zigzag(qint64 value) {
+    return (static_cast<quint64>(value) << 1) ^ static_cast<quint64>(value >> 63);
+}
+
+
+qint64 unzigzag(quint64 value) {
+    return static_cast<qint64>(value >> 1) ^ -static_cast<qint64>(value & 1);
+}
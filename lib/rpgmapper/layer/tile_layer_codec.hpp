@@ -0,0 +1,79 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#ifndef RPGMAPPER_MODEL_LAYER_TILE_LAYER_CODEC_HPP
+#define RPGMAPPER_MODEL_LAYER_TILE_LAYER_CODEC_HPP
+
+#include <map>
+
+#include <QByteArray>
+#include <QStringList>
+
+#include <rpgmapper/field_pointer.hpp>
+
+
+// fwd
+namespace rpgmapper::model { class Map; }
+
+
+namespace rpgmapper::model::layer {
+
+
+/**
+ * Encodes the fields of a tile layer into a compact binary and back.
+ *
+ * The binary starts with the magic "RPTL" and a format version byte, followed by a
+ * palette of the distinct field contents (the stacks of tile attributes found on the
+ * fields). Then the cells of the bounding box of all fields follow in chunks of rows,
+ * each chunk prefixed by its size in bytes. A chunk is a sequence of runs: the number of
+ * cells and the palette index (1-based, 0 for no field). All numbers are varints.
+ *
+ * The chunks are row-major like the field indices, so decoded fields arrive in order.
+ */
+class TileLayerCodec {
+
+public:
+
+    /**
+     * Constructor.
+     */
+    TileLayerCodec() = delete;
+
+    /**
+     * Decodes the fields of a tile layer.
+     *
+     * @param   data        the binary encoded by encode().
+     * @param   fields      receives the fields decoded.
+     * @param   map         the map the tiles are placed on.
+     * @param   log         protocol of actions.
+     * @return  true, if decoded (false, if corrupted or of an unknown version).
+     */
+    static bool decode(QByteArray const & data,
+            std::map<int, rpgmapper::model::FieldPointer> & fields,
+            rpgmapper::model::Map * map,
+            QStringList & log);
+
+    /**
+     * Encodes the fields of a tile layer.
+     *
+     * @param   fields      the fields of the tile layer.
+     * @return  the binary holding the fields.
+     */
+    static QByteArray encode(std::map<int, rpgmapper::model::FieldPointer> const & fields);
+
+    /**
+     * Returns the format version written by encode().
+     *
+     * @return  the format version written.
+     */
+    static int getFormatVersion();
+};
+
+
+}
+
+
+#endif
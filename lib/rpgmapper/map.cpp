@@ -6,20 +6,46 @@
 
 #include <utility>
 
+#include <QJsonDocument>
+#include <QSignalBlocker>
+
 #include <rpgmapper/exception/invalid_regionname.hpp>
 #include <rpgmapper/exception/invalid_session.hpp>
+#include <rpgmapper/json/cbor_reader.hpp>
+#include <rpgmapper/json/cbor_writer.hpp>
 #include <rpgmapper/tile/tile.hpp>
 #include <rpgmapper/coordinate_system.hpp>
 #include <rpgmapper/map.hpp>
 #include <rpgmapper/map_name_validator.hpp>
 #include <rpgmapper/session.hpp>
 
+#include "digest_device.hpp"
+#include "zip.hpp"
+
 
 using namespace rpgmapper::model;
+using namespace rpgmapper::model::json;
 using namespace rpgmapper::model::layer;
 using namespace rpgmapper::model::tile;
 
 
+/**
+ * Counts the accesses to all maps, which orders the maps by their last access.
+ */
+static quint64 accessClock = 0;
+
+
+/**
+ * Computes the digest of a map serialized as it is written to its entry.
+ *
+ * The serialized map is hashed as it is written, it is not held in memory.
+ *
+ * @param   map         the map.
+ * @return  the digest of the map.
+ */
+static QByteArray computeDigest(Map const & map);
+
+
 Map::Map(QString mapName) : Nameable{std::move(mapName)} {
     coordinateSystem = QSharedPointer<CoordinateSystem>(new CoordinateSystem);
     layerStack.setMap(this);
@@ -52,6 +78,25 @@ QJsonObject Map::getJSON() const {
 }
 
 
+MemoryReport Map::getMemoryReport() const {
+
+    MemoryReport report;
+    if (!loaded) {
+        return report;
+    }
+    
+    for (auto const & layer : getLayers().getBaseLayers()) {
+        report += layer->getMemoryReport();
+    }
+    for (auto const & layer : getLayers().getTileLayers()) {
+        report += layer->getMemoryReport();
+    }
+    report.backgroundPixmaps += getLayers().getBackgroundLayer()->getPixmapBytes();
+
+    return report;
+}
+
+
 bool Map::isTileOnField(int x, int y) const {
     
     bool tileOnFieldPresent = false;
@@ -70,12 +115,168 @@ bool Map::isTileOnField(int x, int y) const {
 }
 
 
+bool Map::isModified() const {
+    
+    if (!loaded) {
+        return false;
+    }
+    if (entry.entryName.isEmpty()) {
+        return true;
+    }
+    
+    return computeDigest(*this) != storedDigest;
+}
+
+
+bool Map::load(QStringList & log) {
+    
+    if (loaded) {
+        return true;
+    }
+    if (!loadError.isEmpty()) {
+        log.append(loadError);
+        return false;
+    }
+    
+    QByteArray data;
+    if (!readMap(data, entry, log)) {
+        loadError = QString{"Unable to load map %1 from %2."}.arg(getName()).arg(entry.fileName);
+        log.append(loadError);
+        return false;
+    }
+    
+    // the map may have been renamed since it has been stored: the name stays as it is
+    auto name = getName();
+    QSignalBlocker blocker{this};
+    
+    // applying the data accesses the layers: they are to be taken as they are
+    loaded = true;
+    bool applied = true;
+    if (entry.entryName.endsWith(".cbor")) {
+        QCborStreamReader reader{data};
+        applied = readCBOR(reader);
+    }
+    else {
+        // atlas files written before CBOR hold the maps as JSON text
+        auto document = QJsonDocument::fromJson(data);
+        applied = document.isObject();
+        if (applied) {
+            applyJSON(document.object());
+        }
+    }
+    setName(name);
+    
+    if (!applied) {
+        layerStack = LayerStack{this};
+        loaded = false;
+        loadError = QString{"Map "} + name + " is corrupted. Unable to load.";
+        log.append(loadError);
+        return false;
+    }
+    
+    storedDigest = computeDigest(*this);
+    touch();
+    log.append(QString{"Loaded map: "} + getName());
+    
+    return true;
+}
+
+
 MapPointer const & Map::null() {
     static MapPointer nullMap{new InvalidMap};
     return nullMap;
 }
 
 
+bool Map::readCBOR(QCborStreamReader & reader) {
+    
+    auto readValue = [&] (QString const & key, QCborStreamReader & valueReader) -> bool {
+        if (key == "name") {
+            QString name;
+            if (!CBORReader::readString(valueReader, name)) {
+                return false;
+            }
+            setName(name);
+            return true;
+        }
+        if (key == "coordinate_system") {
+            return coordinateSystem->readCBOR(valueReader);
+        }
+        if (key == "layers") {
+            return getLayers().readCBOR(valueReader);
+        }
+        QJsonValue unknown;
+        return CBORReader::readValue(valueReader, unknown);
+    };
+    
+    return CBORReader::readObject(reader, readValue);
+}
+
+
+void Map::setEntry(MapEntry entry) {
+    this->entry = std::move(entry);
+    if (loaded) {
+        layerStack = LayerStack{this};
+        loaded = false;
+    }
+    loadError.clear();
+    storedDigest.clear();
+}
+
+
+void Map::setStored(MapEntry entry, QByteArray const & digest) {
+    this->entry = std::move(entry);
+    if (loaded) {
+        storedDigest = digest;
+    }
+}
+
+
+void Map::touch() {
+    lastAccess = ++accessClock;
+}
+
+
 void Map::triggerTilePlaced() {
     emit tilePlaced();
 }
+
+
+bool Map::unload() {
+    
+    if (!loaded) {
+        return true;
+    }
+    if (isModified()) {
+        return false;
+    }
+    
+    // the coordinate system stays: it is small and widgets are connected to it
+    layerStack = LayerStack{this};
+    loaded = false;
+    
+    return true;
+}
+
+
+void Map::writeJSON(JSONWriter & writer) const {
+    
+    ensureLoaded();
+    
+    writer.beginObject();
+    writer.writeKey("name");
+    writer.writeString(getName());
+    writer.writeKey("coordinate_system");
+    coordinateSystem->writeJSON(writer);
+    writer.writeKey("layers");
+    layerStack.writeJSON(writer);
+    writer.endObject();
+}
+
+
+QByteArray computeDigest(Map const & map) {
+    DigestDevice device;
+    CBORWriter writer{&device};
+    map.writeJSON(writer);
+    return device.getDigest();
+}
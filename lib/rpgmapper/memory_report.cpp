@@ -0,0 +1,100 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#include <rpgmapper/tile/tile.hpp>
+#include <rpgmapper/field.hpp>
+#include <rpgmapper/memory_report.hpp>
+
+using namespace rpgmapper::model;
+
+
+/**
+ * Estimated size of the header Qt puts in front of the data of a string or byte array.
+ */
+static long long const QT_ARRAY_HEADER = 24;
+
+
+/**
+ * Formats a number of bytes human readable.
+ *
+ * @param   bytes       the number of bytes.
+ * @return  the bytes as human readable string.
+ */
+static QString formatBytes(long long bytes) {
+    if (bytes >= 1024 * 1024) {
+        return QString{"%1 MiB"}.arg(bytes / (1024.0 * 1024.0), 0, 'f', 1);
+    }
+    if (bytes >= 1024) {
+        return QString{"%1 KiB"}.arg(bytes / 1024.0, 0, 'f', 1);
+    }
+    return QString{"%1 B"}.arg(bytes);
+}
+
+
+MemoryReport & MemoryReport::operator+=(MemoryReport const & rhs) {
+    fields += rhs.fields;
+    tiles += rhs.tiles;
+    attributes += rhs.attributes;
+    shapeCaches += rhs.shapeCaches;
+    backgroundPixmaps += rhs.backgroundPixmaps;
+    resourceBlobs += rhs.resourceBlobs;
+    commandHistory += rhs.commandHistory;
+    return *this;
+}
+
+
+void MemoryReport::addField(Field const & field) {
+    auto const & fieldTiles = field.getTiles();
+    fields += static_cast<long long>(sizeof(Field) + sizeof(int)) + getMapNodeOverhead() + getSharedPointerOverhead();
+    fields += static_cast<long long>(fieldTiles.capacity() * sizeof(tile::TilePointer));
+    addTiles(fieldTiles);
+}
+
+
+void MemoryReport::addTile(tile::Tile const & tile) {
+    tiles += static_cast<long long>(sizeof(tile::Tile)) + getSharedPointerOverhead();
+    for (auto const & pair : tile.getAttributes()) {
+        attributes += getMapNodeOverhead() + getBytes(pair.first) + getBytes(pair.second);
+    }
+}
+
+
+void MemoryReport::addTiles(tile::Tiles const & tileList) {
+    for (auto const & tile : tileList) {
+        if (tile) {
+            addTile(*tile);
+        }
+    }
+}
+
+
+long long MemoryReport::getBytes(QByteArray const & data) {
+    return static_cast<long long>(sizeof(QByteArray)) + (data.isNull() ? 0 : QT_ARRAY_HEADER + data.capacity());
+}
+
+
+long long MemoryReport::getBytes(QString const & string) {
+    auto characters = static_cast<long long>(string.capacity()) * static_cast<long long>(sizeof(QChar));
+    return static_cast<long long>(sizeof(QString)) + (string.isNull() ? 0 : QT_ARRAY_HEADER + characters);
+}
+
+
+long long MemoryReport::getTotal() const {
+    return fields + tiles + attributes + shapeCaches + backgroundPixmaps + resourceBlobs + commandHistory;
+}
+
+
+QStringList MemoryReport::toStringList() const {
+    return QStringList{}
+        << QString{"Fields: %1"}.arg(formatBytes(fields))
+        << QString{"Tiles: %1"}.arg(formatBytes(tiles))
+        << QString{"Tile attributes: %1"}.arg(formatBytes(attributes))
+        << QString{"Shape caches: %1"}.arg(formatBytes(shapeCaches))
+        << QString{"Background pixmaps: %1"}.arg(formatBytes(backgroundPixmaps))
+        << QString{"Resource data: %1"}.arg(formatBytes(resourceBlobs))
+        << QString{"Undo/redo history: %1"}.arg(formatBytes(commandHistory))
+        << QString{"Total: %1"}.arg(formatBytes(getTotal()));
+}
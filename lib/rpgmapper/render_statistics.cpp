@@ -0,0 +1,113 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#include <atomic>
+
+#include <rpgmapper/average.hpp>
+#include <rpgmapper/render_statistics.hpp>
+
+using namespace rpgmapper::model;
+
+
+/**
+ * Number of frames kept for the frame time percentiles.
+ */
+static unsigned int const FRAME_HISTORY = 1000;
+
+/**
+ * Number of frames kept for the per layer averages.
+ */
+static unsigned int const LAYER_HISTORY = 100;
+
+
+static std::atomic<unsigned long> fieldsVisited{0};
+static std::atomic<unsigned long> fieldsDrawn{0};
+static std::atomic<unsigned long> shapeCacheHits{0};
+static std::atomic<unsigned long> shapeCacheMisses{0};
+static std::atomic<long long> pixmapBytes{0};
+
+static AverageOverSize<float> frameTimes{FRAME_HISTORY};
+static std::map<QString, AverageOverSize<float>> layerTimes;
+
+
+double RenderStatistics::Report::getShapeCacheHitRate() const {
+    auto lookups = shapeCacheHits + shapeCacheMisses;
+    return lookups > 0 ? static_cast<double>(shapeCacheHits) / lookups : 0.0;
+}
+
+
+void RenderStatistics::addFields(unsigned long visited, unsigned long drawn) {
+    fieldsVisited += visited;
+    fieldsDrawn += drawn;
+}
+
+
+void RenderStatistics::addLayerTime(QString const & layer, float milliseconds) {
+    auto iter = layerTimes.find(layer);
+    if (iter == layerTimes.end()) {
+        iter = layerTimes.emplace(layer, AverageOverSize<float>{LAYER_HISTORY}).first;
+    }
+    (*iter).second << milliseconds;
+}
+
+
+void RenderStatistics::addPixmapBytes(long long bytes) {
+    pixmapBytes += bytes;
+}
+
+
+void RenderStatistics::addShapeCacheHit() {
+    ++shapeCacheHits;
+}
+
+
+void RenderStatistics::addShapeCacheMiss() {
+    ++shapeCacheMisses;
+}
+
+
+void RenderStatistics::beginFrame() {
+    fieldsVisited = 0;
+    fieldsDrawn = 0;
+}
+
+
+void RenderStatistics::endFrame(float milliseconds) {
+    frameTimes << milliseconds;
+}
+
+
+RenderStatistics::Report RenderStatistics::getReport() {
+
+    Report report;
+
+    for (auto const & pair : layerTimes) {
+        report.layerMilliseconds[pair.first] = pair.second.average();
+    }
+
+    report.fieldsVisited = fieldsVisited;
+    report.fieldsDrawn = fieldsDrawn;
+    report.shapeCacheHits = shapeCacheHits;
+    report.shapeCacheMisses = shapeCacheMisses;
+    report.pixmapBytes = pixmapBytes;
+
+    report.frames = frameTimes.size();
+    report.frameMillisecondsP50 = frameTimes.percentile(0.50);
+    report.frameMillisecondsP95 = frameTimes.percentile(0.95);
+    report.frameMillisecondsP99 = frameTimes.percentile(0.99);
+
+    return report;
+}
+
+
+void RenderStatistics::reset() {
+    fieldsVisited = 0;
+    fieldsDrawn = 0;
+    shapeCacheHits = 0;
+    shapeCacheMisses = 0;
+    frameTimes = AverageOverSize<float>{FRAME_HISTORY};
+    layerTimes.clear();
+}
@@ -4,6 +4,8 @@
  * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
  */
 
+#include <utility>
+
 #include <QFileInfo>
 #include <QMimeDatabase>
 #include <QMimeType>
@@ -13,28 +15,53 @@
 using namespace rpgmapper::model::resource;
 
 
+/**
+ * Derives the name of a background from its path.
+ *
+ * @param   path        the resource path of the background.
+ * @return  the file name of the path without suffix.
+ */
+static QString getNameFromPath(QString const & path) {
+    auto fileName = QFileInfo{path}.fileName();
+    return fileName.left(fileName.indexOf('.'));
+}
+
+
 Background::Background(QString path, QByteArray const & data) : Resource{path, data} {
-    
-    QFileInfo fileInfo{path};
-    auto fileName = fileInfo.fileName();
-    setName(fileName.left(fileName.indexOf('.')));
-    setData(data);
+    setName(getNameFromPath(path));
+}
+
+
+Background::Background(QString path, Source source) : Resource{path, std::move(source)} {
+    setName(getNameFromPath(path));
+}
+
+
+QImage Background::getImage() const {
+    std::lock_guard<std::mutex> lock{imageMutex};
+    if (!decoded) {
+        withData([&] (QByteArray const & data) { image = QImage::fromData(data); });
+        decoded = true;
+    }
+    return image;
 }
 
 
 bool Background::isBackground(QByteArray const & data) {
-    
     static QMimeDatabase mimeDatabase;
-    auto mimeType = mimeDatabase.mimeTypeForData(data);
-    
+    return isBackground(mimeDatabase.mimeTypeForData(data));
+}
+
+
+bool Background::isBackground(QMimeType const & mimeType) {
     auto mimeTypeString = mimeType.name();
     return mimeTypeString.left(mimeTypeString.indexOf('/', 0)) == "image";
 }
 
 
 void Background::setData(QByteArray const & data) {
-    
     Resource::setData(data);
-    image = QImage::fromData(data);
-    valid = !image.isNull();
+    std::lock_guard<std::mutex> lock{imageMutex};
+    image = QImage{};
+    decoded = false;
 }
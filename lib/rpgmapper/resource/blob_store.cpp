@@ -0,0 +1,200 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#include <algorithm>
+#include <mutex>
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QSaveFile>
+
+#include <rpgmapper/resource/blob_store.hpp>
+#include <rpgmapper/resource/resource.hpp>
+
+using namespace rpgmapper::model::resource;
+
+
+/**
+ * Never prune a pool smaller than this.
+ */
+static int const MINIMUM_PRUNE_SIZE = 64;
+
+
+/**
+ * The state of the blob store.
+ */
+struct BlobStoreState {
+    std::mutex mutex;                       /**< Guards the state. */
+    QString folder;                         /**< The external blob folder (empty if none). */
+    QHash<QString, QByteArray> pool;        /**< The interned BLOBs by hash. */
+    int pruneSize = MINIMUM_PRUNE_SIZE;     /**< Prune the pool once it grows beyond this. */
+};
+
+
+/**
+ * Returns the file name of a BLOB in the external folder.
+ *
+ * @param   folder      the external blob folder.
+ * @param   hash        the SHA-256 of the BLOB.
+ * @return  the file name of the BLOB.
+ */
+static QString getFileName(QString const & folder, QString const & hash);
+
+
+/**
+ * Returns the global blob store state.
+ *
+ * @return  the blob store state.
+ */
+static BlobStoreState & getState();
+
+
+/**
+ * Checks if a file holds the BLOB with the given hash.
+ *
+ * @param   fileName    the file of the BLOB.
+ * @param   hash        the SHA-256 of the BLOB.
+ * @return  true, if the SHA-256 of the file content matches.
+ */
+static bool isPresent(QString const & fileName, QString const & hash);
+
+
+/**
+ * Drops all BLOBs from the pool no resource refers to any more.
+ *
+ * The mutex of the state must be locked by the caller.
+ *
+ * @param   state       the blob store state.
+ */
+static void prune(BlobStoreState & state);
+
+
+QString BlobStore::getFolder() {
+    auto & state = getState();
+    std::lock_guard<std::mutex> lock{state.mutex};
+    return state.folder;
+}
+
+
+int BlobStore::getInternedCount() {
+    auto & state = getState();
+    std::lock_guard<std::mutex> lock{state.mutex};
+    prune(state);
+    return state.pool.size();
+}
+
+
+QByteArray BlobStore::intern(QByteArray const & data, QString const & hash) {
+
+    if (data.isEmpty() || hash.isEmpty()) {
+        return data;
+    }
+
+    auto & state = getState();
+    std::lock_guard<std::mutex> lock{state.mutex};
+
+    auto iter = state.pool.constFind(hash);
+    if ((iter != state.pool.constEnd()) && ((*iter).size() == data.size())) {
+        return *iter;
+    }
+
+    state.pool.insert(hash, data);
+    if (state.pool.size() > state.pruneSize) {
+        prune(state);
+        state.pruneSize = std::max(MINIMUM_PRUNE_SIZE, state.pool.size() * 2);
+    }
+
+    return data;
+}
+
+
+QByteArray BlobStore::read(QString const & hash) {
+
+    auto folder = getFolder();
+    if (folder.isEmpty() || hash.isEmpty()) {
+        return QByteArray{};
+    }
+
+    QFile file{getFileName(folder, hash)};
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray{};
+    }
+
+    auto data = file.readAll();
+    if (Resource::getSHA256(data) != hash) {
+        return QByteArray{};
+    }
+
+    return intern(data, hash);
+}
+
+
+void BlobStore::setFolder(QString folder) {
+    auto & state = getState();
+    std::lock_guard<std::mutex> lock{state.mutex};
+    state.folder = std::move(folder);
+}
+
+
+bool BlobStore::write(QString const & hash, QByteArray const & data) {
+
+    auto folder = getFolder();
+    if (folder.isEmpty() || hash.isEmpty()) {
+        return false;
+    }
+
+    // content addressed: keep a present file, if it holds these very bytes (and not a torn or foreign write)
+    auto fileName = getFileName(folder, hash);
+    if ((QFileInfo{fileName}.size() == data.size()) && isPresent(fileName, hash)) {
+        return true;
+    }
+
+    QDir{}.mkpath(QFileInfo{fileName}.absolutePath());
+    QSaveFile file{fileName};
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(data);
+    return file.commit();
+}
+
+
+QString getFileName(QString const & folder, QString const & hash) {
+    return QString{"%1/%2/%3"}.arg(folder).arg(hash.left(2)).arg(hash);
+}
+
+
+BlobStoreState & getState() {
+    static BlobStoreState state;
+    return state;
+}
+
+
+bool isPresent(QString const & fileName, QString const & hash) {
+
+    QFile file{fileName};
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QCryptographicHash sha256{QCryptographicHash::Sha256};
+    return sha256.addData(&file) && (QString{sha256.result().toHex()} == hash);
+}
+
+
+void prune(BlobStoreState & state) {
+    for (auto iter = state.pool.begin(); iter != state.pool.end(); ) {
+        if ((*iter).isDetached()) {
+            iter = state.pool.erase(iter);
+        }
+        else {
+            ++iter;
+        }
+    }
+}
@@ -16,19 +16,19 @@ using namespace rpgmapper::model::resource;
 
 
 ColorPalette::ColorPalette(QString path, QByteArray const & data) : Resource{std::move(path), data} {
-    fromJSON();
+    fromJSON(QJsonDocument::fromJson(getData()).object());
 }
 
 
-void ColorPalette::fromJSON() {
+ColorPalette::ColorPalette(QString path, QByteArray const & data, QJsonObject const & json)
+        : Resource{std::move(path), data} {
+    fromJSON(json);
+}
+
+
+void ColorPalette::fromJSON(QJsonObject const & json) {
     
     valid = false;
-    auto jsonDocument = QJsonDocument::fromJson(getData());
-    if (!jsonDocument.isObject()) {
-        return;
-    }
-    
-    auto json = jsonDocument.object();
     if (json.contains("name") && json["name"].isString()) {
         setName(json["name"].toString());
     }
@@ -53,7 +53,11 @@ bool ColorPalette::isColorPalette(QByteArray const & data) {
         return false;
     }
     
-    auto json = jsonDocument.object();
+    return isColorPalette(jsonDocument.object());
+}
+
+
+bool ColorPalette::isColorPalette(QJsonObject const & json) {
     bool namePresent = json.contains("name") && json["name"].isString();
     bool colorsPresent = json.contains("colors") && json["colors"].isArray();
     
@@ -63,7 +67,7 @@ bool ColorPalette::isColorPalette(QByteArray const & data) {
 
 void ColorPalette::setData(QByteArray const & data) {
     Resource::setData(data);
-    fromJSON();
+    fromJSON(QJsonDocument::fromJson(getData()).object());
 }
 
 
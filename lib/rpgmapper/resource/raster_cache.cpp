@@ -0,0 +1,273 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#include <cstring>
+#include <mutex>
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include <rpgmapper/resource/raster_cache.hpp>
+
+using namespace rpgmapper::model::resource;
+
+
+/**
+ * The header in front of the pixels of each cached image.
+ */
+struct RasterHeader {
+    char magic[4];              /**< Always "RPGR". */
+    quint32 version;            /**< Version of the layout. */
+    qint32 width;               /**< Width of the image. */
+    qint32 height;              /**< Height of the image. */
+    qint32 bytesPerLine;        /**< Bytes of a single line of pixels. */
+    qint32 format;              /**< The QImage::Format of the pixels. */
+};
+
+
+/**
+ * Magic bytes of a cached image.
+ */
+static char const RASTER_MAGIC[4] = {'R', 'P', 'G', 'R'};
+
+/**
+ * Version of the cached image layout.
+ */
+static quint32 const RASTER_VERSION = 1;
+
+/**
+ * Suffix of the cached image files.
+ */
+static QString const RASTER_SUFFIX = ".rgba";
+
+
+/**
+ * The state of the raster cache.
+ */
+struct RasterCacheState {
+    std::mutex mutex;                           /**< Guards the state. */
+    QString folder;                             /**< The cache folder (empty if disabled). */
+    qint64 maximumSize = 64ll * 1024 * 1024;    /**< Maximum size of all images. */
+    qint64 size = -1;                           /**< Current size of all images (-1 if not yet known). */
+};
+
+
+/**
+ * Evicts the least recently used images until the cache is well below its maximum size.
+ *
+ * The mutex of the state must be locked by the caller.
+ *
+ * @param   state       the raster cache state.
+ */
+static void evict(RasterCacheState & state);
+
+
+/**
+ * Returns the file name of a cached image.
+ *
+ * @param   folder          the cache folder.
+ * @param   hash            the SHA-256 of the SVG.
+ * @param   tileSize        the tile size of the image.
+ * @param   rotation        rotation in degree.
+ * @param   stretch         stretch scaling.
+ * @return  the file name of the cached image.
+ */
+static QString getFileName(QString const & folder,
+        QString const & hash,
+        unsigned int tileSize,
+        double rotation,
+        double stretch);
+
+
+/**
+ * Returns the global raster cache state.
+ *
+ * @return  the raster cache state.
+ */
+static RasterCacheState & getState();
+
+
+/**
+ * Sums the size of all cached images, if not yet known.
+ *
+ * The mutex of the state must be locked by the caller.
+ *
+ * @param   state       the raster cache state.
+ */
+static void measure(RasterCacheState & state);
+
+
+QString RasterCache::getFolder() {
+    auto & state = getState();
+    std::lock_guard<std::mutex> lock{state.mutex};
+    return state.folder;
+}
+
+
+qint64 RasterCache::getMaximumSize() {
+    auto & state = getState();
+    std::lock_guard<std::mutex> lock{state.mutex};
+    return state.maximumSize;
+}
+
+
+QImage RasterCache::load(QString const & hash, unsigned int tileSize, double rotation, double stretch) {
+
+    auto folder = getFolder();
+    if (folder.isEmpty()) {
+        return QImage{};
+    }
+
+    QFile file{getFileName(folder, hash, tileSize, rotation, stretch)};
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QImage{};
+    }
+    auto size = file.size();
+    if (size < static_cast<qint64>(sizeof(RasterHeader))) {
+        return QImage{};
+    }
+    auto memory = file.map(0, size);
+    if (!memory) {
+        return QImage{};
+    }
+
+    RasterHeader header;
+    std::memcpy(&header, memory, sizeof(header));
+    bool valid = (std::memcmp(header.magic, RASTER_MAGIC, sizeof(RASTER_MAGIC)) == 0)
+            && (header.version == RASTER_VERSION)
+            && (header.format == QImage::Format_ARGB32_Premultiplied)
+            && (header.width > 0) && (header.height > 0)
+            && (header.bytesPerLine >= header.width * 4)
+            && (static_cast<qint64>(sizeof(header)) + static_cast<qint64>(header.bytesPerLine) * header.height == size);
+    if (!valid) {
+        return QImage{};
+    }
+
+    // copy out of the mapping: shapes keep their images and each mapping would hold a file open
+    QImage image = QImage{memory + sizeof(header),
+                          header.width,
+                          header.height,
+                          header.bytesPerLine,
+                          QImage::Format_ARGB32_Premultiplied}.copy();
+
+    // a hit makes this the most recently used image
+    file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+
+    return image;
+}
+
+
+void RasterCache::setFolder(QString folder) {
+    auto & state = getState();
+    std::lock_guard<std::mutex> lock{state.mutex};
+    if (!folder.isEmpty()) {
+        QDir{}.mkpath(folder);
+    }
+    state.folder = std::move(folder);
+    state.size = -1;
+}
+
+
+void RasterCache::setMaximumSize(qint64 maximumSize) {
+    auto & state = getState();
+    std::lock_guard<std::mutex> lock{state.mutex};
+    state.maximumSize = maximumSize;
+}
+
+
+void RasterCache::store(QString const & hash, unsigned int tileSize, double rotation, double stretch, QImage image) {
+
+    auto & state = getState();
+    std::lock_guard<std::mutex> lock{state.mutex};
+    if (state.folder.isEmpty() || image.isNull()) {
+        return;
+    }
+
+    image = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    RasterHeader header;
+    std::memcpy(header.magic, RASTER_MAGIC, sizeof(RASTER_MAGIC));
+    header.version = RASTER_VERSION;
+    header.width = image.width();
+    header.height = image.height();
+    header.bytesPerLine = image.bytesPerLine();
+    header.format = QImage::Format_ARGB32_Premultiplied;
+
+    auto pixelBytes = static_cast<qint64>(image.bytesPerLine()) * image.height();
+    QSaveFile file{getFileName(state.folder, hash, tileSize, rotation, stretch)};
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+    file.write(reinterpret_cast<char const *>(&header), sizeof(header));
+    file.write(reinterpret_cast<char const *>(image.constBits()), pixelBytes);
+    if (!file.commit()) {
+        return;
+    }
+
+    measure(state);
+    state.size += static_cast<qint64>(sizeof(header)) + pixelBytes;
+    if (state.size > state.maximumSize) {
+        evict(state);
+    }
+}
+
+
+void evict(RasterCacheState & state) {
+
+    // oldest first
+    auto files = QDir{state.folder}.entryInfoList({"*" + RASTER_SUFFIX}, QDir::Files, QDir::Time | QDir::Reversed);
+
+    auto targetSize = state.maximumSize / 4 * 3;
+    state.size = 0;
+    for (auto const & fileInfo : files) {
+        state.size += fileInfo.size();
+    }
+    for (auto const & fileInfo : files) {
+        if (state.size <= targetSize) {
+            break;
+        }
+        if (QFile::remove(fileInfo.absoluteFilePath())) {
+            state.size -= fileInfo.size();
+        }
+    }
+}
+
+
+QString getFileName(QString const & folder,
+        QString const & hash,
+        unsigned int tileSize,
+        double rotation,
+        double stretch) {
+
+    return QString{"%1/%2-%3-%4-%5%6"}
+            .arg(folder)
+            .arg(hash)
+            .arg(tileSize)
+            .arg(rotation, 0, 'g', 10)
+            .arg(stretch, 0, 'g', 10)
+            .arg(RASTER_SUFFIX);
+}
+
+
+RasterCacheState & getState() {
+    static RasterCacheState state;
+    return state;
+}
+
+
+void measure(RasterCacheState & state) {
+
+    if (state.size >= 0) {
+        return;
+    }
+
+    state.size = 0;
+    for (auto const & fileInfo : QDir{state.folder}.entryInfoList({"*" + RASTER_SUFFIX}, QDir::Files)) {
+        state.size += fileInfo.size();
+    }
+}
@@ -4,15 +4,64 @@
  * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
  */
 
+#include <limits>
+
 #include <QCryptographicHash>
+#include <QFile>
 #include <QMimeDatabase>
 
+#include <rpgmapper/resource/blob_store.hpp>
 #include <rpgmapper/resource/resource.hpp>
 
 using namespace rpgmapper::model::resource;
 
 
-Resource::Resource(QString path, QByteArray const & data) : data{data}, path{std::move(path)} {
+Resource::Resource(QString path, QByteArray const & data) : data{data}, loaded{true}, path{std::move(path)} {
+}
+
+
+Resource::Resource(QString path, Source source)
+        : loaded{false}, path{std::move(path)}, source{std::move(source)} {
+}
+
+
+Resource::~Resource() {
+    // drop the raw reference before the mapping goes away: no copy refers to the mapping
+    std::lock_guard<std::mutex> lock{dataMutex};
+    data.clear();
+    mappedFile.reset();
+}
+
+
+QByteArray Resource::getData() const {
+    
+    if (!loaded.load(std::memory_order_acquire)) {
+        loadData();
+    }
+    
+    std::lock_guard<std::mutex> lock{dataMutex};
+    if (mappedFile) {
+        return QByteArray{data.constData(), data.size()};
+    }
+    return data;
+}
+
+
+QString Resource::getHash() const {
+    
+    {
+        std::lock_guard<std::mutex> lock{hashMutex};
+        if (!hash.isEmpty()) {
+            return hash;
+        }
+    }
+    
+    QString calculatedHash;
+    withData([&] (QByteArray const & bytes) { calculatedHash = getSHA256(bytes); });
+    
+    std::lock_guard<std::mutex> lock{hashMutex};
+    hash = calculatedHash;
+    return hash;
 }
 
 
@@ -22,8 +71,27 @@ QString Resource::getSHA256(QByteArray const & data) {
 
 
 QMimeType Resource::getMimeType() const {
+    
+    {
+        std::lock_guard<std::mutex> lock{mimeTypeMutex};
+        if (mimeType.isValid()) {
+            return mimeType;
+        }
+    }
+    
     static QMimeDatabase mimeDatabase;
-    return mimeDatabase.mimeTypeForData(getData());
+    QMimeType detectedMimeType;
+    if (!isLoaded()) {
+        // sniffs the file name and the first bytes only
+        detectedMimeType = mimeDatabase.mimeTypeForFile(source.fileName);
+    }
+    else {
+        withData([&] (QByteArray const & bytes) { detectedMimeType = mimeDatabase.mimeTypeForData(bytes); });
+    }
+    
+    std::lock_guard<std::mutex> lock{mimeTypeMutex};
+    mimeType = detectedMimeType;
+    return mimeType;
 }
 
 
@@ -33,13 +101,93 @@ QString Resource::getPrefix() const {
 }
 
 
+qint64 Resource::getSize() const {
+    return isLoaded() ? data.size() : source.size;
+}
+
+
 ResourceType Resource::getType() const {
     return suggestResourceTypeByPath(getPath());
 }
 
 
+bool Resource::isMapped() const {
+    std::lock_guard<std::mutex> lock{dataMutex};
+    return mappedFile != nullptr;
+}
+
+
+void Resource::keepMapping(std::shared_ptr<QFile> mapping) {
+    std::lock_guard<std::mutex> lock{dataMutex};
+    mappedFile = std::move(mapping);
+}
+
+
+void Resource::loadData() const {
+    
+    std::lock_guard<std::mutex> lock{dataMutex};
+    if (loaded.load(std::memory_order_relaxed)) {
+        return;
+    }
+    
+    auto file = std::make_shared<QFile>(source.fileName);
+    if (file->open(QIODevice::ReadOnly)) {
+        
+        auto size = file->size();
+        uchar * memory = nullptr;
+        if (source.mapped && (size > 0) && (size <= std::numeric_limits<int>::max())) {
+            memory = file->map(0, size);
+        }
+        
+        if (memory) {
+            data = QByteArray::fromRawData(reinterpret_cast<char const *>(memory), static_cast<int>(size));
+            mappedFile = std::move(file);
+        }
+        else {
+            // not asked for or mapping failed: fall back to reading
+            data = file->readAll();
+            std::lock_guard<std::mutex> hashLock{hashMutex};
+            hash = getSHA256(data);
+            data = BlobStore::intern(data, hash);
+        }
+    }
+    loaded.store(true, std::memory_order_release);
+}
+
+
 void Resource::setData(QByteArray const &data) {
-    this->data = data;
+    {
+        // copies handed out do not refer to the mapping: it may go away right now
+        std::lock_guard<std::mutex> lock{dataMutex};
+        this->data = data;
+        mappedFile.reset();
+        loaded.store(true, std::memory_order_release);
+    }
+    setMimeType(QMimeType{});
+    
+    std::lock_guard<std::mutex> lock{hashMutex};
+    hash.clear();
+}
+
+
+void Resource::shareData() const {
+    
+    if (!isLoaded() || isMapped()) {
+        return;
+    }
+    
+    auto sharedData = BlobStore::intern(getData(), getHash());
+    
+    std::lock_guard<std::mutex> lock{dataMutex};
+    if (!mappedFile && (sharedData == data)) {
+        data = sharedData;
+    }
+}
+
+
+void Resource::setMimeType(QMimeType mimeType) {
+    std::lock_guard<std::mutex> lock{mimeTypeMutex};
+    this->mimeType = std::move(mimeType);
 }
 
 
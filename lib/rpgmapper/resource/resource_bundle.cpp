@@ -0,0 +1,341 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include <QCborMap>
+#include <QCborValue>
+#include <QDataStream>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QMimeDatabase>
+#include <QSaveFile>
+#include <QSvgRenderer>
+
+#include <rpgmapper/resource/background.hpp>
+#include <rpgmapper/resource/colorpalette.hpp>
+#include <rpgmapper/resource/resource.hpp>
+#include <rpgmapper/resource/resource_bundle.hpp>
+#include <rpgmapper/resource/shape.hpp>
+#include <rpgmapper/resource/shape_catalog.hpp>
+
+using namespace rpgmapper::model::resource;
+
+
+/**
+ * First bytes of every bundle file.
+ */
+static char const BUNDLE_MAGIC[8] = {'R', 'P', 'G', 'M', 'B', 'N', 'D', 'L'};
+
+/**
+ * Version of the bundle layout.
+ */
+static quint32 const BUNDLE_VERSION = 1;
+
+
+/**
+ * What an entry in the bundle holds.
+ */
+enum class BundleEntryKind : quint8 {
+    resource = 0,           /**< A resource of unknown type. */
+    background,             /**< A background image. */
+    colorPalette,           /**< A color palette (with parsed JSON). */
+    shape,                  /**< A validated SVG shape. */
+    shapeCatalog            /**< A shape catalog (with parsed JSON). */
+};
+
+
+/**
+ * A single entry to be written to a bundle.
+ */
+struct BundleEntry {
+    QString path;                                       /**< The resource path. */
+    BundleEntryKind kind = BundleEntryKind::resource;   /**< What the entry holds. */
+    QString mimeType;                                   /**< The mime type detected. */
+    QByteArray data;                                    /**< The resource data. */
+    QByteArray json;                                    /**< The parsed JSON as CBOR (catalogs and palettes). */
+};
+
+
+/**
+ * Determines what a classified file holds.
+ *
+ * @param   classification      the classified file.
+ * @param   kind                receives the kind of the entry.
+ * @return  true, if the file is what its path claims.
+ */
+static bool getEntryKind(ResourceLoader::Classification const & classification, BundleEntryKind & kind);
+
+
+/**
+ * Reads the mapped bundle data.
+ *
+ * @param   bundle          the mapped bundle.
+ * @param   mapping         the file owning the mapping.
+ * @param   loadedFiles     receives one loaded file per entry.
+ * @param   log             the log of actions.
+ * @return  true, if the bundle is valid.
+ */
+static bool readEntries(QByteArray const & bundle,
+        std::shared_ptr<QFile> const & mapping,
+        ResourceLoader::LoadedFiles & loadedFiles,
+        QStringList & log);
+
+
+bool ResourceBundle::read(QString const & fileName, ResourceLoader::LoadedFiles & loadedFiles, QStringList & log) {
+
+    auto file = std::make_shared<QFile>(fileName);
+    if (!file->open(QIODevice::ReadOnly)) {
+        log.append(QString{"Failed to open resource bundle %1."}.arg(fileName));
+        return false;
+    }
+
+    auto size = file->size();
+    uchar * memory = nullptr;
+    if ((size > 0) && (size <= std::numeric_limits<int>::max())) {
+        memory = file->map(0, size);
+    }
+    if (!memory) {
+        log.append(QString{"Failed to map resource bundle %1."}.arg(fileName));
+        return false;
+    }
+
+    auto bundle = QByteArray::fromRawData(reinterpret_cast<char const *>(memory), static_cast<int>(size));
+    ResourceLoader::LoadedFiles entries;
+    if (!readEntries(bundle, file, entries, log)) {
+        log.append(QString{"Resource bundle %1 is corrupt."}.arg(fileName));
+        return false;
+    }
+
+    log.append(QString{"Read %1 resources from bundle %2."}.arg(entries.size()).arg(fileName));
+    std::move(entries.begin(), entries.end(), std::back_inserter(loadedFiles));
+    return true;
+}
+
+
+bool ResourceBundle::write(QString const & fileName, QString const & folder, QStringList & log) {
+
+    auto root = QDir{folder}.absolutePath();
+    QStringList fileNames;
+    QDirIterator iter{root, QDir::Files, QDirIterator::Subdirectories};
+    while (iter.hasNext()) {
+        fileNames.append(iter.next());
+    }
+
+    // same folder, same bundle
+    fileNames.sort();
+
+    std::vector<BundleEntry> entries;
+    for (auto const & filePath : fileNames) {
+
+        QFile file{filePath};
+        if (!file.open(QIODevice::ReadOnly)) {
+            log.append(QString{"Failed to open %1."}.arg(filePath));
+            continue;
+        }
+        auto classification = ResourceLoader::classify(filePath.mid(root.size()), file.readAll());
+        if (classification.data.isEmpty()) {
+            log.append(QString{"Left out empty file %1."}.arg(filePath));
+            continue;
+        }
+
+        BundleEntry entry;
+        if (!getEntryKind(classification, entry.kind)) {
+            log.append(QString{"Left out %1: not the resource its path claims."}.arg(filePath));
+            continue;
+        }
+        entry.path = classification.path;
+        entry.mimeType = classification.mimeType.name();
+        entry.data = classification.data;
+        if ((entry.kind == BundleEntryKind::colorPalette) || (entry.kind == BundleEntryKind::shapeCatalog)) {
+            entry.json = QCborValue::fromJsonValue(classification.json).toCbor();
+        }
+        entries.push_back(entry);
+    }
+
+    QByteArray index;
+    {
+        QDataStream stream{&index, QIODevice::WriteOnly};
+        stream.setVersion(QDataStream::Qt_5_9);
+        stream << static_cast<quint32>(entries.size());
+        qint64 offset = 0;
+        for (auto const & entry : entries) {
+            stream << entry.path << static_cast<quint8>(entry.kind) << entry.mimeType;
+            stream << offset << static_cast<qint64>(entry.data.size());
+            offset += entry.data.size();
+            stream << offset << static_cast<qint64>(entry.json.size());
+            offset += entry.json.size();
+        }
+    }
+
+    QSaveFile file{fileName};
+    if (!file.open(QIODevice::WriteOnly)) {
+        log.append(QString{"Failed to create resource bundle %1."}.arg(fileName));
+        return false;
+    }
+    QDataStream stream{&file};
+    stream.setVersion(QDataStream::Qt_5_9);
+    stream.writeRawData(BUNDLE_MAGIC, sizeof(BUNDLE_MAGIC));
+    stream << BUNDLE_VERSION << static_cast<qint64>(index.size());
+    stream.writeRawData(index.constData(), index.size());
+    for (auto const & entry : entries) {
+        stream.writeRawData(entry.data.constData(), entry.data.size());
+        stream.writeRawData(entry.json.constData(), entry.json.size());
+    }
+
+    if ((stream.status() != QDataStream::Ok) || !file.commit()) {
+        log.append(QString{"Failed to write resource bundle %1."}.arg(fileName));
+        return false;
+    }
+
+    log.append(QString{"Packed %1 resources into %2."}.arg(entries.size()).arg(fileName));
+    return true;
+}
+
+
+bool getEntryKind(ResourceLoader::Classification const & classification, BundleEntryKind & kind) {
+
+    switch (classification.type) {
+
+        case ResourceType::unknown:
+            kind = BundleEntryKind::resource;
+            return true;
+
+        case ResourceType::background:
+            kind = BundleEntryKind::background;
+            return Background::isBackground(classification.mimeType);
+
+        case ResourceType::colorpalette:
+            kind = BundleEntryKind::colorPalette;
+            return ColorPalette::isColorPalette(classification.json);
+
+        case ResourceType::shape:
+            if (ShapeCatalog::isShapeCatalog(classification.json)) {
+                kind = BundleEntryKind::shapeCatalog;
+                return true;
+            }
+            kind = BundleEntryKind::shape;
+            return Shape::isShape(classification.mimeType) && QSvgRenderer{classification.data}.isValid();
+    }
+
+    return false;
+}
+
+
+bool readEntries(QByteArray const & bundle,
+        std::shared_ptr<QFile> const & mapping,
+        ResourceLoader::LoadedFiles & loadedFiles,
+        QStringList & log) {
+
+    static QMimeDatabase mimeDatabase;
+
+    QDataStream stream{bundle};
+    stream.setVersion(QDataStream::Qt_5_9);
+
+    char magic[sizeof(BUNDLE_MAGIC)];
+    if ((stream.readRawData(magic, sizeof(magic)) != sizeof(magic))
+            || (std::memcmp(magic, BUNDLE_MAGIC, sizeof(magic)) != 0)) {
+        return false;
+    }
+
+    quint32 version = 0;
+    qint64 indexSize = 0;
+    stream >> version >> indexSize;
+    if (version != BUNDLE_VERSION) {
+        log.append(QString{"Unsupported resource bundle version %1."}.arg(version));
+        return false;
+    }
+
+    auto header = static_cast<qint64>(sizeof(BUNDLE_MAGIC) + sizeof(version) + sizeof(indexSize));
+    if ((indexSize < 0) || (indexSize > bundle.size() - header)) {
+        return false;
+    }
+    qint64 blobs = header + indexSize;
+    qint64 blobsSize = bundle.size() - blobs;
+
+    quint32 count = 0;
+    stream >> count;
+    for (quint32 i = 0; (i < count) && (stream.status() == QDataStream::Ok); ++i) {
+
+        QString path;
+        quint8 kind = 0;
+        QString mimeTypeName;
+        qint64 offset = 0;
+        qint64 size = 0;
+        qint64 jsonOffset = 0;
+        qint64 jsonSize = 0;
+        stream >> path >> kind >> mimeTypeName >> offset >> size >> jsonOffset >> jsonSize;
+
+        // never add untrusted values before the check, they may overflow
+        auto outOfBounds = [&] (qint64 o, qint64 s) { return (o < 0) || (s < 0) || (o > blobsSize) || (s > blobsSize - o); };
+        if (outOfBounds(offset, size) || outOfBounds(jsonOffset, jsonSize)) {
+            return false;
+        }
+
+        // shapes, backgrounds and unknown resources stay in the mapping, the small JSON files are copied
+        auto data = QByteArray::fromRawData(bundle.constData() + blobs + offset, static_cast<int>(size));
+        auto getJSON = [&] () {
+            auto cbor = QByteArray::fromRawData(bundle.constData() + blobs + jsonOffset, static_cast<int>(jsonSize));
+            return QCborValue::fromCbor(cbor).toMap().toJsonObject();
+        };
+
+        ResourceLoader::LoadedFile loadedFile;
+        loadedFile.path = path;
+        bool mapped = false;
+        switch (static_cast<BundleEntryKind>(kind)) {
+
+            case BundleEntryKind::resource:
+                loadedFile.resource = ResourcePointer{new Resource{path, data}};
+                mapped = true;
+                break;
+
+            case BundleEntryKind::background:
+                loadedFile.resource = ResourcePointer{new Background{path, data}};
+                mapped = true;
+                break;
+
+            case BundleEntryKind::colorPalette:
+                loadedFile.resource = ResourcePointer{new ColorPalette{path,
+                                                                       QByteArray{data.constData(), data.size()},
+                                                                       getJSON()}};
+                break;
+
+            case BundleEntryKind::shape:
+                loadedFile.resource = ResourcePointer{new Shape{path, data}};
+                mapped = true;
+                break;
+
+            case BundleEntryKind::shapeCatalog:
+                loadedFile.shapeCatalog = true;
+                loadedFile.classification.path = path;
+                loadedFile.classification.data = QByteArray{data.constData(), data.size()};
+                loadedFile.classification.type = ResourceType::shape;
+                loadedFile.classification.mimeType = mimeDatabase.mimeTypeForName(mimeTypeName);
+                loadedFile.classification.json = getJSON();
+                break;
+
+            default:
+                return false;
+        }
+
+        if (loadedFile.resource) {
+            loadedFile.resource->setMimeType(mimeDatabase.mimeTypeForName(mimeTypeName));
+            if (mapped) {
+                loadedFile.resource->keepMapping(mapping);
+            }
+        }
+        loadedFiles.push_back(std::move(loadedFile));
+    }
+
+    // the entries must fill the index exactly, otherwise the blobs start elsewhere
+    return (stream.status() == QDataStream::Ok) && (stream.device()->pos() == blobs);
+}
@@ -4,19 +4,99 @@
  * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
  */
 
+#include <algorithm>
+#include <mutex>
 #include <utility>
 
+#include <QHash>
+
 #include <rpgmapper/resource/resource.hpp>
 #include <rpgmapper/resource/resource_collection.hpp>
+#include <rpgmapper/resource/shape.hpp>
 
+using namespace rpgmapper::model;
 using namespace rpgmapper::model::resource;
 
 
+/**
+ * The generation number drawn last by any collection.
+ */
+static std::atomic<std::uint64_t> latestGeneration{0};
+
+
+/**
+ * The generations recorded for the paths modified.
+ *
+ * A number is drawn and recorded under the mutex. Thus, a reader which has seen a
+ * generation in latestGeneration finds it recorded as soon as it gets the mutex.
+ */
+struct PathGenerations {
+    std::mutex mutex;                               /**< Guards drawing and recording generations. */
+    std::uint64_t allPaths = 0;                     /**< Generation drawn last for all paths. */
+    QHash<QString, std::uint64_t> paths;            /**< Generation drawn last for a path (if newer than allPaths). */
+};
+
+
+/**
+ * Returns the generations recorded for the paths modified.
+ *
+ * @return  the generations of the paths.
+ */
+static PathGenerations & getPathGenerations();
+
+
+ResourceCollection::ResourceCollection() : generation{nextGeneration()} {
+}
+
+
 void ResourceCollection::addResource(ResourcePointer resource) {
-    if (resource->getData().isEmpty()) {
+    if (resource->getSize() == 0) {
         throw std::runtime_error("Refused to add empty resource to resource DB.");
     }
+    resource->shareData();
     resources[resource->getPath()] = resource;
+    nextGeneration(resource->getPath());
+}
+
+
+void ResourceCollection::collectPaths(std::set<QString> & paths, QString const & prefix) const {
+    for (auto iter = resources.lower_bound(prefix); iter != resources.end(); ++iter) {
+        if (!(*iter).first.startsWith(prefix)) {
+            break;
+        }
+        paths.insert(paths.end(), (*iter).first);
+    }
+}
+
+
+std::uint64_t ResourceCollection::getLatestGeneration() {
+    return latestGeneration.load(std::memory_order_acquire);
+}
+
+
+MemoryReport ResourceCollection::getMemoryReport() const {
+
+    MemoryReport report;
+    for (auto const & pair : resources) {
+        auto const & resource = pair.second;
+        report.resourceBlobs += MemoryReport::getMapNodeOverhead() + MemoryReport::getBytes(pair.first);
+        if (resource->isLoaded() && !resource->isMapped()) {
+            report.resourceBlobs += MemoryReport::getBytes(resource->getData());
+        }
+        auto shape = dynamic_cast<Shape const *>(resource.data());
+        if (shape) {
+            report.shapeCaches += shape->getCacheBytes();
+        }
+    }
+
+    return report;
+}
+
+
+std::uint64_t ResourceCollection::getPathGeneration(QString const & path) {
+    auto & pathGenerations = getPathGenerations();
+    std::lock_guard<std::mutex> lock{pathGenerations.mutex};
+    return std::max(pathGenerations.allPaths, pathGenerations.paths.value(path, 0));
 }
 
 
@@ -26,7 +106,40 @@ std::set<QString> ResourceCollection::getPaths() const {
     
     std::for_each(resources.begin(),
                   resources.end(),
-                  [&] (auto p) { paths.insert(p.first); });
+                  [&] (auto const & p) { paths.insert(paths.end(), p.first); });
     
     return paths;
 }
+
+
+std::uint64_t ResourceCollection::nextGeneration() {
+    auto & pathGenerations = getPathGenerations();
+    std::lock_guard<std::mutex> lock{pathGenerations.mutex};
+    pathGenerations.allPaths = ++latestGeneration;
+    pathGenerations.paths.clear();
+    return pathGenerations.allPaths;
+}
+
+
+void ResourceCollection::nextGeneration(QString const & path) {
+    auto & pathGenerations = getPathGenerations();
+    std::lock_guard<std::mutex> lock{pathGenerations.mutex};
+    auto drawn = ++latestGeneration;
+    pathGenerations.paths[path] = drawn;
+    generation.store(drawn, std::memory_order_release);
+}
+
+
+bool ResourceCollection::removeResource(QString const & path) {
+    if (resources.erase(path) == 0) {
+        return false;
+    }
+    nextGeneration(path);
+    return true;
+}
+
+
+PathGenerations & getPathGenerations() {
+    static PathGenerations pathGenerations;
+    return pathGenerations;
+}
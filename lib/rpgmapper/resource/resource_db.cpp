@@ -4,15 +4,71 @@
  * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
  */
 
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <QHash>
+#include <QRunnable>
+#include <QThreadPool>
+
 #include <rpgmapper/atlas.hpp>
+#include <rpgmapper/resource/resource.hpp>
 #include <rpgmapper/resource/resource_collection.hpp>
 #include <rpgmapper/resource/resource_db.hpp>
 #include <rpgmapper/session.hpp>
+#include <rpgmapper/trace.hpp>
 
 
 using namespace rpgmapper::model::resource;
 
 
+/**
+ * Reads the data of resources on a thread pool.
+ */
+class PrefetchRunnable : public QRunnable {
+    
+    std::vector<ResourcePointer> resources;     /**< The resources to read. */
+    
+public:
+    
+    /**
+     * Constructor.
+     *
+     * @param   resources       the resources to read.
+     */
+    explicit PrefetchRunnable(std::vector<ResourcePointer> resources) : resources{std::move(resources)} {}
+    
+    /**
+     * Reads the data of the resources.
+     */
+    void run() override {
+        RPGMAPPER_TRACE_SCOPE("ResourceDB::prefetch");
+        for (auto const & resource : resources) {
+            resource->loadData();
+        }
+    }
+};
+
+
+/**
+ * A path resolved.
+ */
+struct Resolution {
+    ResourcePointer resource;                       /**< The winning resource (or nullptr). */
+    std::uint64_t generation = 0;                   /**< Latest collection generation the resolution is valid in. */
+};
+
+
+/**
+ * The merged resolution index of the ResourceDB.
+ */
+struct ResolutionIndex {
+    std::mutex mutex;                               /**< Guards the index. */
+    QHash<QString, Resolution> resolved;            /**< Path to its resolution. */
+};
+
+
 /**
  * Collect all resources from a DB with a given prefix.
  *
@@ -35,6 +91,24 @@ static void collectResourcesWithPrefix(std::set<QString> & collection,
 static ResourcePointer findResource(ResourceCollectionPointer db, QString const & name);
 
 
+/**
+ * Returns the resolution index of the ResourceDB.
+ *
+ * @return  the resolution index.
+ */
+static ResolutionIndex & getResolutionIndex();
+
+
+std::uint64_t ResourceDB::getGeneration() {
+    return ResourceCollection::getLatestGeneration();
+}
+
+
+std::uint64_t ResourceDB::getGeneration(QString const & path) {
+    return ResourceCollection::getPathGeneration(path);
+}
+
+
 ResourceCollectionPointer ResourceDB::getLocalResources() {
     return Session::getCurrentSession()->getAtlas()->getResources();
 }
@@ -42,6 +116,20 @@ ResourceCollectionPointer ResourceDB::getLocalResources() {
 
 ResourcePointer ResourceDB::getResource(QString path) {
     
+    auto & index = getResolutionIndex();
+    std::lock_guard<std::mutex> lock{index.mutex};
+    auto generation = getGeneration();
+    
+    // a resolution older than the generation is kept, unless its path has been modified since
+    auto iter = index.resolved.find(path);
+    if (iter != index.resolved.end()) {
+        auto & resolution = iter.value();
+        if ((resolution.generation == generation) || (getGeneration(path) <= resolution.generation)) {
+            resolution.generation = generation;
+            return resolution.resource;
+        }
+    }
+    
     ResourcePointer resource = findResource(getLocalResources(), path);
     
     if (!resource) {
@@ -52,6 +140,7 @@ ResourcePointer ResourceDB::getResource(QString path) {
         resource = findResource(getSystemResources(), path);
     }
     
+    index.resolved.insert(path, {resource, generation});
     return resource;
 }
 
@@ -86,16 +175,32 @@ ResourceCollectionPointer ResourceDB::getUserResources() {
 }
 
 
-void collectResourcesWithPrefix(std::set<QString> & collection,
-        ResourceCollectionPointer const & db,
-        QString const & prefix) {
+void ResourceDB::invalidate() {
+    ResourceCollection::nextGeneration();
+}
+
+
+void ResourceDB::prefetch(QStringList const & paths) {
     
-    auto paths = db->getPaths();
+    std::vector<ResourcePointer> resources;
     for (auto const & path : paths) {
-        if (path.startsWith(prefix)) {
-            collection.insert(path);
+        auto resource = getResource(path);
+        if (resource && !resource->isLoaded()) {
+            resources.push_back(resource);
         }
     }
+    
+    if (!resources.empty()) {
+        QThreadPool::globalInstance()->start(new PrefetchRunnable{std::move(resources)});
+    }
+}
+
+
+void collectResourcesWithPrefix(std::set<QString> & collection,
+        ResourceCollectionPointer const & db,
+        QString const & prefix) {
+    
+    db->collectPaths(collection, prefix);
 }
 
 
@@ -109,3 +214,10 @@ ResourcePointer findResource(ResourceCollectionPointer db, QString const & path)
     }
     return resource;
 }
+
+
+ResolutionIndex & getResolutionIndex() {
+    static ResolutionIndex index;
+    return index;
+}
+
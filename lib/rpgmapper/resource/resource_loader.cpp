@@ -4,31 +4,84 @@
  * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
  */
 
+#include <mutex>
 #include <utility>
 
-#include <QApplication>
 #include <QDateTime>
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
+#include <QImageReader>
+#include <QJsonDocument>
 #include <QMimeDatabase>
 #include <QMimeType>
+#include <QRunnable>
+#include <QSemaphore>
 #include <QStandardPaths>
 #include <QStringList>
+#include <QSvgRenderer>
 
 #include <rpgmapper/resource/background.hpp>
 #include <rpgmapper/resource/colorpalette.hpp>
 #include <rpgmapper/resource/resource.hpp>
+#include <rpgmapper/resource/resource_bundle.hpp>
 #include <rpgmapper/resource/resource_collection.hpp>
 #include <rpgmapper/resource/resource_db.hpp>
 #include <rpgmapper/resource/resource_loader.hpp>
 #include <rpgmapper/resource/resource_type.hpp>
 #include <rpgmapper/resource/shape.hpp>
 #include <rpgmapper/resource/shape_catalog.hpp>
+#include <rpgmapper/trace.hpp>
 
 using namespace rpgmapper::model::resource;
 
 
+/**
+ * System backgrounds and unknown resources of at least this size are memory mapped instead of read.
+ *
+ * Each mapping keeps its file open, so small files are still read.
+ */
+static qint64 const MAP_THRESHOLD = 64 * 1024;
+
+
+/**
+ * Runs a function object on a thread pool.
+ */
+template <typename Function>
+class FunctionRunnable : public QRunnable {
+    
+    Function function;          /**< The function to run. */
+    
+public:
+    
+    /**
+     * Constructor.
+     *
+     * @param   function        the function to run.
+     */
+    explicit FunctionRunnable(Function function) : function{std::move(function)} {}
+    
+    /**
+     * Runs the function.
+     */
+    void run() override {
+        function();
+    }
+};
+
+
+/**
+ * Runs a function on a thread pool.
+ *
+ * @param   pool            the thread pool.
+ * @param   function        the function to run.
+ */
+template <typename Function>
+static void runOnPool(QThreadPool & pool, Function function) {
+    pool.start(new FunctionRunnable<Function>{std::move(function)});
+}
+
+
 /**
  * Appends a single entry to the log, keeps formatting with timestamps.
  *
@@ -56,30 +109,66 @@ static void collectResources(ResourceLoader::FileCollection & fileCollection,
 
 
 /**
- * Grabs a list of system resources to load.
+ * Creates a resource which reads its data on first use.
+ *
+ * Shapes (SVG), backgrounds and unknown resources are indexed only. Shape catalogs and
+ * color palettes are small and needed right away, they are read at once.
+ *
+ * Only the head of the file is checked: a file which does not look like the type its
+ * path claims is read at once instead, so it is rejected as before.
  *
- * @param   fileCollection       the files found
- * @param   log         the log for capturing progress messages
+ * @param   path        the resource path, identifying the resource.
+ * @param   fileInfo    the file holding the resource data.
+ * @param   mappable    large backgrounds and unknown resources may be memory mapped.
+ * @return  the lazily loaded resource (or nullptr, if the file must be read at once).
  */
-static void collectSystemResources(ResourceLoader::FileCollection & fileCollection, QStringList & log);
+static ResourcePointer createLazyResource(QString const & path, QFileInfo const & fileInfo, bool mappable);
 
 
 /**
- * Grabs a list of user resources to load.
+ * Returns the folders which may hold system resources.
+ *
+ * @return  the system resource folders.
+ */
+static QStringList getSystemResourceFolders();
+
+
+/**
+ * Returns the folders which may hold user resources.
  *
- * @param   files           the files found
  * @param   userFolders     the list of user defined folders to search.
- * @param   log             the log for capturing progress messages
+ * @return  the user resource folders.
  */
-static void collectUserResources(ResourceLoader::FileCollection & files,
-        QStringList const & userFolders,
-        QStringList & log);
+static QStringList getUserResourceFolders(QStringList const & userFolders);
+
+
+/**
+ * Indexes or reads and parses a single resource file (runs on a worker thread).
+ *
+ * Shape catalogs apply their values to shapes in the ResourceDB. Thus they are
+ * only classified here and created later when merged.
+ *
+ * @param   folder      the resource folder of the file.
+ * @param   fileName    the file to read.
+ * @param   mappable    large files may be memory mapped.
+ * @return  the file read.
+ */
+static ResourceLoader::LoadedFile readFile(QString const & folder, QString const & fileName, bool mappable);
 
 
 ResourceLoader::ResourceLoader(QObject * parent) : QObject{parent} {
 #ifdef SOURCE_PATH
     userFolders.append(QString{SOURCE_PATH} + "/share/rpgmapper");
 #endif
+    qRegisterMetaType<LoadingEvent>();
+    backgroundPool.setMaxThreadCount(1);
+    connect(this, &ResourceLoader::filesRead, this, &ResourceLoader::backgroundLoaded, Qt::QueuedConnection);
+}
+
+
+ResourceLoader::~ResourceLoader() {
+    backgroundPool.waitForDone();
+    workerPool.waitForDone();
 }
 
 
@@ -87,44 +176,74 @@ void ResourceLoader::applyShapeCatalogs(QStringList & log) {
     
     appendLog(log, QString{"Applying shape catalog values to loaded shapes..."});
     
+    RPGMAPPER_TRACE_SCOPE("ResourceLoader::applyShapeCatalogs");
+    
     auto shapePrefix = getResourcePrefixForType(ResourceType::shape);
     for (auto const & path : ResourceDB::getResources(shapePrefix)) {
         
         auto resource = ResourceDB::getResource(path);
         auto shapeCatalog = dynamic_cast<ShapeCatalog *>(resource.data());
         if (shapeCatalog) {
-            
-            // "reloading" the shape catalog enforces resetting shape values
-            shapeCatalog->setData(shapeCatalog->getData());
+            shapeCatalog->applyShapes();
         }
     }
 }
 
 
-ResourcePointer ResourceLoader::createBackground(QString path, QByteArray const & data, QStringList & log) {
+void ResourceLoader::backgroundLoaded() {
+    mergeResources(backgroundLog);
+}
+
+
+ResourceLoader::Classification ResourceLoader::classify(QString path, QByteArray data) {
+    
+    static QMimeDatabase mimeDatabase;
+    
+    Classification classification;
+    classification.type = suggestResourceTypeByPath(path);
+    classification.mimeType = mimeDatabase.mimeTypeForData(data);
+    
+    auto mayBeJSON = (classification.type == ResourceType::colorpalette)
+            || ((classification.type == ResourceType::shape) && !Shape::isShape(classification.mimeType));
+    if (mayBeJSON) {
+        classification.json = QJsonDocument::fromJson(data).object();
+    }
+    
+    classification.path = std::move(path);
+    classification.data = std::move(data);
+    
+    return classification;
+}
+
+
+ResourcePointer ResourceLoader::createBackground(Classification const & classification, QStringList & log) {
     
     ResourcePointer background;
     
-    if (Background::isBackground(data)) {
-        background = ResourcePointer(new Background{path, data});
+    if (Background::isBackground(classification.mimeType)) {
+        background = ResourcePointer(new Background{classification.path, classification.data});
+        background->setMimeType(classification.mimeType);
     }
     else {
-        appendLog(log, QString{"Resource data at %1 is not a background as claimed."}.arg(path));
+        appendLog(log, QString{"Resource data at %1 is not a background as claimed."}.arg(classification.path));
     }
     
     return background;
 }
 
 
-ResourcePointer ResourceLoader::createColorPalette(QString path, QByteArray const & data, QStringList & log) {
+ResourcePointer ResourceLoader::createColorPalette(Classification const & classification, QStringList & log) {
     
     ResourcePointer colorPalette;
     
-    if (ColorPalette::isColorPalette(data)) {
-        colorPalette = ResourcePointer(new ColorPalette{path, data});
+    if (ColorPalette::isColorPalette(classification.json)) {
+        colorPalette = ResourcePointer(new ColorPalette{classification.path,
+                                                        classification.data,
+                                                        classification.json});
+        colorPalette->setMimeType(classification.mimeType);
     }
     else {
-        appendLog(log, QString{"Resource data at %1 is not a color palette as claimed."}.arg(path));
+        appendLog(log, QString{"Resource data at %1 is not a color palette as claimed."}.arg(classification.path));
     }
     
     return colorPalette;
@@ -133,39 +252,49 @@ ResourcePointer ResourceLoader::createColorPalette(QString path, QByteArray cons
 
 ResourcePointer ResourceLoader::createResource(QString path, QByteArray const & data, QStringList & log) {
     
+    if (data.isEmpty()) {
+        appendLog(log, "Resource data is empty. Refusing to create empty resource.");
+        return ResourcePointer{};
+    }
+    
+    return createResource(classify(std::move(path), data), log);
+}
+
+
+ResourcePointer ResourceLoader::createResource(Classification const & classification, QStringList & log) {
+    
     ResourcePointer resource;
     
-    if (data.isEmpty()) {
+    if (classification.data.isEmpty()) {
         appendLog(log, "Resource data is empty. Refusing to create empty resource.");
         return resource;
     }
 
-    auto resourceType = suggestResourceTypeByPath(path);
-    switch (resourceType) {
+    switch (classification.type) {
         
         case ResourceType::unknown:
-            resource = createUnknownResource(path, data);
+            resource = createUnknownResource(classification);
             break;
             
         case ResourceType::background:
-            resource = createBackground(path, data, log);
+            resource = createBackground(classification, log);
             break;
     
         case ResourceType::colorpalette:
-            resource = createColorPalette(path, data, log);
+            resource = createColorPalette(classification, log);
             break;
             
         case ResourceType::shape:
             
-            if (ShapeCatalog::isShapeCatalog(data)) {
-                resource = createShapeCatalog(path, data, log);
+            if (ShapeCatalog::isShapeCatalog(classification.json)) {
+                resource = createShapeCatalog(classification, log);
             }
             else
-            if (Shape::isShape(data)) {
-                resource = createShape(path, data, log);
+            if (Shape::isShape(classification.mimeType)) {
+                resource = createShape(classification, log);
             }
             else {
-                appendLog(log, QString{"Resource %1 is neither shape catalog nor shape."}.arg(path));
+                appendLog(log, QString{"Resource %1 is neither shape catalog nor shape."}.arg(classification.path));
             }
             break;
     }
@@ -174,67 +303,59 @@ ResourcePointer ResourceLoader::createResource(QString path, QByteArray const &
 }
 
 
-ResourcePointer ResourceLoader::createShape(QString path, QByteArray const & data, QStringList & log) {
+ResourcePointer ResourceLoader::createShape(Classification const & classification, QStringList & log) {
     
     ResourcePointer shape;
     
-    if (Shape::isShape(data)) {
-        shape = ResourcePointer(new Shape{path, data});
+    if (!Shape::isShape(classification.mimeType)) {
+        appendLog(log, QString{"Resource data at %1 is not a shape as claimed."}.arg(classification.path));
+    }
+    else if (!QSvgRenderer{classification.data}.isValid()) {
+        appendLog(log, QString{"Resource data at %1 is not a valid SVG."}.arg(classification.path));
     }
     else {
-        appendLog(log, QString{"Resource data at %1 is not a shape as claimed."}.arg(path));
+        shape = ResourcePointer(new Shape{classification.path, classification.data});
+        shape->setMimeType(classification.mimeType);
     }
     
     return shape;
 }
 
 
-ResourcePointer ResourceLoader::createShapeCatalog(QString path, QByteArray const & data, QStringList & log) {
+ResourcePointer ResourceLoader::createShapeCatalog(Classification const & classification, QStringList & log) {
     
     ResourcePointer shapeCatalog;
     
-    if (ShapeCatalog::isShapeCatalog(data)) {
-        shapeCatalog = ResourcePointer(new ShapeCatalog{path, data});
+    if (ShapeCatalog::isShapeCatalog(classification.json)) {
+        shapeCatalog = ResourcePointer(new ShapeCatalog{classification.path,
+                                                        classification.data,
+                                                        classification.json});
+        shapeCatalog->setMimeType(classification.mimeType);
     }
     else {
-        appendLog(log, QString{"Resource data at %1 is not a shape catalog as claimed."}.arg(path));
+        appendLog(log, QString{"Resource data at %1 is not a shape catalog as claimed."}.arg(classification.path));
     }
     
     return shapeCatalog;
 }
 
 
-ResourcePointer ResourceLoader::createUnknownResource(QString path, QByteArray const & data) {
-    return ResourcePointer(new Resource{std::move(path), data});
+ResourcePointer ResourceLoader::createUnknownResource(Classification const & classification) {
+    auto resource = ResourcePointer(new Resource{classification.path, classification.data});
+    resource->setMimeType(classification.mimeType);
+    return resource;
+}
+
+
+QStringList ResourceLoader::getResourceFolders() const {
+    return getUserResourceFolders(userFolders);
 }
 
 
 void ResourceLoader::load(QStringList & log) {
-    
-    appendLog(log, "Collecting Resources...");
-    
-    LoadingEvent event = {"Collecting system resources...", 0, 0};
-    emit loading(event);
-    QApplication::processEvents();
-    FileCollection systemResourcesFiles;
-    collectSystemResources(systemResourcesFiles, log);
-    appendLog(log, QString{"Found %1 system resources."}.arg(systemResourcesFiles.size()));
-    
-    event = {"Collecting user resources...", 0, 0};
-    emit loading(event);
-    QApplication::processEvents();
-    FileCollection userResourcesFiles;
-    collectUserResources(userResourcesFiles, userFolders, log);
-    appendLog(log, QString{"Found %1 user resources."}.arg(userResourcesFiles.size()));
-    
-    appendLog(log, "Loading Resources...");
-    loadResources(systemResourcesFiles, ResourceDB::getSystemResources(), log);
-    loadResources(userResourcesFiles, ResourceDB::getUserResources(), log);
-    
-    applyShapeCatalogs(log);
-    
-    success = true;
-    emit done();
+    RPGMAPPER_TRACE_SCOPE("ResourceLoader::load");
+    readResources(log);
+    mergeResources(log);
 }
 
 
@@ -258,38 +379,175 @@ ResourcePointer ResourceLoader::load(QString filePath, QString fileRoot, QString
 }
 
 
-void ResourceLoader::loadResources(FileCollection const & fileCollection,
-        ResourceCollectionPointer collection,
-        QStringList & log) {
+void ResourceLoader::mergeFiles(LoadedFiles & loadedFiles, ResourceCollectionPointer collection, QStringList & log) {
     
-    int fileNumber = 1;
-    for (auto const & fileTuple : fileCollection) {
+    for (auto & loadedFile : loadedFiles) {
         
-        auto const & fileName = std::get<1>(fileTuple);
-        appendLog(log, QString{"Loading: %1..."}.arg(fileName));
-        LoadingEvent event = {fileName, fileNumber, static_cast<int>(fileCollection.size())};
-        emit loading(event);
-        QApplication::processEvents();
+        log.append(loadedFile.log);
         
-        QFile file{fileName};
-        if (!file.open(QIODevice::ReadOnly)) {
-            appendLog(log, QString{"Failed to open: %1"}.arg(fileName));
+        auto resource = loadedFile.resource;
+        if (loadedFile.shapeCatalog) {
+            resource = createShapeCatalog(loadedFile.classification, log);
         }
-        else {
-            
-            auto const & folder = std::get<0>(fileTuple);
-            auto resourcePath = fileName.right(fileName.size() - folder.size());
-            auto data = file.readAll();
-            file.close();
-            
-            auto resource = createResource(resourcePath, data, log);
-            if (resource) {
-                collection->addResource(resource);
+        if (resource) {
+            collection->addResource(resource);
+        }
+    }
+    
+    loadedFiles.clear();
+}
+
+
+void ResourceLoader::mergeResources(QStringList & log) {
+    RPGMAPPER_TRACE_SCOPE("ResourceLoader::mergeResources");
+    
+    mergeFiles(loadedSystemFiles, ResourceDB::getSystemResources(), log);
+    mergeFiles(loadedUserFiles, ResourceDB::getUserResources(), log);
+    
+    applyShapeCatalogs(log);
+    
+    success = true;
+    emit done();
+}
+
+
+ResourceLoader::LoadedFile ResourceLoader::read(QString const & filePath, QString const & fileRoot) {
+    
+    LoadedFile loadedFile;
+    loadedFile.path = filePath.right(filePath.size() - fileRoot.size());
+    appendLog(loadedFile.log, QString{"Loading: %1..."}.arg(filePath));
+    
+    QFile file{filePath};
+    if (!file.open(QIODevice::ReadOnly)) {
+        appendLog(loadedFile.log, QString{"Failed to open: %1"}.arg(filePath));
+        return loadedFile;
+    }
+    auto data = file.readAll();
+    file.close();
+    if (data.isEmpty()) {
+        appendLog(loadedFile.log, QString{"Resource file %1 is empty."}.arg(filePath));
+        return loadedFile;
+    }
+    
+    auto classification = classify(loadedFile.path, data);
+    auto isShape = classification.type == ResourceType::shape;
+    if (isShape && ShapeCatalog::isShapeCatalog(classification.json)) {
+        loadedFile.shapeCatalog = true;
+        loadedFile.classification = std::move(classification);
+    }
+    else {
+        loadedFile.resource = createResource(classification, loadedFile.log);
+    }
+    
+    return loadedFile;
+}
+
+
+ResourceLoader::LoadedFiles ResourceLoader::readFiles(FileCollection const & fileCollection,
+        bool mappable,
+        int & step,
+        int maxSteps) {
+    
+    LoadedFiles loadedFiles(fileCollection.size());
+    
+    std::mutex mutex;
+    std::vector<QString> finishedFiles;
+    QSemaphore finished;
+    
+    auto loadedFile = loadedFiles.begin();
+    for (auto const & fileTuple : fileCollection) {
+        runOnPool(workerPool, [&, fileTuple, loadedFile] () {
+            *loadedFile = readFile(std::get<0>(fileTuple), std::get<1>(fileTuple), mappable);
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+                finishedFiles.push_back(std::get<1>(fileTuple));
             }
+            finished.release();
+        });
+        ++loadedFile;
+    }
+    
+    for (std::size_t i = 0; i < fileCollection.size(); ++i) {
+        finished.acquire();
+        QString fileName;
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            fileName = finishedFiles[i];
         }
-        
-        fileNumber++;
+        LoadingEvent event = {fileName, ++step, maxSteps};
+        emit loading(event);
+    }
+    
+    return loadedFiles;
+}
+
+
+void ResourceLoader::readResources(QStringList & log) {
+    RPGMAPPER_TRACE_SCOPE("ResourceLoader::readResources");
+    
+    appendLog(log, "Collecting Resources...");
+    
+    LoadingEvent event = {"Collecting system resources...", 0, 0};
+    emit loading(event);
+    loadedSystemFiles.clear();
+    FileCollection systemResourcesFiles;
+    auto bundleFileName = QStandardPaths::locate(QStandardPaths::AppDataLocation, ResourceBundle::getFileName());
+    if (bundleFileName.isEmpty() || !ResourceBundle::read(bundleFileName, loadedSystemFiles, log)) {
+        systemResourcesFiles = scanFolders(getSystemResourceFolders(), log);
+        appendLog(log, QString{"Found %1 system resources."}.arg(systemResourcesFiles.size()));
+    }
+    
+    event = {"Collecting user resources...", 0, 0};
+    emit loading(event);
+    auto userResourcesFiles = scanFolders(getUserResourceFolders(userFolders), log);
+    appendLog(log, QString{"Found %1 user resources."}.arg(userResourcesFiles.size()));
+    
+    appendLog(log, "Loading Resources...");
+    int step = 0;
+    int maxSteps = static_cast<int>(systemResourcesFiles.size() + userResourcesFiles.size());
+    
+    // user resources are watched and change on disk: they are read, never mapped
+    if (loadedSystemFiles.empty()) {
+        loadedSystemFiles = readFiles(systemResourcesFiles, true, step, maxSteps);
     }
+    loadedUserFiles = readFiles(userResourcesFiles, false, step, maxSteps);
+}
+
+
+ResourceLoader::FileCollection ResourceLoader::scanFolders(QStringList const & folders, QStringList & log) {
+    
+    std::vector<FileCollection> fileCollections(static_cast<std::size_t>(folders.size()));
+    std::vector<QStringList> logs(static_cast<std::size_t>(folders.size()));
+    
+    for (int i = 0; i < folders.size(); ++i) {
+        auto folder = folders[i];
+        auto & fileCollection = fileCollections[i];
+        auto & folderLog = logs[i];
+        runOnPool(workerPool, [folder, &fileCollection, &folderLog] () {
+            collectResources(fileCollection, folder, QFileInfo{folder}, folderLog);
+        });
+    }
+    workerPool.waitForDone();
+    
+    FileCollection files;
+    for (std::size_t i = 0; i < fileCollections.size(); ++i) {
+        log.append(logs[i]);
+        files.splice(files.end(), fileCollections[i]);
+    }
+    
+    return files;
+}
+
+
+void ResourceLoader::start() {
+    
+    backgroundLog.clear();
+    success = false;
+    
+    runOnPool(backgroundPool, [this] () {
+        readResources(backgroundLog);
+        emit filesRead();
+    });
 }
 
 
@@ -321,29 +579,90 @@ void collectResources(ResourceLoader::FileCollection & fileCollection,
 }
 
 
-void collectSystemResources(ResourceLoader::FileCollection & fileCollection, QStringList & log) {
+QStringList getSystemResourceFolders() {
     
     QStringList const resourceLocations = {"res", "resource", "resources"};
     
+    QStringList folders;
     for (auto const & location : QStandardPaths::standardLocations(QStandardPaths::AppDataLocation)) {
         for (auto const & resourceLocation : resourceLocations) {
-            auto folder = location + "/" + resourceLocation;
-            collectResources(fileCollection, folder, QFileInfo{location + "/" + resourceLocation}, log);
+            folders.append(location + "/" + resourceLocation);
         }
     }
+    
+    return folders;
 }
 
 
-void collectUserResources(ResourceLoader::FileCollection & fileCollection,
-        QStringList const & userFolders,
-        QStringList & log) {
+QStringList getUserResourceFolders(QStringList const & userFolders) {
     
     QStringList const resourceLocations = {"res", "resource", "resources"};
     
+    QStringList folders;
     for (auto const & location : userFolders) {
         for (auto const & resourceLocation : resourceLocations) {
-            auto folder = location + "/" + resourceLocation;
-            collectResources(fileCollection, folder, QFileInfo{folder}, log);
+            folders.append(location + "/" + resourceLocation);
+        }
+    }
+    
+    return folders;
+}
+
+
+ResourcePointer createLazyResource(QString const & path, QFileInfo const & fileInfo, bool mappable) {
+    
+    static QMimeDatabase mimeDatabase;
+    
+    Resource::Source source{fileInfo.absoluteFilePath(), fileInfo.size(), fileInfo.lastModified()};
+    auto mimeType = mimeDatabase.mimeTypeForFile(source.fileName, QMimeDatabase::MatchContent);
+    
+    ResourcePointer resource;
+    switch (suggestResourceTypeByPath(path)) {
+        
+        case ResourceType::unknown:
+            source.mapped = mappable && (source.size >= MAP_THRESHOLD);
+            resource = ResourcePointer{new Resource{path, std::move(source)}};
+            break;
+            
+        case ResourceType::background:
+            if (Background::isBackground(mimeType) && QImageReader{source.fileName}.canRead()) {
+                source.mapped = mappable && (source.size >= MAP_THRESHOLD);
+                resource = ResourcePointer{new Background{path, std::move(source)}};
+            }
+            break;
+        
+        case ResourceType::colorpalette:
+            break;
+            
+        case ResourceType::shape:
+            if ((fileInfo.suffix().toLower() == "svg") && Shape::isShape(mimeType)) {
+                resource = ResourcePointer{new Shape{path, std::move(source)}};
+            }
+            break;
+    }
+    
+    if (resource) {
+        resource->setMimeType(mimeType);
+    }
+    
+    return resource;
+}
+
+
+ResourceLoader::LoadedFile readFile(QString const & folder, QString const & fileName, bool mappable) {
+    
+    QFileInfo fileInfo{fileName};
+    if (fileInfo.size() > 0) {
+        auto path = fileName.right(fileName.size() - folder.size());
+        auto resource = createLazyResource(path, fileInfo, mappable);
+        if (resource) {
+            ResourceLoader::LoadedFile loadedFile;
+            loadedFile.path = path;
+            appendLog(loadedFile.log, QString{"Loading: %1..."}.arg(fileName));
+            loadedFile.resource = resource;
+            return loadedFile;
         }
     }
+    
+    return ResourceLoader::read(fileName, folder);
 }
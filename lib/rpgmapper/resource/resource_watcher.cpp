@@ -0,0 +1,272 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#include <functional>
+#include <set>
+#include <utility>
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QRunnable>
+
+#include <rpgmapper/resource/resource_collection.hpp>
+#include <rpgmapper/resource/resource_db.hpp>
+#include <rpgmapper/resource/resource_loader.hpp>
+#include <rpgmapper/resource/resource_type.hpp>
+#include <rpgmapper/resource/resource_watcher.hpp>
+#include <rpgmapper/resource/shape_catalog.hpp>
+
+using namespace rpgmapper::model::resource;
+
+
+/**
+ * Milliseconds to wait for more changes before rescanning (editors save in several steps).
+ */
+static int const RESCAN_DELAY = 250;
+
+
+/**
+ * Reads the changed files of a rescan on the pool and reports back to the watcher.
+ */
+class ResourceWatcherRunnable : public QRunnable {
+
+    QObject * watcher;                                              /**< The watcher to report to. */
+    std::function<ResourceLoader::LoadedFiles()> read;              /**< Reads the changed files. */
+    std::function<void(ResourceLoader::LoadedFiles)> complete;      /**< Applies the files on the watcher thread. */
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param   watcher     the watcher to report to.
+     * @param   read        reads the changed files.
+     * @param   complete    applies the files read on the watcher thread.
+     */
+    ResourceWatcherRunnable(QObject * watcher,
+            std::function<ResourceLoader::LoadedFiles()> read,
+            std::function<void(ResourceLoader::LoadedFiles)> complete)
+            : watcher{watcher}, read{std::move(read)}, complete{std::move(complete)} {}
+
+    /**
+     * Reads the files.
+     */
+    void run() override {
+        auto loadedFiles = read();
+        QMetaObject::invokeMethod(watcher, [complete = complete, loadedFiles] () {
+            complete(loadedFiles);
+        }, Qt::QueuedConnection);
+    }
+};
+
+
+ResourceWatcher::ResourceWatcher(QObject * parent) : QObject{parent} {
+    pool.setMaxThreadCount(1);
+    rescanTimer.setSingleShot(true);
+    rescanTimer.setInterval(RESCAN_DELAY);
+    connect(&rescanTimer, &QTimer::timeout, this, &ResourceWatcher::startRescan);
+    connect(&watcher, &QFileSystemWatcher::directoryChanged, &rescanTimer, qOverload<>(&QTimer::start));
+    connect(&watcher, &QFileSystemWatcher::fileChanged, &rescanTimer, qOverload<>(&QTimer::start));
+}
+
+
+ResourceWatcher::~ResourceWatcher() {
+    pool.waitForDone();
+}
+
+
+QStringList ResourceWatcher::apply(FileStates current, ResourceLoader::LoadedFiles const & loadedFiles) {
+
+    QStringList changedPaths;
+    auto userResources = ResourceDB::getUserResources();
+
+    for (auto const & loadedFile : loadedFiles) {
+
+        log.append(loadedFile.log);
+        auto resource = loadedFile.resource;
+        if (loadedFile.shapeCatalog) {
+            resource = ResourceLoader::createResource(loadedFile.classification, log);
+        }
+
+        if (!resource) {
+            // most likely still being written: the next change reads the file again
+            auto & state = current[loadedFile.path];
+            log.append(QString{"Failed to reload %1, keeping the previous resource."}.arg(state.fileName));
+            state.modified = QDateTime{};
+            continue;
+        }
+
+        userResources->addResource(resource);
+        changedPaths.append(loadedFile.path);
+    }
+
+    for (auto const & pair : files) {
+        if (current.find(pair.first) == current.end()) {
+            log.append(QString{"Removed: %1"}.arg(pair.second.fileName));
+            userResources->removeResource(pair.first);
+            changedPaths.append(pair.first);
+        }
+    }
+
+    files = std::move(current);
+    updateWatchedPaths();
+
+    if (!changedPaths.isEmpty()) {
+        reapplyShapeCatalogs(changedPaths);
+        emit resourcesChanged(changedPaths);
+    }
+
+    return changedPaths;
+}
+
+
+ResourceWatcher::FileStates ResourceWatcher::getChangedFiles(FileStates const & current) const {
+
+    FileStates changed;
+    for (auto const & pair : current) {
+
+        auto const & state = pair.second;
+        auto previous = files.find(pair.first);
+        bool unchanged = (previous != files.end())
+                && ((*previous).second.fileName == state.fileName)
+                && ((*previous).second.size == state.size)
+                && ((*previous).second.modified == state.modified);
+        if (!unchanged) {
+            changed.insert(pair);
+        }
+    }
+
+    return changed;
+}
+
+
+void ResourceWatcher::reapplyShapeCatalogs(QStringList const & paths) {
+
+    std::set<QString> changed{paths.begin(), paths.end()};
+
+    auto shapePrefix = getResourcePrefixForType(ResourceType::shape);
+    for (auto const & path : ResourceDB::getResources(shapePrefix)) {
+
+        auto resource = ResourceDB::getResource(path);
+        auto shapeCatalog = dynamic_cast<ShapeCatalog *>(resource.data());
+        if (!shapeCatalog) {
+            continue;
+        }
+
+        bool affected = changed.find(path) != changed.end();
+        for (auto const & pair : shapeCatalog->getShapes()) {
+            affected = affected || (changed.find(pair.second) != changed.end());
+        }
+        if (affected) {
+            shapeCatalog->applyShapes();
+        }
+    }
+}
+
+
+ResourceLoader::LoadedFiles ResourceWatcher::readFiles(FileStates const & changed) {
+
+    ResourceLoader::LoadedFiles loadedFiles;
+    for (auto const & pair : changed) {
+        loadedFiles.push_back(ResourceLoader::read(pair.second.fileName, pair.second.folder));
+    }
+
+    return loadedFiles;
+}
+
+
+QStringList ResourceWatcher::rescan() {
+    auto current = scan();
+    auto loadedFiles = readFiles(getChangedFiles(current));
+    return apply(std::move(current), loadedFiles);
+}
+
+
+ResourceWatcher::FileStates ResourceWatcher::scan() const {
+
+    FileStates states;
+
+    // later folders win, just as with the ResourceLoader
+    for (auto const & folder : folders) {
+        QDirIterator iter{folder, QDir::Files, QDirIterator::Subdirectories};
+        while (iter.hasNext()) {
+            auto fileName = iter.next();
+            auto fileInfo = iter.fileInfo();
+            states[fileName.mid(folder.size())] = {fileName, folder, fileInfo.size(), fileInfo.lastModified()};
+        }
+    }
+
+    return states;
+}
+
+
+void ResourceWatcher::startRescan() {
+
+    if (reading) {
+        rescanPending = true;
+        return;
+    }
+
+    auto current = scan();
+    auto changed = getChangedFiles(current);
+    if (changed.empty()) {
+        apply(std::move(current), {});
+        return;
+    }
+
+    reading = true;
+    pool.start(new ResourceWatcherRunnable{this,
+            [changed] () { return readFiles(changed); },
+            [this, current] (ResourceLoader::LoadedFiles loadedFiles) {
+                reading = false;
+                apply(current, loadedFiles);
+                if (rescanPending) {
+                    rescanPending = false;
+                    rescanTimer.start();
+                }
+            }});
+}
+
+
+void ResourceWatcher::updateWatchedPaths() {
+
+    auto watched = watcher.files() + watcher.directories();
+    if (!watched.isEmpty()) {
+        watcher.removePaths(watched);
+    }
+
+    QStringList paths;
+    for (auto const & folder : folders) {
+        if (!QFileInfo{folder}.isDir()) {
+            continue;
+        }
+        paths.append(folder);
+        QDirIterator iter{folder, QDir::Dirs | QDir::NoDotAndDotDot, QDirIterator::Subdirectories};
+        while (iter.hasNext()) {
+            paths.append(iter.next());
+        }
+    }
+    for (auto const & pair : files) {
+        paths.append(pair.second.fileName);
+    }
+
+    if (!paths.isEmpty()) {
+        watcher.addPaths(paths);
+    }
+}
+
+
+void ResourceWatcher::watch(QStringList const & folders) {
+
+    this->folders.clear();
+    for (auto const & folder : folders) {
+        this->folders.append(QDir{folder}.absolutePath());
+    }
+
+    files = scan();
+    updateWatchedPaths();
+}
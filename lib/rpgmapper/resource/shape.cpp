@@ -11,19 +11,89 @@
 #include <QPainter>
 #include <QSvgRenderer>
 
+#include <rpgmapper/resource/raster_cache.hpp>
 #include <rpgmapper/resource/shape.hpp>
+#include <rpgmapper/render_statistics.hpp>
 
+using namespace rpgmapper::model;
 using namespace rpgmapper::model::resource;
 
 
+/**
+ * Approximates the memory held by an image.
+ *
+ * @param   image       the image.
+ * @return  the number of bytes held by the image.
+ */
+static long long getBytes(QImage const & image) {
+    return static_cast<long long>(image.bytesPerLine()) * image.height();
+}
+
+
+/**
+ * Approximates the memory held by a pixmap.
+ *
+ * @param   pixmap      the pixmap.
+ * @return  the number of bytes held by the pixmap.
+ */
+static long long getBytes(QPixmap const & pixmap) {
+    return static_cast<long long>(pixmap.width()) * pixmap.height() * pixmap.depth() / 8;
+}
+
+
 Shape::Shape(QString name, QByteArray const & data) : Resource{std::move(name), data} {
 }
 
 
+Shape::Shape(QString name, Source source) : Resource{std::move(name), std::move(source)} {
+}
+
+
+Shape::~Shape() {
+    for (auto const & pair : images) {
+        RenderStatistics::addPixmapBytes(-getBytes(pair.second));
+    }
+    for (auto const & pair : pixmaps) {
+        RenderStatistics::addPixmapBytes(-getBytes(pair.second));
+    }
+}
+
+
 void Shape::addCache(QString index, QImage image, QPixmap pixmap, QIcon icon) const {
+    
+    // an image or pixmap already cached stays: only bytes actually added are counted
+    long long bytes = 0;
     icons.emplace(index, icon);
-    images.emplace(index, image);
-    pixmaps.emplace(index, pixmap);
+    if (images.emplace(index, image).second) {
+        bytes += getBytes(image);
+    }
+    if (pixmaps.emplace(index, pixmap).second) {
+        bytes += getBytes(pixmap);
+    }
+    RenderStatistics::addPixmapBytes(bytes);
+}
+
+
+void Shape::addImage(QImage image, unsigned int tileSize, double rotation, double stretch) const {
+    
+    if (image.isNull() || isPrepared(tileSize, rotation, stretch)) {
+        return;
+    }
+    
+    auto pixmap = QPixmap::fromImage(image);
+    addCache(getIndex(tileSize, rotation, stretch), image, pixmap, QIcon{pixmap});
+}
+
+
+long long Shape::getCacheBytes() const {
+    long long bytes = 0;
+    for (auto const & pair : images) {
+        bytes += getBytes(pair.second);
+    }
+    for (auto const & pair : pixmaps) {
+        bytes += getBytes(pair.second);
+    }
+    return bytes;
 }
 
 
@@ -47,13 +117,37 @@ QPixmap Shape::getPixmap(unsigned int tileSize, double rotation, double stretch)
 }
 
 
+bool Shape::isPrepared(unsigned int tileSize, double rotation, double stretch) const {
+    auto index = getIndex(tileSize, rotation, stretch);
+    return (icons.find(index) != icons.end())
+            && (images.find(index) != images.end())
+            && (pixmaps.find(index) != pixmaps.end());
+}
+
+
 bool Shape::isShape(QByteArray const & data) {
-    
     static QMimeDatabase mimeDatabase;
-    auto mimeType = mimeDatabase.mimeTypeForData(data);
+    return isShape(mimeDatabase.mimeTypeForData(data));
+}
+
+
+bool Shape::isShape(QMimeType const & mimeType) {
+    return mimeType.name() == "image/svg+xml";
+}
+
+
+bool Shape::isValid() const {
     
-    auto mimeTypeString = mimeType.name();
-    return mimeTypeString == "image/svg+xml";
+    if (!isLoaded()) {
+        return getSize() > 0;
+    }
+    
+    if (svgState.load(std::memory_order_acquire) == SvgState::unknown) {
+        bool valid = false;
+        withData([&] (QByteArray const & data) { valid = QSvgRenderer{data}.isValid(); });
+        svgState.store(valid ? SvgState::valid : SvgState::invalid, std::memory_order_release);
+    }
+    return svgState.load(std::memory_order_acquire) == SvgState::valid;
 }
 
 
@@ -61,13 +155,13 @@ QString Shape::prepare(unsigned int tileSize, double rotation, double stretch) c
     
     auto index = getIndex(tileSize, rotation, stretch);
     
-    auto iconPresent = icons.find(index) != icons.end();
-    auto imagePresent = images.find(index) != images.end();
-    auto pixmapPresent = pixmaps.find(index) != pixmaps.end();
-    
-    if (!iconPresent || !imagePresent || !pixmapPresent) {
+    if (isPrepared(tileSize, rotation, stretch)) {
+        RenderStatistics::addShapeCacheHit();
+    }
+    else {
     
-        auto image = render(tileSize, rotation, stretch);
+        RenderStatistics::addShapeCacheMiss();
+        auto image = rasterize(tileSize, rotation, stretch);
         auto pixmap = QPixmap::fromImage(image);
         auto icon = QIcon{pixmap};
         addCache(index, image, pixmap, icon);
@@ -77,6 +171,21 @@ QString Shape::prepare(unsigned int tileSize, double rotation, double stretch) c
 }
 
 
+QImage Shape::rasterize(unsigned int tileSize, double rotation, double stretch) const {
+    
+    if (!RasterCache::isEnabled()) {
+        return render(tileSize, rotation, stretch);
+    }
+    
+    auto image = RasterCache::load(getHash(), tileSize, rotation, stretch);
+    if (image.isNull()) {
+        image = render(tileSize, rotation, stretch);
+        RasterCache::store(getHash(), tileSize, rotation, stretch, image);
+    }
+    return image;
+}
+
+
 QImage Shape::render(unsigned int tileSize, double rotation, double stretch) const {
     
     QSize size{static_cast<int>(tileSize), static_cast<int>(tileSize)};
@@ -84,7 +193,11 @@ QImage Shape::render(unsigned int tileSize, double rotation, double stretch) con
     image.fill(0);
 
     QPainter painter{&image};
-    QSvgRenderer svgRenderer{getData()};
+    QSvgRenderer svgRenderer;
+    withData([&] (QByteArray const & data) { svgRenderer.load(data); });
+    
+    // the SVG of a lazy shape is parsed here the first time: remember if it failed
+    svgState.store(svgRenderer.isValid() ? SvgState::valid : SvgState::invalid, std::memory_order_release);
     svgRenderer.render(&painter);
     
     QMatrix matrix;
@@ -97,6 +210,7 @@ QImage Shape::render(unsigned int tileSize, double rotation, double stretch) con
 
 void Shape::setData(QByteArray const & data) {
     Resource::setData(data);
+    svgState.store(SvgState::unknown, std::memory_order_release);
 }
 
 
@@ -22,6 +22,13 @@ using namespace rpgmapper::model::tile;
 
 
 ShapeCatalog::ShapeCatalog(QString name, QByteArray const & data) : Resource{std::move(name), data} {
+    parseData();
+    fromJSON();
+}
+
+
+ShapeCatalog::ShapeCatalog(QString name, QByteArray const & data, QJsonObject json)
+        : Resource{std::move(name), data}, json{std::move(json)} {
     fromJSON();
 }
 
@@ -33,33 +40,50 @@ void ShapeCatalog::addShape(QJsonObject const & json) {
         shapeName = json["name"].toString();
     }
     
-    QString shapePath;
-    if (json.contains("file") && json["file"].isString()) {
-        shapePath = getCatalogBase() + "/" + json["file"].toString();
-    }
-    
+    auto shapePath = getShapePath(json);
     if (!shapeName.isEmpty() && !shapePath.isEmpty()) {
         shapes.emplace(shapeName, shapePath);
     }
+}
+
+
+void ShapeCatalog::applyShape(QJsonObject const & json) const {
     
-    auto resource = ResourceDB::getResource(shapePath);
+    auto resource = ResourceDB::getResource(getShapePath(json));
     auto shape = dynamic_cast<rpgmapper::model::resource::Shape *>(resource.data());
-    if (shape) {
+    if (!shape) {
+        return;
+    }
     
-        shape->setName(shapeName);
-        
-        if (json.contains("layer") && json["layer"].isString()) {
-            shape->setTargetLayer(Shape::targetLayerFromString(json["layer"].toString()));
-        }
+    if (json.contains("name") && json["name"].isString()) {
+        shape->setName(json["name"].toString());
+    }
     
-        if (json.contains("z") && json["z"].isDouble()) {
-            auto z = static_cast<unsigned int>(json["z"].toDouble(0.0));
-            shape->setZOrdering(z);
-        }
-        
-        if (json.contains("mode") && json["mode"].isString()) {
-            auto mode = getInsertModeFromString(json["mode"].toString());
-            shape->setInsertMode(mode);
+    if (json.contains("layer") && json["layer"].isString()) {
+        shape->setTargetLayer(Shape::targetLayerFromString(json["layer"].toString()));
+    }
+    
+    if (json.contains("z") && json["z"].isDouble()) {
+        auto z = static_cast<unsigned int>(json["z"].toDouble(0.0));
+        shape->setZOrdering(z);
+    }
+    
+    if (json.contains("mode") && json["mode"].isString()) {
+        auto mode = getInsertModeFromString(json["mode"].toString());
+        shape->setInsertMode(mode);
+    }
+}
+
+
+void ShapeCatalog::applyShapes() const {
+    
+    if (!json.contains("shapes") || !json["shapes"].isArray()) {
+        return;
+    }
+    
+    for (auto && element : json["shapes"].toArray()) {
+        if (element.isObject()) {
+            applyShape(element.toObject());
         }
     }
 }
@@ -68,13 +92,8 @@ void ShapeCatalog::addShape(QJsonObject const & json) {
 void ShapeCatalog::fromJSON() {
     
     valid = false;
+    shapes.clear();
     
-    auto jsonDocument = QJsonDocument::fromJson(getData());
-    if (!jsonDocument.isObject()) {
-        return;
-    }
-    
-    auto json = jsonDocument.object();
     if (json.contains("name") && json["name"].isString()) {
         setName(json["name"].toString());
     }
@@ -100,6 +119,17 @@ QString ShapeCatalog::getCatalogBase() const {
 }
 
 
+QString ShapeCatalog::getShapePath(QJsonObject const & json) const {
+    
+    QString shapePath;
+    if (json.contains("file") && json["file"].isString()) {
+        shapePath = getCatalogBase() + "/" + json["file"].toString();
+    }
+    
+    return shapePath;
+}
+
+
 bool ShapeCatalog::isShapeCatalog(QByteArray const & data) {
     
     auto jsonDocument = QJsonDocument::fromJson(data);
@@ -107,7 +137,11 @@ bool ShapeCatalog::isShapeCatalog(QByteArray const & data) {
         return false;
     }
     
-    auto json = jsonDocument.object();
+    return isShapeCatalog(jsonDocument.object());
+}
+
+
+bool ShapeCatalog::isShapeCatalog(QJsonObject const & json) {
     bool namePresent = json.contains("name") && json["name"].isString();
     bool shapesPresent = json.contains("shapes") && json["shapes"].isArray();
     
@@ -115,7 +149,14 @@ bool ShapeCatalog::isShapeCatalog(QByteArray const & data) {
 }
 
 
+void ShapeCatalog::parseData() {
+    json = QJsonDocument::fromJson(getData()).object();
+}
+
+
 void ShapeCatalog::setData(QByteArray const & data) {
     Resource::setData(data);
+    parseData();
     fromJSON();
+    applyShapes();
 }
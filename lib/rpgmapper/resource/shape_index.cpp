@@ -0,0 +1,201 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#include <algorithm>
+
+#include <rpgmapper/resource/shape_index.hpp>
+
+using namespace rpgmapper::model::resource;
+
+
+/**
+ * Collects the distinct trigrams of the words of a normalized text.
+ *
+ * Each word is padded with two blanks in front and one blank at the end, so a word
+ * "ab" yields "  a", " ab" and "ab ".
+ *
+ * @param   text        the normalized text.
+ * @return  the sorted distinct trigrams (three UTF-16 code units packed into 48 bits).
+ */
+static std::vector<quint64> collectTrigrams(QString const & text);
+
+
+/**
+ * Normalizes a text for searching: lower case words of letters and digits only.
+ *
+ * @param   text        the text to normalize.
+ * @return  the words of the text separated by single blanks.
+ */
+static QString normalize(QString const & text);
+
+
+void ShapeIndex::addCatalog(ShapeCatalog const & catalog) {
+
+    removeCatalog(catalog.getPath());
+
+    auto & catalogEntries = catalogs[catalog.getPath()];
+    for (auto const & pair : catalog.getShapes()) {
+
+        Entry entry;
+        entry.shapePath = pair.second;
+        entry.shapeName = pair.first;
+        entry.catalogPath = catalog.getPath();
+        entry.catalogName = catalog.getName();
+        entry.text = normalize(entry.shapeName + " " + entry.catalogName + " " + entry.shapePath);
+
+        auto id = static_cast<std::uint32_t>(entries.size());
+        entries.push_back(std::move(entry));
+        catalogEntries.push_back(id);
+        indexEntry(id);
+    }
+}
+
+
+void ShapeIndex::clear() {
+    entries.clear();
+    trigrams.clear();
+    catalogs.clear();
+    removedEntries = 0;
+}
+
+
+void ShapeIndex::indexEntry(std::uint32_t id) {
+    for (auto trigram : collectTrigrams(entries[id].text)) {
+        trigrams[trigram].push_back(id);
+    }
+}
+
+
+void ShapeIndex::rebuild() {
+
+    std::vector<Entry> liveEntries;
+    liveEntries.reserve(getSize());
+    for (auto & entry : entries) {
+        if (!entry.removed) {
+            liveEntries.push_back(std::move(entry));
+        }
+    }
+
+    entries = std::move(liveEntries);
+    trigrams.clear();
+    catalogs.clear();
+    removedEntries = 0;
+    for (std::uint32_t id = 0; id < entries.size(); ++id) {
+        catalogs[entries[id].catalogPath].push_back(id);
+        indexEntry(id);
+    }
+}
+
+
+bool ShapeIndex::removeCatalog(QString const & catalogPath) {
+
+    auto iter = catalogs.find(catalogPath);
+    if (iter == catalogs.end()) {
+        return false;
+    }
+
+    // the postings keep the ids until the next rebuild, search skips removed entries
+    for (auto id : (*iter).second) {
+        entries[id].removed = true;
+    }
+    removedEntries += (*iter).second.size();
+    catalogs.erase(iter);
+
+    if (removedEntries > entries.size() / 2) {
+        rebuild();
+    }
+    return true;
+}
+
+
+std::vector<ShapeIndex::Match> ShapeIndex::search(QString const & query, std::size_t maxResults) const {
+
+    std::vector<Match> matches;
+    auto normalizedQuery = normalize(query);
+    if (normalizedQuery.isEmpty() || (maxResults == 0)) {
+        return matches;
+    }
+
+    auto queryTrigrams = collectTrigrams(normalizedQuery);
+    std::vector<std::uint16_t> hits(entries.size(), 0);
+    std::vector<std::uint32_t> candidates;
+    for (auto trigram : queryTrigrams) {
+        auto iter = trigrams.constFind(trigram);
+        if (iter == trigrams.constEnd()) {
+            continue;
+        }
+        for (auto id : *iter) {
+            if (hits[id]++ == 0) {
+                candidates.push_back(id);
+            }
+        }
+    }
+
+    // a third of the trigrams in common still finds words with a typo or two swapped letters
+    auto minimumHits = std::max<std::size_t>(1, (queryTrigrams.size() + 2) / 3);
+    for (auto id : candidates) {
+
+        auto const & entry = entries[id];
+        if (entry.removed || (hits[id] < minimumHits)) {
+            continue;
+        }
+
+        auto score = static_cast<float>(hits[id]) / static_cast<float>(queryTrigrams.size());
+        if (entry.text.startsWith(normalizedQuery)) {
+            score += 1.0f;
+        }
+        else
+        if (entry.text.contains(normalizedQuery)) {
+            score += 0.5f;
+        }
+        matches.push_back({entry.shapePath, entry.shapeName, entry.catalogPath, entry.catalogName, score});
+    }
+
+    auto better = [] (Match const & lhs, Match const & rhs) {
+        if (lhs.score != rhs.score) {
+            return lhs.score > rhs.score;
+        }
+        return lhs.shapeName < rhs.shapeName;
+    };
+    if (matches.size() > maxResults) {
+        std::partial_sort(matches.begin(), matches.begin() + maxResults, matches.end(), better);
+        matches.resize(maxResults);
+    }
+    else {
+        std::sort(matches.begin(), matches.end(), better);
+    }
+
+    return matches;
+}
+
+
+std::vector<quint64> collectTrigrams(QString const & text) {
+
+    std::vector<quint64> trigrams;
+    for (auto const & word : text.splitRef(' ', QString::SkipEmptyParts)) {
+        auto padded = QString{"  "} + word.toString() + " ";
+        for (int i = 0; i + 3 <= padded.size(); ++i) {
+            trigrams.push_back((static_cast<quint64>(padded[i].unicode()) << 32)
+                    | (static_cast<quint64>(padded[i + 1].unicode()) << 16)
+                    | static_cast<quint64>(padded[i + 2].unicode()));
+        }
+    }
+
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+    return trigrams;
+}
+
+
+QString normalize(QString const & text) {
+
+    QString normalized;
+    normalized.reserve(text.size());
+    for (auto c : text) {
+        normalized.append(c.isLetterOrNumber() ? c.toLower() : QChar{' '});
+    }
+    return normalized.simplified();
+}
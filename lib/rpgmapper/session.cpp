@@ -4,10 +4,17 @@
  * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
  */
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 #include <QDir>
 #include <QStandardPaths>
 
 #include <rpgmapper/command/processor.hpp>
+#include <rpgmapper/resource/resource_collection.hpp>
+#include <rpgmapper/resource/resource_db.hpp>
+#include <rpgmapper/resource/shape_catalog.hpp>
 #include <rpgmapper/exception/invalid_mapname.hpp>
 #include <rpgmapper/exception/invalid_region.hpp>
 #include <rpgmapper/exception/invalid_regionname.hpp>
@@ -178,6 +185,27 @@ SessionPointer Session::getCurrentSession() {
 }
 
 
+MemoryReport Session::getMemoryReport() const {
+
+    auto report = atlas->getMemoryReport();
+
+    for (auto const & collection : {resource::ResourceDB::getSystemResources(),
+                                    resource::ResourceDB::getUserResources()}) {
+        if (collection) {
+            report += collection->getMemoryReport();
+        }
+    }
+
+    for (auto commands : {&commandProcessor->getHistory(), &commandProcessor->getUndone()}) {
+        for (auto const & command : *commands) {
+            report.commandHistory += command->getMemorySize() + MemoryReport::getSharedPointerOverhead();
+        }
+    }
+
+    return report;
+}
+
+
 QString Session::getRegionOfMap(QString mapName) const {
     
     QString regionName = QString::null;
@@ -232,6 +260,20 @@ bool Session::load(SessionPointer & session, QFile & file, QStringList & log) {
 }
 
 
+bool Session::load(SessionPointer & session, AtlasContent const & content, QString fileName, QStringList & log) {
+    
+    session = SessionPointer(new Session);
+    auto atlas = session->getAtlas();
+    
+    bool loaded = createAtlas(atlas, content, log);
+    if (loaded) {
+        session->fileName = std::move(fileName);
+    }
+    
+    return loaded;
+}
+
+
 bool Session::save(QFile & file, QStringList & log) {
     
     log.clear();
@@ -265,6 +307,13 @@ void Session::selectMap(QString name) {
     
     if (name != currentMapName) {
         
+        if (name != QString::null) {
+            QStringList log;
+            auto map = findMap(name);
+            map->load(log);
+            map->touch();
+        }
+        
         QString oldRegionName = currentRegionName;
         if (name == QString::null) {
             currentRegionName = getRegionOfMap(currentMapName);
@@ -274,6 +323,7 @@ void Session::selectMap(QString name) {
         }
     
         currentMapName = name;
+        unloadMaps();
         emit selectedRegion(currentRegionName);
         emit selectedMap(currentMapName);
     }
@@ -300,6 +350,14 @@ void Session::setCurrentSession(SessionPointer session) {
         throw rpgmapper::model::exception::invalid_session();
     }
     currentSession = session;
+    resource::ResourceDB::invalidate();
+    
+    for (auto const & pair : session->getAtlas()->getResources()->getResources()) {
+        auto shapeCatalog = dynamic_cast<resource::ShapeCatalog *>(pair.second.data());
+        if (shapeCatalog) {
+            shapeCatalog->applyShapes();
+        }
+    }
 }
 
 
@@ -313,3 +371,39 @@ void Session::setLastAppliedTile(rpgmapper::model::tile::TilePointer & tile) {
     lastAppliedTile = tile;
     emit newLastAppliedTile();
 }
+
+
+int Session::unloadMaps() {
+    
+    long long total = 0;
+    std::vector<std::pair<MapPointer, long long>> candidates;
+    for (auto const & regionPair : getAtlas()->getRegions()) {
+        for (auto const & mapPair : regionPair.second->getMaps()) {
+            auto map = mapPair.second;
+            if (map->isLoaded()) {
+                auto bytes = map->getMemoryReport().getTotal();
+                total += bytes;
+                if (map->getName() != currentMapName) {
+                    candidates.emplace_back(map, bytes);
+                }
+            }
+        }
+    }
+    if (total <= mapMemoryLimit) {
+        return 0;
+    }
+    
+    std::sort(candidates.begin(), candidates.end(), [] (auto const & lhs, auto const & rhs) {
+        return lhs.first->getLastAccess() < rhs.first->getLastAccess();
+    });
+    
+    int unloaded = 0;
+    for (auto iter = candidates.begin(); (iter != candidates.end()) && (total > mapMemoryLimit); ++iter) {
+        if ((*iter).first->unload()) {
+            total -= (*iter).second;
+            ++unloaded;
+        }
+    }
+    
+    return unloaded;
+}
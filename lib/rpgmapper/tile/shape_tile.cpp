@@ -153,8 +153,17 @@ rpgmapper::model::resource::Shape * ShapeTile::getShape() const {
         return nullptr;
     }
     
-    auto resource = ResourceDB::getResource(path);
-    return dynamic_cast<Shape *>(resource.data());
+    // resolve again only if the path itself has been modified since
+    auto generation = ResourceDB::getGeneration();
+    if (path != shapePath) {
+        resolvedShape = ResourceDB::getResource(path);
+        shapePath = path;
+    }
+    else if ((generation != shapeGeneration) && (ResourceDB::getGeneration(path) > shapeGeneration)) {
+        resolvedShape = ResourceDB::getResource(path);
+    }
+    shapeGeneration = generation;
+    return dynamic_cast<Shape *>(resolvedShape.data());
 }
 
 
@@ -7,6 +7,8 @@
 #ifndef RPGMAPPER_MODEL_TILE_SHAPE_TILE_HPP
 #define RPGMAPPER_MODEL_TILE_SHAPE_TILE_HPP
 
+#include <cstdint>
+
 #include <rpgmapper/layer/layer_stack.hpp>
 #include <rpgmapper/resource/resource_pointer.hpp>
 #include <rpgmapper/resource/shape.hpp>
@@ -24,6 +26,10 @@ namespace rpgmapper::model::tile {
  */
 class ShapeTile : public Tile {
     
+    mutable rpgmapper::model::resource::ResourcePointer resolvedShape;     /**< The shape resolved last. */
+    mutable QString shapePath;                  /**< The path the shape has been resolved for. */
+    mutable std::uint64_t shapeGeneration = 0;  /**< The ResourceDB generation the shape has been checked in last. */
+    
 public:
     
     /**
@@ -69,6 +75,8 @@ public:
     /**
      * Gets the shape attached to this tile.
      *
+     * The shape is resolved once and kept until the path or the ResourceDB changes.
+     *
      * @return  the shape attached to this tile.
      */
     rpgmapper::model::resource::Shape * getShape() const;
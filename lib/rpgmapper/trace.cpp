@@ -0,0 +1,148 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <rpgmapper/trace.hpp>
+
+using namespace rpgmapper::model;
+
+
+std::atomic<bool> Trace::enabled{false};
+
+
+/**
+ * A single finished span.
+ */
+struct TraceEvent {
+    char const * name;                  /**< Name of the span. */
+    Trace::Clock::time_point start;     /**< Start of the span. */
+    Trace::Clock::time_point end;       /**< End of the span. */
+};
+
+
+/**
+ * The spans recorded by a single thread.
+ */
+struct TraceThreadBuffer {
+    std::mutex mutex;                   /**< Only contended while the trace is exported or cleared. */
+    std::vector<TraceEvent> events;     /**< The spans recorded. */
+    int threadId = 0;                   /**< Number of the thread in the trace. */
+};
+
+
+/**
+ * All thread buffers ever created. Buffers outlive their threads so no span is lost.
+ */
+struct TraceRegistry {
+    std::mutex mutex;                                       /**< Guards the list of buffers. */
+    std::list<std::shared_ptr<TraceThreadBuffer>> buffers;  /**< All thread buffers. */
+    Trace::Clock::time_point epoch = Trace::Clock::now();   /**< Time stamps are relative to this. */
+};
+
+
+/**
+ * Returns the global registry of thread buffers.
+ *
+ * @return  the registry of all thread buffers.
+ */
+static TraceRegistry & getRegistry() {
+    static TraceRegistry registry;
+    return registry;
+}
+
+
+/**
+ * Returns the buffer of the calling thread, creating it on first use.
+ *
+ * @return  the trace buffer of the calling thread.
+ */
+static TraceThreadBuffer & getThreadBuffer() {
+
+    thread_local std::shared_ptr<TraceThreadBuffer> buffer;
+    if (!buffer) {
+        buffer = std::make_shared<TraceThreadBuffer>();
+        auto & registry = getRegistry();
+        std::lock_guard<std::mutex> lock{registry.mutex};
+        buffer->threadId = static_cast<int>(registry.buffers.size()) + 1;
+        registry.buffers.push_back(buffer);
+    }
+    return *buffer;
+}
+
+
+void Trace::addSpan(char const * name, Clock::time_point start, Clock::time_point end) {
+    auto & buffer = getThreadBuffer();
+    std::lock_guard<std::mutex> lock{buffer.mutex};
+    buffer.events.push_back({name, start, end});
+}
+
+
+void Trace::clear() {
+    auto & registry = getRegistry();
+    std::lock_guard<std::mutex> lock{registry.mutex};
+    for (auto & buffer : registry.buffers) {
+        std::lock_guard<std::mutex> bufferLock{buffer->mutex};
+        buffer->events.clear();
+    }
+}
+
+
+void Trace::enable(bool enable) {
+    enabled.store(enable, std::memory_order_relaxed);
+}
+
+
+QByteArray Trace::getChromeTrace() {
+
+    using Microseconds = std::chrono::duration<double, std::micro>;
+
+    auto & registry = getRegistry();
+    auto processId = static_cast<qint64>(QCoreApplication::applicationPid());
+
+    QJsonArray traceEvents;
+    std::lock_guard<std::mutex> lock{registry.mutex};
+    for (auto & buffer : registry.buffers) {
+
+        std::lock_guard<std::mutex> bufferLock{buffer->mutex};
+        for (auto const & event : buffer->events) {
+            QJsonObject traceEvent;
+            traceEvent["name"] = QString{event.name};
+            traceEvent["cat"] = "rpgmapper";
+            traceEvent["ph"] = "X";
+            traceEvent["ts"] = Microseconds{event.start - registry.epoch}.count();
+            traceEvent["dur"] = Microseconds{event.end - event.start}.count();
+            traceEvent["pid"] = processId;
+            traceEvent["tid"] = buffer->threadId;
+            traceEvents.append(traceEvent);
+        }
+    }
+
+    QJsonObject json;
+    json["traceEvents"] = traceEvents;
+    json["displayTimeUnit"] = "ms";
+    return QJsonDocument{json}.toJson(QJsonDocument::Compact);
+}
+
+
+bool Trace::writeChromeTrace(QString const & fileName) {
+
+    QFile file{fileName};
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    auto json = getChromeTrace();
+    return file.write(json) == json.size();
+}
@@ -7,19 +7,39 @@
 #include <quazip/quazip.h>
 #include <quazip/quazipfile.h>
 
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+#include <utility>
+#include <vector>
+
 #include <QDateTime>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonArray>
 #include <QJsonDocument>
+#include <QSaveFile>
+#include <QTemporaryFile>
 
+#include <rpgmapper/json/cbor_writer.hpp>
+#include <rpgmapper/json/json_text_writer.hpp>
+#include <rpgmapper/resource/blob_store.hpp>
 #include <rpgmapper/resource/resource.hpp>
 #include <rpgmapper/resource/resource_collection.hpp>
 #include <rpgmapper/resource/resource_db.hpp>
 #include <rpgmapper/resource/resource_loader.hpp>
 #include <rpgmapper/atlas.hpp>
+#include <rpgmapper/map.hpp>
+#include <rpgmapper/region.hpp>
+#include <rpgmapper/trace.hpp>
 
-#include "content.hpp"
+#include "digest_device.hpp"
 #include "zip.hpp"
 
 using namespace rpgmapper::model;
+using namespace rpgmapper::model::json;
 using namespace rpgmapper::model::resource;
 
 // TODO: remove when done
@@ -33,23 +53,75 @@ using namespace rpgmapper::model::resource;
 
 
 /**
- * Adds all atlas local resources to the content.
+ * Folder in the zip holding the local resource BLOBs named by their SHA-256.
+ */
+static QString const BLOB_FOLDER = "blobs/";
+
+/**
+ * Index of the local resources: resource path to SHA-256 of the BLOB.
+ */
+static QString const RESOURCE_INDEX = "resources.json";
+
+/**
+ * Folder in the zip holding the maps, each in an entry of its own.
+ */
+static QString const MAP_FOLDER = "maps/";
+
+/**
+ * Index of the maps: region, name, entry and size of each map.
+ */
+static QString const MAP_INDEX = "maps.json";
+
+/**
+ * Number of bytes inflated between two progress reports.
+ */
+static qint64 const READ_CHUNK_SIZE = 1024 * 1024;
+
+
+/**
+ * The state of streaming the entries of an atlas file into their consumers.
+ */
+struct AtlasReadState {
+    AtlasContent & content;                     /**< The content read. */
+    bool atlasFound = false;                    /**< The atlas.json has been read. */
+    bool indexFound = false;                    /**< The resource index has been read. */
+    QHash<QString, QStringList> pathsByHash;    /**< Resource paths waiting for their BLOB. */
+    QHash<QString, QByteArray> pendingBlobs;    /**< BLOBs read before the index. */
+    QJsonArray mapIndex;                        /**< The map index read. */
+    QHash<QString, MapEntry> mapEntries;        /**< The map entries found (not inflated). */
+};
+
+
+/**
+ * A map written to an atlas file.
+ */
+struct StoredMap {
+    MapPointer map;                             /**< The map written. */
+    MapEntry entry;                             /**< The entry written. */
+    QByteArray digest;                          /**< Digest of the map data written (if loaded). */
+};
+
+
+/**
+ * Creates a local resource and adds it to the content read.
  *
- * @param   content     the content to collect the local resources.
+ * @param   content     the content read.
+ * @param   path        the resource path.
+ * @param   data        the BLOB of the resource.
  * @param   log         protocol of actions.
  */
-static void addLocalResourcesToContent(Content & content, QStringList & log);
+static void addLocalResource(AtlasContent & content, QString const & path, QByteArray const & data, QStringList & log);
 
 
 /**
- * Appends some content to an opened zip.
+ * Appends the atlas.json to a zip: the atlas and its regions, the maps are stored on their own.
  *
- * @param   content     the content to add.
+ * @param   atlas       the atlas to write.
  * @param   zip         the zip structure to fill.
  * @param   log         protocol of actions.
  * @return  true, if successfully added
  */
-static bool appendContentToZip(Content const & content, QuaZip & zip, QStringList & log);
+static bool appendAtlasToZip(AtlasPointer const & atlas, QuaZip & zip, QStringList & log);
 
 
 /**
@@ -64,6 +136,59 @@ static bool appendContentToZip(Content const & content, QuaZip & zip, QStringLis
 static bool appendFileToZip(QString const & name, QByteArray const & blob, QuaZip & zip, QStringList & log);
 
 
+/**
+ * Appends the local resources to a zip: the resource index first, then the BLOBs.
+ *
+ * Each distinct BLOB is added once, named by its hash. If an external blob store is set,
+ * the BLOBs are put there instead and the atlas refers to them only.
+ *
+ * @param   zip         the zip structure to fill.
+ * @param   log         protocol of actions.
+ * @return  true, if successfully added
+ */
+static bool appendLocalResourcesToZip(QuaZip & zip, QStringList & log);
+
+
+/**
+ * Appends the entry of a single map to a zip.
+ *
+ * @param   storedMap   the map and its entry to write, receives the size written.
+ * @param   write       writes the map data to the device given (false, if the map data is not at hand).
+ * @param   zip         the zip structure to fill.
+ * @param   written     set, if the map data has been written completely.
+ * @param   log         protocol of actions.
+ * @return  true, if the zip is still intact (even if the map data has not been written).
+ */
+static bool appendMapEntryToZip(StoredMap & storedMap,
+        std::function<bool(DigestDevice &)> const & write,
+        QuaZip & zip,
+        bool & written,
+        QStringList & log);
+
+
+/**
+ * Appends all maps of an atlas to a zip, each map as an entry of its own, followed by the map index.
+ *
+ * Loaded maps are streamed into their entry. Maps not loaded are copied from their entry
+ * as they are, a chunk at a time. If copying fails, the map is loaded and written from
+ * memory instead. A map failing both is reported and left out, the others are still written.
+ *
+ * @param   atlas       the atlas to write.
+ * @param   fileName    the atlas file the entries will be found in.
+ * @param   zip         the zip structure to fill.
+ * @param   stored      collects the maps written and their new entries.
+ * @param   leftOut     collects the maps left out.
+ * @param   log         protocol of actions.
+ * @return  true, if the zip has been written (false only if writing the zip failed).
+ */
+static bool appendMapsToZip(AtlasPointer const & atlas,
+        QString const & fileName,
+        QuaZip & zip,
+        std::vector<StoredMap> & stored,
+        std::vector<MapPointer> & leftOut,
+        QStringList & log);
+
+
 /**
  * Closes a zipfile.
  *
@@ -77,22 +202,37 @@ static void closeZip(QuaZip & zip, QStringList & log);
  * Creates an atlas from a loaded content.
  *
  * @param   atlas           the atlas to be created.
- * @param   content         the loaded content.
+ * @param   json            the atlas.json loaded.
  * @param   log             the protocol.
  * @return  true, for a successful loaded atlas.
  */
-static bool createAtlasFromContent(AtlasPointer & atlas, Content const & content, QStringList & log);
+static bool createAtlasFromJSON(AtlasPointer & atlas, QJsonDocument const & json, QStringList & log);
 
 
 /**
- * Creates an atlas from a loaded content.
+ * Closes a zip entry written.
  *
- * @param   atlas           the atlas to be created.
- * @param   json            the atlas.json loaded.
- * @param   log             the protocol.
- * @return  true, for a successful loaded atlas.
+ * @param   zf          the zip entry written.
+ * @param   name        the name of the entry.
+ * @param   log         protocol of actions.
+ * @return  true, if the entry has been written completely.
  */
-static bool createAtlasFromJSON(AtlasPointer & atlas, QJsonDocument const & json, QStringList & log);
+static bool closeEntry(QuaZipFile & zf, QString const & name, QStringList & log);
+
+
+/**
+ * Copies a map entry of another atlas file as it is, a chunk at a time.
+ *
+ * @param   entry       the map entry to copy.
+ * @param   sources     the atlas files opened so far (by file name).
+ * @param   target      the device to copy to.
+ * @param   log         protocol of actions.
+ * @return  true, if the map entry has been copied.
+ */
+static bool copyMapEntry(MapEntry const & entry,
+        std::map<QString, std::unique_ptr<QuaZip>> & sources,
+        QIODevice & target,
+        QStringList & log);
 
 
 /**
@@ -104,22 +244,74 @@ static QJsonDocument createMetaInformation();
 
 
 /**
- * Extracts the content (a set of named blobs) from the zip.
+ * Hands a zip entry read to its consumer.
  *
- * @param   zip         the zip to extract from.
- * @param   content     the content to fill.
+ * @param   state       the state of reading the atlas file.
+ * @param   name        the name of the entry.
+ * @param   blob        the inflated entry.
  * @param   log         protocol of actions.
- * @return  true, for success.
  */
-static bool extractContentFromZip(QuaZip & zip, Content & content, QStringList & log);
+static void consumeEntry(AtlasReadState & state, QString const & name, QByteArray const & blob, QStringList & log);
+
+
+/**
+ * Creates the local resources of a BLOB, if the index lists it.
+ *
+ * @param   state       the state of reading the atlas file.
+ * @param   hash        the SHA-256 of the BLOB.
+ * @param   blob        the BLOB.
+ * @param   log         protocol of actions.
+ * @return  true, if the index lists the BLOB.
+ */
+static bool consumeBlob(AtlasReadState & state, QString const & hash, QByteArray const & blob, QStringList & log);
+
+
+/**
+ * Takes the BLOBs listed in the index, but not part of the atlas file, from the external blob store.
+ *
+ * @param   state       the state of reading the atlas file.
+ * @param   log         protocol of actions.
+ */
+static void consumeExternalBlobs(AtlasReadState & state, QStringList & log);
+
+
+/**
+ * Remembers a map entry found without inflating it.
+ *
+ * @param   state       the state of reading the atlas file.
+ * @param   zip         the zip positioned at the map entry.
+ * @param   name        the name of the entry.
+ */
+static void consumeMapEntry(AtlasReadState & state, QuaZip & zip, QString const & name);
+
+
+/**
+ * Adds the maps of the map index to the content, with the position of their entries.
+ *
+ * @param   state       the state of reading the atlas file.
+ * @param   log         protocol of actions.
+ */
+static void consumeMapIndex(AtlasReadState & state, QStringList & log);
+
+
+/**
+ * Positions a zip at the entry of a map.
+ *
+ * @param   zip         the zip opened for reading.
+ * @param   entry       the map entry to go to.
+ * @return  true, if the entry has been found.
+ */
+static bool goToMapEntry(QuaZip & zip, MapEntry const & entry);
+
 
 /**
- * Loads the local resources from the content.
+ * Reads the resource index and creates the resources of the BLOBs read so far.
  *
- * @param   content     the content loaded.
- * @param   log         protocol of actions
+ * @param   state       the state of reading the atlas file.
+ * @param   blob        the resource index.
+ * @param   log         protocol of actions.
  */
-static void loadLocalResources(Content const & content, QStringList & log);
+static void consumeIndex(AtlasReadState & state, QByteArray const & blob, QStringList & log);
 
 /**
  * Opens a zip file for reading.
@@ -132,61 +324,308 @@ static void loadLocalResources(Content const & content, QStringList & log);
 static bool openZipForReading(QuaZip & zip, QFile & file, QStringList & log);
 
 
+/**
+ * Inflates the current zip entry.
+ *
+ * @param   zip         the zip to read from.
+ * @param   name        receives the name of the entry.
+ * @param   blob        receives the entry.
+ * @param   progress    reports progress and may cancel the read (may be empty).
+ * @param   done        number of entries read so far.
+ * @param   total       total number of entries.
+ * @param   log         protocol of actions.
+ * @return  true, for success (false, if cancelled).
+ */
+static bool readEntry(QuaZip & zip,
+        QString & name,
+        QByteArray & blob,
+        AtlasReadProgress const & progress,
+        int done,
+        int total,
+        QStringList & log);
+
+
+/**
+ * Reads a single map from its entry, as it is.
+ *
+ * @param   data        receives the map data.
+ * @param   entry       the entry of the map.
+ * @param   log         protocol of actions.
+ * @return  true, for success.
+ */
+static bool readMapData(QByteArray & data, MapEntry const & entry, QStringList & log);
+
+
+/**
+ * Replaces a file in a single step with the content of another, a chunk at a time.
+ *
+ * @param   source      the file holding the new content (read from its start).
+ * @param   fileName    the file to replace.
+ * @param   log         protocol of actions.
+ * @return  true, if the file has been replaced.
+ */
+static bool replaceFile(QFile & source, QString const & fileName, QStringList & log);
+
+
+/**
+ * Opens a new entry of a zip for writing.
+ *
+ * @param   zf          the zip entry.
+ * @param   name        the name of the entry.
+ * @param   log         protocol of actions.
+ * @return  true, if the entry has been opened.
+ */
+static bool openEntryForWriting(QuaZipFile & zf, QString const & name, QStringList & log);
+
+
 /**
  * Opens a zip file for writing.
  *
  * @param   zip     Zip file functions class.
- * @param   file    the file to open.
+ * @param   file    the file to open (QuaZip closes it along with the zip).
  * @param   log     Huamn Readable logs (appended).
  * @return  true, for successful close.
  */
-static bool openZipForWriting(QuaZip & zip, QFile & file, QStringList & log);
+static bool openZipForWriting(QuaZip & zip, QFileDevice & file, QStringList & log);
+
+
+void addLocalResource(AtlasContent & content, QString const & path, QByteArray const & data, QStringList & log) {
+    auto resource = ResourceLoader::createResource(path, data, log);
+    if (resource) {
+        content.resources.push_back(resource);
+        log.append(QString{"Added : "} + path);
+    }
+}
+
 
+bool appendAtlasToZip(AtlasPointer const & atlas, QuaZip & zip, QStringList & log) {
+    
+    QuaZipFile zf(&zip);
+    if (!openEntryForWriting(zf, "atlas.json", log)) {
+        return false;
+    }
+    
+    JSONTextWriter writer{&zf};
+    writer.beginObject();
+    writer.writeKey("name");
+    writer.writeString(atlas->getName());
+    writer.writeKey("regions");
+    writer.beginArray();
+    for (auto const & pair : atlas->getRegions()) {
+        writer.beginObject();
+        writer.writeKey("name");
+        writer.writeString(pair.second->getName());
+        writer.endObject();
+    }
+    writer.endArray();
+    writer.endObject();
+    
+    return closeEntry(zf, "atlas.json", log);
+}
 
-void addLocalResourcesToContent(Content & content, QStringList & log) {
+
+bool appendFileToZip(QString const & name, QByteArray const & blob, QuaZip & zip, QStringList & log) {
+    
+    QuaZipFile zf(&zip);
+    if (!openEntryForWriting(zf, name, log)) {
+        return false;
+    }
+    
+    bool res = (zf.write(blob.data(), blob.size()) == blob.size());
+    if (!res) {
+        log.append(QString{"Failed to write sub file '"} + name + "'.");
+    }
+    
+    return closeEntry(zf, name, log) && res;
+}
+
+
+bool appendLocalResourcesToZip(QuaZip & zip, QStringList & log) {
 
     log.append("Adding local resources.");
+    
+    QuaZipFile zf(&zip);
+    if (!openEntryForWriting(zf, RESOURCE_INDEX, log)) {
+        return false;
+    }
+    
+    // the BLOBs are referred to only: they are written once the index is complete
+    std::set<QString> hashes;
+    std::vector<std::pair<QString, ResourcePointer>> blobs;
     auto localResources = ResourceDB::getLocalResources();
+    JSONTextWriter writer{&zf};
+    writer.beginObject();
+    writer.writeKey("resources");
+    writer.beginArray();
     for (auto const & pair : localResources->getResources()) {
+        
         auto resource = pair.second;
-        log.append(QString{"Adding: "} + resource->getName());
-        content[resource->getName()] = resource->getData();
+        auto hash = resource->getHash();
+        writer.beginObject();
+        writer.writeKey("path");
+        writer.writeString(resource->getPath());
+        writer.writeKey("sha256");
+        writer.writeString(hash);
+        writer.endObject();
+        
+        if (!hashes.insert(hash).second) {
+            log.append(QString{"Sharing: "} + resource->getPath());
+        }
+        else
+        if (BlobStore::write(hash, resource->getData())) {
+            log.append(QString{"Stored: "} + resource->getPath() + " in external blob store.");
+        }
+        else {
+            log.append(QString{"Adding: "} + resource->getPath());
+            blobs.emplace_back(hash, resource);
+        }
+    }
+    writer.endArray();
+    writer.endObject();
+    if (!closeEntry(zf, RESOURCE_INDEX, log)) {
+        return false;
+    }
+    
+    bool res = true;
+    for (auto iter = blobs.begin(); (iter != blobs.end()) && res; ++iter) {
+        res = appendFileToZip(BLOB_FOLDER + (*iter).first, (*iter).second->getData(), zip, log);
     }
+    
+    return res;
 }
 
 
-bool appendContentToZip(Content const & content, QuaZip & zip, QStringList & log) {
+bool appendMapEntryToZip(StoredMap & storedMap,
+        std::function<bool(DigestDevice &)> const & write,
+        QuaZip & zip,
+        bool & written,
+        QStringList & log) {
+    
+    written = false;
+    QuaZipFile zf(&zip);
+    if (!openEntryForWriting(zf, storedMap.entry.entryName, log)) {
+        return false;
+    }
+    
+    DigestDevice device{&zf};
+    written = write(device);
+    storedMap.entry.size = device.getWritten();
     
+    return closeEntry(zf, storedMap.entry.entryName, log);
+}
+
+
+bool appendMapsToZip(AtlasPointer const & atlas,
+        QString const & fileName,
+        QuaZip & zip,
+        std::vector<StoredMap> & stored,
+        std::vector<MapPointer> & leftOut,
+        QStringList & log) {
+    
+    std::map<QString, std::unique_ptr<QuaZip>> sources;
     bool res = true;
-    for (auto const & pair : content) {
-        res = appendFileToZip(pair.first, pair.second, zip, log);
+    int number = 0;
+    for (auto const & regionPair : atlas->getRegions()) {
+        for (auto const & mapPair : regionPair.second->getMaps()) {
+            
+            auto map = mapPair.second;
+            StoredMap storedMap;
+            storedMap.map = map;
+            storedMap.entry.regionName = regionPair.second->getName();
+            storedMap.entry.mapName = map->getName();
+            storedMap.entry.fileName = fileName;
+            
+            // a failed attempt leaves an entry no index refers to: each attempt writes an entry of its own
+            bool written = false;
+            if (!map->isLoaded()) {
+                
+                // maps not loaded keep their format: older atlas files hold JSON text
+                auto suffix = QFileInfo{map->getEntry().entryName}.suffix();
+                storedMap.entry.entryName = MAP_FOLDER + QString::number(number++) + "." + suffix;
+                auto copy = [&] (DigestDevice & device) {
+                    return copyMapEntry(map->getEntry(), sources, device, log);
+                };
+                res = appendMapEntryToZip(storedMap, copy, zip, written, log);
+                if (res && !written) {
+                    log.append(QString{"Failed to copy map: "} + storedMap.entry.mapName + ", loading it instead.");
+                    map->load(log);
+                }
+            }
+            if (res && !written && map->isLoaded()) {
+                
+                storedMap.entry.entryName = MAP_FOLDER + QString::number(number++) + ".cbor";
+                auto stream = [&] (DigestDevice & device) {
+                    CBORWriter writer{&device};
+                    map->writeJSON(writer);
+                    storedMap.digest = device.getDigest();
+                    return true;
+                };
+                res = appendMapEntryToZip(storedMap, stream, zip, written, log);
+            }
+            if (!res) {
+                log.append(QString{"Failed to add map: "} + storedMap.entry.mapName);
+                break;
+            }
+            if (!written) {
+                log.append(QString{"Failed to add map: "} + storedMap.entry.mapName + ", it is left out.");
+                leftOut.push_back(map);
+                continue;
+            }
+            
+            stored.push_back(storedMap);
+            log.append(QString{"Added map: "} + storedMap.entry.mapName);
+        }
         if (!res) {
             break;
         }
     }
     
-    return res;
+    for (auto & pair : sources) {
+        if (pair.second) {
+            closeZip(*pair.second, log);
+        }
+    }
+    if (!res) {
+        return false;
+    }
+    
+    // the index goes last, as it holds the size of each map entry
+    QuaZipFile zf(&zip);
+    if (!openEntryForWriting(zf, MAP_INDEX, log)) {
+        return false;
+    }
+    JSONTextWriter writer{&zf};
+    writer.beginObject();
+    writer.writeKey("maps");
+    writer.beginArray();
+    for (auto const & storedMap : stored) {
+        writer.beginObject();
+        writer.writeKey("region");
+        writer.writeString(storedMap.entry.regionName);
+        writer.writeKey("name");
+        writer.writeString(storedMap.entry.mapName);
+        writer.writeKey("entry");
+        writer.writeString(storedMap.entry.entryName);
+        writer.writeKey("size");
+        writer.writeDouble(static_cast<double>(storedMap.entry.size));
+        writer.endObject();
+    }
+    writer.endArray();
+    writer.endObject();
+    
+    return closeEntry(zf, MAP_INDEX, log);
 }
 
 
-bool appendFileToZip(QString const & name, QByteArray const & blob, QuaZip & zip, QStringList & log) {
+bool closeEntry(QuaZipFile & zf, QString const & name, QStringList & log) {
     
-    QuaZipFile zf(&zip);
-    QuaZipNewInfo zfi(name);
-    constexpr QFile::Permissions permissions = QFile::ReadOwner |
-                                               QFile::WriteOwner |
-                                               QFile::ReadGroup |
-                                               QFile::WriteGroup |
-                                               QFile::ReadOther;
-    zfi.setPermissions(permissions);
-
-    bool res = zf.open(QIODevice::WriteOnly, zfi);
+    zf.close();
+    bool res = (zf.getZipError() == ZIP_OK);
     if (!res) {
-        log.append(QString{"Failed to write sub file '"} + zf.getActualFileName() + "'.");
+        log.append(QString{"Failed to write sub file '"} + name + "'.");
     }
     else {
-        zf.write(blob.data(), blob.size());
-        log.append(QString{"Written sub file '"} + zf.getActualFileName() + "'.");
+        log.append(QString{"Written sub file '"} + name + "'.");
     }
     
     return res;
@@ -199,19 +638,135 @@ void closeZip(QuaZip & zip, QStringList & log) {
 }
 
 
-bool createAtlasFromContent(AtlasPointer & atlas, Content const & content, QStringList & log) {
+bool consumeBlob(AtlasReadState & state, QString const & hash, QByteArray const & blob, QStringList & log) {
+    
+    auto iter = state.pathsByHash.find(hash);
+    if (iter == state.pathsByHash.end()) {
+        return false;
+    }
     
-    bool res;
+    for (auto const & path : *iter) {
+        addLocalResource(state.content, path, blob, log);
+    }
+    state.pathsByHash.erase(iter);
+    return true;
+}
+
+
+void consumeEntry(AtlasReadState & state, QString const & name, QByteArray const & blob, QStringList & log) {
     
-    if (content.find("atlas.json") == content.end()) {
-        res = false;
-        log.append("Atlas json not found in file.");
+    if (name == "atlas.json") {
+        auto json = QJsonDocument::fromJson(blob);
+        if (json.isObject()) {
+            state.content.atlas = json.object();
+            state.atlasFound = true;
+        }
+        else {
+            log.append("Contained atlas not an JSON object. Corrupted? Unable to load.");
+        }
+    }
+    else
+    if (name == "meta.json") {
+        log.append("Found: " + name);
+    }
+    else
+    if (name == RESOURCE_INDEX) {
+        consumeIndex(state, blob, log);
+    }
+    else
+    if (name == MAP_INDEX) {
+        state.mapIndex = QJsonDocument::fromJson(blob).object()["maps"].toArray();
+    }
+    else
+    if (name.startsWith(BLOB_FOLDER)) {
+        auto hash = name.mid(BLOB_FOLDER.size());
+        if (!state.indexFound) {
+            state.pendingBlobs.insert(hash, blob);
+        }
+        else
+        if (!consumeBlob(state, hash, blob, log)) {
+            log.append("Unreferenced BLOB: " + name);
+        }
     }
     else {
-        res = createAtlasFromJSON(atlas, QJsonDocument::fromJson(content.at("atlas.json")), log);
+        // files prior to the blob index hold the resources by path
+        addLocalResource(state.content, name, blob, log);
     }
+}
+
+
+void consumeExternalBlobs(AtlasReadState & state, QStringList & log) {
     
-    return res;
+    for (auto const & hash : state.pathsByHash.keys()) {
+        auto blob = BlobStore::read(hash);
+        if (blob.isEmpty()) {
+            for (auto const & path : state.pathsByHash[hash]) {
+                log.append(QString{"Missing BLOB for: "} + path);
+            }
+            continue;
+        }
+        consumeBlob(state, hash, blob, log);
+    }
+}
+
+
+void consumeMapEntry(AtlasReadState & state, QuaZip & zip, QString const & name) {
+    
+    MapEntry entry;
+    unz64_file_pos position;
+    if (unzGetFilePos64(zip.getUnzFile(), &position) == UNZ_OK) {
+        entry.positionKnown = true;
+        entry.directoryOffset = position.pos_in_zip_directory;
+        entry.entryNumber = position.num_of_file;
+    }
+    state.mapEntries.insert(name, entry);
+}
+
+
+void consumeMapIndex(AtlasReadState & state, QStringList & log) {
+    
+    for (auto const & value : state.mapIndex) {
+        
+        auto jsonEntry = value.toObject();
+        auto entryName = jsonEntry["entry"].toString();
+        auto iter = state.mapEntries.constFind(entryName);
+        if (iter == state.mapEntries.constEnd()) {
+            log.append(QString{"Missing map entry: "} + entryName);
+            continue;
+        }
+        
+        // the index is authoritative for region and name: maps are renamed without being loaded
+        MapEntry entry = *iter;
+        entry.regionName = jsonEntry["region"].toString();
+        entry.mapName = jsonEntry["name"].toString();
+        entry.fileName = state.content.fileName;
+        entry.entryName = entryName;
+        entry.size = static_cast<qint64>(jsonEntry["size"].toDouble());
+        state.content.maps.push_back(entry);
+    }
+    
+    log.append(QString{"Found %1 maps."}.arg(state.content.maps.size()));
+}
+
+
+void consumeIndex(AtlasReadState & state, QByteArray const & blob, QStringList & log) {
+    
+    log.append("Loading local resources.");
+    state.indexFound = true;
+    
+    auto index = QJsonDocument::fromJson(blob).object()["resources"].toArray();
+    for (auto const & value : index) {
+        auto entry = value.toObject();
+        state.pathsByHash[entry["sha256"].toString()].append(entry["path"].toString());
+    }
+    
+    // BLOBs of files written before the index has been moved to the front
+    for (auto iter = state.pendingBlobs.begin(); iter != state.pendingBlobs.end(); ++iter) {
+        if (!consumeBlob(state, iter.key(), iter.value(), log)) {
+            log.append("Unreferenced BLOB: " + BLOB_FOLDER + iter.key());
+        }
+    }
+    state.pendingBlobs.clear();
 }
 
 
@@ -240,6 +795,47 @@ bool createAtlasFromJSON(AtlasPointer & atlas, QJsonDocument const & json, QStri
 }
 
 
+bool copyMapEntry(MapEntry const & entry,
+        std::map<QString, std::unique_ptr<QuaZip>> & sources,
+        QIODevice & target,
+        QStringList & log) {
+    
+    auto & source = sources[entry.fileName];
+    if (!source) {
+        source.reset(new QuaZip);
+        QFile file{entry.fileName};
+        if (!openZipForReading(*source, file, log)) {
+            source.reset();
+            return false;
+        }
+    }
+    if (!goToMapEntry(*source, entry)) {
+        log.append(QString{"Map entry not found: "} + entry.entryName);
+        return false;
+    }
+    
+    QuaZipFile zf(source.get());
+    if (!zf.open(QIODevice::ReadOnly)) {
+        log.append(QString{"Failed to open map entry: "} + entry.entryName);
+        return false;
+    }
+    
+    QByteArray chunk;
+    chunk.resize(static_cast<int>(READ_CHUNK_SIZE));
+    bool res = true;
+    qint64 bytesRead = 0;
+    while (res && ((bytesRead = zf.read(chunk.data(), READ_CHUNK_SIZE)) != 0)) {
+        res = (bytesRead > 0) && (target.write(chunk.constData(), bytesRead) == bytesRead);
+    }
+    zf.close();
+    if (!res) {
+        log.append(QString{"Failed to copy map entry: "} + entry.entryName);
+    }
+    
+    return res;
+}
+
+
 static QJsonDocument createMetaInformation() {
     
     QJsonObject json;
@@ -260,50 +856,39 @@ static QJsonDocument createMetaInformation() {
 }
 
 
-bool extractContentFromZip(QuaZip & zip, Content & content, QStringList & log) {
+bool goToMapEntry(QuaZip & zip, MapEntry const & entry) {
     
-    QuaZipFileInfo zfi;
-    bool res = zip.getCurrentFileInfo(&zfi);
-    if (!res) {
-        log.append("Failed to get current sub file info.");
-    }
-    else {
-        
-        QuaZipFile zf(&zip);
-        res = zf.open(QIODevice::ReadOnly);
-        if (!res) {
-            log.append("Failed to open current sub file.");
-        }
-        else {
-            
-            QByteArray blob;
-            blob.resize(zfi.uncompressedSize);
-            zf.read(blob.data(), zfi.uncompressedSize);
-            
-            auto filenameInZip = zf.getActualFileName();
-            content.insert(std::make_pair(filenameInZip, blob));
-            log.append("Found: " + filenameInZip);
+    if (entry.positionKnown && zip.goToFirstFile()) {
+        unz64_file_pos position;
+        position.pos_in_zip_directory = entry.directoryOffset;
+        position.num_of_file = entry.entryNumber;
+        if ((unzGoToFilePos64(zip.getUnzFile(), &position) == UNZ_OK)
+                && (zip.getCurrentFileName() == entry.entryName)) {
+            return true;
         }
     }
     
-    return res;
+    // the atlas file has been written anew since: scan the central directory
+    return zip.setCurrentFile(entry.entryName);
 }
 
 
-void loadLocalResources(Content const & content, QStringList & log) {
+bool openEntryForWriting(QuaZipFile & zf, QString const & name, QStringList & log) {
     
-    log.append("Loading local resources.");
-    for (auto const & pair : content) {
-        
-        QString const & path = pair.first;
-        QByteArray const & data = pair.second;
-        
-        auto resource = ResourceLoader::createResource(path, data, log);
-        if (resource) {
-            ResourceDB::getLocalResources()->addResource(resource);
-            log.append(QString{"Added : "} + path);
-        }
+    QuaZipNewInfo zfi(name);
+    constexpr QFile::Permissions permissions = QFile::ReadOwner |
+                                               QFile::WriteOwner |
+                                               QFile::ReadGroup |
+                                               QFile::WriteGroup |
+                                               QFile::ReadOther;
+    zfi.setPermissions(permissions);
+    
+    bool res = zf.open(QIODevice::WriteOnly, zfi);
+    if (!res) {
+        log.append(QString{"Failed to write sub file '"} + name + "'.");
     }
+    
+    return res;
 }
 
 
@@ -325,13 +910,13 @@ bool openZipForReading(QuaZip & zip, QFile & file, QStringList & log) {
 }
 
 
-bool openZipForWriting(QuaZip & zip, QFile & file, QStringList & log) {
+bool openZipForWriting(QuaZip & zip, QFileDevice & file, QStringList & log) {
     
     bool res = true;
     
-    zip.setZipName(file.fileName());
+    zip.setIoDevice(&file);
     zip.setFileNameCodec("UTF-8");
-    if (!zip.open(QuaZip::mdCreate, nullptr)) {
+    if (!file.open(QIODevice::WriteOnly) || !zip.open(QuaZip::mdCreate, nullptr)) {
         res = false;
         log.append(QString{"Failed to create file '"} + file.fileName() + "' for compression.");
     }
@@ -344,23 +929,63 @@ bool openZipForWriting(QuaZip & zip, QFile & file, QStringList & log) {
 }
 
 
-bool rpgmapper::model::readAtlas(AtlasPointer & atlas, QFile & file, QStringList & log) {
+bool readEntry(QuaZip & zip,
+        QString & name,
+        QByteArray & blob,
+        AtlasReadProgress const & progress,
+        int done,
+        int total,
+        QStringList & log) {
+    
+    QuaZipFileInfo zfi;
+    if (!zip.getCurrentFileInfo(&zfi)) {
+        log.append("Failed to get current sub file info.");
+        return false;
+    }
+    
+    QuaZipFile zf(&zip);
+    if (!zf.open(QIODevice::ReadOnly)) {
+        log.append("Failed to open current sub file.");
+        return false;
+    }
+    name = zf.getActualFileName();
+    
+    // inflate right into the final buffer, a chunk at a time to stay cancellable
+    qint64 size = zfi.uncompressedSize;
+    blob.resize(static_cast<int>(size));
+    qint64 offset = 0;
+    while (offset < size) {
+        auto bytesRead = zf.read(blob.data() + offset, std::min(READ_CHUNK_SIZE, size - offset));
+        if (bytesRead <= 0) {
+            log.append("Failed to read sub file " + name + ".");
+            return false;
+        }
+        offset += bytesRead;
+        if (progress && (offset < size) && !progress(done, total)) {
+            return false;
+        }
+    }
     
+    return true;
+}
+
+
+bool readMapData(QByteArray & data, MapEntry const & entry, QStringList & log) {
+    
+    QFile file{entry.fileName};
     QuaZip zip;
     bool res = openZipForReading(zip, file, log);
     if (res) {
-    
-        Content content;
-        for (auto filePresent = zip.goToFirstFile(); filePresent && res; filePresent = zip.goToNextFile()) {
-            res = extractContentFromZip(zip, content, log);
+        
+        res = goToMapEntry(zip, entry);
+        if (!res) {
+            log.append(QString{"Map entry not found: "} + entry.entryName);
         }
-    
-        if (res) {
-            res = createAtlasFromContent(atlas, content, log);
+        else {
+            QString name;
+            res = readEntry(zip, name, data, AtlasReadProgress{}, 0, 0, log);
         }
         
-        loadLocalResources(content, log);
-        
         closeZip(zip, log);
     }
     
@@ -368,28 +993,174 @@ bool rpgmapper::model::readAtlas(AtlasPointer & atlas, QFile & file, QStringList
 }
 
 
-bool rpgmapper::model::writeAtlas(AtlasPointer const & atlas, QFile & file, QStringList & log) {
+bool replaceFile(QFile & source, QString const & fileName, QStringList & log) {
     
-    QuaZip zip;
+    QSaveFile target{fileName};
+    bool res = (source.isOpen() || source.open(QIODevice::ReadOnly))
+            && source.seek(0)
+            && target.open(QIODevice::WriteOnly);
+    while (res && !source.atEnd()) {
+        auto chunk = source.read(READ_CHUNK_SIZE);
+        res = !chunk.isEmpty() && (target.write(chunk) == chunk.size());
+    }
+    source.close();
+    
+    // not committed, the save file is discarded and the file stays as it is
+    res = res && target.commit();
+    if (!res) {
+        log.append(QString{"Failed to replace file '"} + fileName + "'.");
+    }
     
-    bool res = openZipForWriting(zip, file, log);
+    return res;
+}
+
+
+bool rpgmapper::model::createAtlas(AtlasPointer & atlas, AtlasContent const & content, QStringList & log) {
+    
+    QJsonDocument json;
+    json.setObject(content.atlas);
+    bool res = createAtlasFromJSON(atlas, json, log);
+    
+    // maps stored on their own are loaded when accessed first
+    for (auto const & entry : content.maps) {
+        
+        RegionPointer region;
+        auto iter = atlas->getRegions().find(entry.regionName);
+        if (iter != atlas->getRegions().end()) {
+            region = (*iter).second;
+        }
+        else {
+            region = RegionPointer{new Region{entry.regionName}};
+            atlas->addRegion(region);
+        }
+        
+        auto map = MapPointer{new Map{entry.mapName}};
+        map->setEntry(entry);
+        region->addMap(map);
+    }
+    
+    for (auto const & resource : content.resources) {
+        atlas->getResources()->addResource(resource);
+    }
+    
+    return res;
+}
+
+
+bool rpgmapper::model::readMap(QByteArray & data, MapEntry const & entry, QStringList & log) {
+    RPGMAPPER_TRACE_SCOPE("readMap");
+    return readMapData(data, entry, log);
+}
+
+
+bool rpgmapper::model::readAtlas(AtlasPointer & atlas, QFile & file, QStringList & log) {
+    RPGMAPPER_TRACE_SCOPE("readAtlas");
+    
+    AtlasContent content;
+    bool res = readAtlasContent(content, file, AtlasReadProgress{}, log);
     if (res) {
+        res = createAtlas(atlas, content, log);
+    }
+    
+    return res;
+}
+
+
+bool rpgmapper::model::readAtlasContent(AtlasContent & content,
+        QFile & file,
+        AtlasReadProgress const & progress,
+        QStringList & log) {
     
-        Content content;
-        auto metaJson = createMetaInformation();
-        content["meta.json"] = metaJson.toJson(QJsonDocument::Compact);
-        log.append("Added: meta.json.");
+    RPGMAPPER_TRACE_SCOPE("readAtlasContent");
+    
+    QuaZip zip;
+    bool res = openZipForReading(zip, file, log);
+    if (res) {
         
-        QJsonDocument json;
-        json.setObject(atlas->getJSON());
-        content["atlas.json"] = json.toJson(QJsonDocument::Compact);
-        log.append("Added: atlas.json.");
+        content.fileName = QFileInfo{file}.absoluteFilePath();
+        AtlasReadState state{content};
+        auto total = zip.getEntriesCount();
+        int done = 0;
+        for (auto filePresent = zip.goToFirstFile(); filePresent && res; filePresent = zip.goToNextFile()) {
+            
+            if (progress && !progress(done, total)) {
+                res = false;
+                break;
+            }
+            
+            // maps are not inflated: they are loaded from their entry when needed
+            QString name = zip.getCurrentFileName();
+            if (name.startsWith(MAP_FOLDER)) {
+                consumeMapEntry(state, zip, name);
+                ++done;
+                continue;
+            }
+            
+            QByteArray blob;
+            res = readEntry(zip, name, blob, progress, done, total, log);
+            if (res) {
+                consumeEntry(state, name, blob, log);
+                ++done;
+            }
+        }
         
-        addLocalResourcesToContent(content, log);
+        if (res) {
+            consumeExternalBlobs(state, log);
+            consumeMapIndex(state, log);
+            if (!state.atlasFound) {
+                res = false;
+                log.append("Atlas json not found in file.");
+            }
+            if (progress) {
+                progress(done, total);
+            }
+        }
         
-        res = appendContentToZip(content, zip, log);
         closeZip(zip, log);
     }
     
     return res;
 }
+
+
+bool rpgmapper::model::writeAtlas(AtlasPointer const & atlas, QFile & file, QStringList & log) {
+    RPGMAPPER_TRACE_SCOPE("writeAtlas");
+    
+    // maps not loaded are copied from their file, which may be the very file written:
+    // so the zip is written to a temporary file next to it, which replaces it when complete
+    // (QuaZip closes the device it writes to, which must not happen to a QSaveFile)
+    auto fileName = QFileInfo{file}.absoluteFilePath();
+    QTemporaryFile zipFile{fileName + ".XXXXXX"};
+    
+    QuaZip zip;
+    bool res = openZipForWriting(zip, zipFile, log);
+    if (!res) {
+        return false;
+    }
+    
+    // each entry is streamed into the zip as it is created, nothing is collected up front;
+    // the resource index precedes the BLOBs, so readers stream the BLOBs straight into resources
+    std::vector<StoredMap> stored;
+    std::vector<MapPointer> leftOut;
+    res = appendFileToZip("meta.json", createMetaInformation().toJson(QJsonDocument::Compact), zip, log)
+            && appendAtlasToZip(atlas, zip, log)
+            && appendLocalResourcesToZip(zip, log)
+            && appendMapsToZip(atlas, fileName, zip, stored, leftOut, log);
+    closeZip(zip, log);
+    if (!res || (zip.getZipError() != ZIP_OK) || !replaceFile(zipFile, fileName, log)) {
+        return false;
+    }
+    
+    for (auto const & storedMap : stored) {
+        storedMap.map->setStored(storedMap.entry, storedMap.digest);
+    }
+    
+    // the entry names of the file replaced are taken by other maps now
+    for (auto const & map : leftOut) {
+        if (map->getEntry().fileName == fileName) {
+            map->setEntry(MapEntry{});
+        }
+    }
+    
+    return true;
+}
@@ -7,15 +7,31 @@
 #ifndef RPGMAPPER_MODEL_ZIP_HPP
 #define RPGMAPPER_MODEL_ZIP_HPP
 
+#include <QByteArray>
 #include <QFile>
+#include <QJsonObject>
 #include <QStringList>
 
+#include <rpgmapper/atlas_content.hpp>
 #include <rpgmapper/atlas_pointer.hpp>
 
 
 namespace rpgmapper::model {
 
 
+/**
+ * Creates an atlas from the content of an atlas file.
+ *
+ * This creates QObjects and has to run on the thread owning the atlas (the GUI thread).
+ *
+ * @param   atlas       the atlas to fill.
+ * @param   content     the content read by readAtlasContent().
+ * @param   log         Huamn Readable logs (appended).
+ * @return  true, for a successfully created atlas.
+ */
+bool createAtlas(AtlasPointer & atlas, AtlasContent const & content, QStringList & log);
+
+
 /**
  * Read an atlas from a file.
  *
@@ -27,9 +43,49 @@ namespace rpgmapper::model {
 bool readAtlas(AtlasPointer & atlas, QFile & file, QStringList & log);
 
 
+/**
+ * Reads the content of an atlas file.
+ *
+ * Each zip entry is inflated once and handed straight to its consumer: the atlas.json is
+ * parsed and local resources are created as their BLOBs arrive. No QObject is created,
+ * so this may run on a worker thread.
+ *
+ * @param   content     the content read.
+ * @param   file        the file to read.
+ * @param   progress    reports progress and may cancel the read (may be empty).
+ * @param   log         Huamn Readable logs (appended).
+ * @return  true, for successful read (false, if cancelled).
+ */
+bool readAtlasContent(AtlasContent & content, QFile & file, AtlasReadProgress const & progress, QStringList & log);
+
+
+/**
+ * Reads a single map from its entry in an atlas file.
+ *
+ * Only this entry is inflated: the entry is found by its position in the zip central
+ * directory (or by its name, if the atlas file has been written anew since).
+ *
+ * The data is CBOR for entries ending in ".cbor" and JSON text for older ".json" entries.
+ *
+ * @param   data        the map data read.
+ * @param   entry       the entry of the map.
+ * @param   log         Huamn Readable logs (appended).
+ * @return  true, for successful read.
+ */
+bool readMap(QByteArray & data, MapEntry const & entry, QStringList & log);
+
+
 /**
  * Writes an atlas to a file.
  *
+ * Each map goes to an entry of its own, listed by a map index. Maps not loaded are
+ * copied from their entry without being loaded. A map whose entry cannot be copied is
+ * loaded instead. A map failing both is reported and left out, the rest is still written.
+ *
+ * All entries are streamed into the zip as they are serialized, so the memory needed
+ * does not grow with the atlas. The file is replaced only once it has been written
+ * completely.
+ *
  * @param   atlas   The atlas to write.
  * @param   file    the file to write.
  * @param   log     Huamn Readable logs (appended).
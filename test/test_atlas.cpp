@@ -8,7 +8,13 @@
 
 #include <gtest/gtest.h>
 
+#include <QBuffer>
+#include <QJsonDocument>
+
+#include <rpgmapper/json/json_text_writer.hpp>
 #include <rpgmapper/atlas.hpp>
+#include <rpgmapper/map.hpp>
+#include <rpgmapper/region.hpp>
 
 using namespace rpgmapper::model;
 
@@ -28,3 +34,22 @@ TEST(AtlasTest, AtlasNameSet) {
     atlas.setName("bar");
     EXPECT_EQ(atlas.getName().toStdString(), "bar");
 }
+
+
+TEST(AtlasTest, AtlasStreamsJSONText) {
+    
+    auto atlas = AtlasPointer{new Atlas{"foo"}};
+    auto region = RegionPointer{new Region{"Dungeon \"deep\"\n\t\u00e4"}};
+    atlas->addRegion(region);
+    region->addMap(MapPointer{new Map{"bar"}});
+    
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    json::JSONTextWriter writer{&buffer};
+    atlas->writeJSON(writer);
+    
+    QJsonParseError error;
+    auto document = QJsonDocument::fromJson(buffer.data(), &error);
+    ASSERT_EQ(error.error, QJsonParseError::NoError);
+    EXPECT_EQ(document.object(), atlas->getJSON());
+}
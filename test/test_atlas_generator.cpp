@@ -0,0 +1,129 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <rpgmapper/layer/tile_layer.hpp>
+#include <rpgmapper/resource/resource_loader.hpp>
+#include <rpgmapper/atlas.hpp>
+#include <rpgmapper/atlas_generator.hpp>
+#include <rpgmapper/coordinate_system.hpp>
+#include <rpgmapper/map.hpp>
+#include <rpgmapper/region.hpp>
+#include <rpgmapper/session.hpp>
+
+using namespace rpgmapper::model;
+using namespace rpgmapper::model::resource;
+
+
+/**
+ * Collects the field indices of all base layers of all maps of an atlas.
+ *
+ * @param   atlas       the atlas.
+ * @return  the field indices in order of regions, maps and layers.
+ */
+static std::vector<int> collectBaseFields(AtlasPointer const & atlas) {
+    std::vector<int> fields;
+    for (auto const & region : atlas->getRegions()) {
+        for (auto const & map : region.second->getMaps()) {
+            for (auto const & layer : map.second->getLayers().getBaseLayers()) {
+                for (auto const & field : layer->getFields()) {
+                    fields.push_back(field.first);
+                }
+            }
+        }
+    }
+    return fields;
+}
+
+
+/**
+ * Counts the shape tiles on all tile layers of all maps of an atlas.
+ *
+ * @param   atlas       the atlas.
+ * @return  the number of tiles referring to a shape.
+ */
+static unsigned long countShapeTiles(AtlasPointer const & atlas) {
+    unsigned long count = 0;
+    for (auto const & region : atlas->getRegions()) {
+        for (auto const & map : region.second->getMaps()) {
+            for (auto const & layer : map.second->getLayers().getTileLayers()) {
+                for (auto const & field : layer->getFields()) {
+                    for (auto const & tile : field.second->getTiles()) {
+                        count += tile->getAttributes().count("path");
+                    }
+                }
+            }
+        }
+    }
+    return count;
+}
+
+
+TEST(AtlasGeneratorTest, GenerateStructure) {
+    
+    Session::setCurrentSession(Session::init());
+    
+    AtlasGenerator::Settings settings;
+    settings.regions = 3;
+    settings.mapsPerRegion = 2;
+    settings.mapSize = QSize{20, 10};
+    settings.baseDensity = 1.0;
+    
+    QStringList log;
+    auto atlas = AtlasGenerator{settings}.generate(log);
+    
+    ASSERT_EQ(atlas->getRegions().size(), 3);
+    auto map = atlas->getRegion("Region 2")->getMap("Map 2-1");
+    ASSERT_TRUE(map->isValid());
+    EXPECT_EQ(map->getCoordinateSystem()->getSize(), QSize(20, 10));
+    EXPECT_EQ(collectBaseFields(atlas).size(), 3 * 2 * 20 * 10);
+}
+
+
+TEST(AtlasGeneratorTest, SameSeedSameAtlas) {
+    
+    Session::setCurrentSession(Session::init());
+    
+    AtlasGenerator::Settings settings;
+    settings.seed = 42;
+    settings.regions = 2;
+    settings.mapsPerRegion = 2;
+    settings.mapSize = QSize{30, 30};
+    settings.baseDensity = 0.5;
+    
+    QStringList log;
+    auto first = collectBaseFields(AtlasGenerator{settings}.generate(log));
+    auto second = collectBaseFields(AtlasGenerator{settings}.generate(log));
+    EXPECT_EQ(first, second);
+    
+    settings.seed = 43;
+    auto third = collectBaseFields(AtlasGenerator{settings}.generate(log));
+    EXPECT_NE(first, third);
+}
+
+
+TEST(AtlasGeneratorTest, GenerateWithShippedShapes) {
+    
+    Session::setCurrentSession(Session::init());
+    
+    QStringList log;
+    ResourceLoader loader{nullptr};
+    loader.setUserFolders({SOURCE_PATH "/share/rpgmapper"});
+    loader.load(log);
+    
+    AtlasGenerator::Settings settings;
+    settings.regions = 1;
+    settings.mapsPerRegion = 1;
+    settings.mapSize = QSize{20, 20};
+    settings.baseDensity = 1.0;
+    settings.tileDensity = 0.5;
+    
+    auto atlas = AtlasGenerator{settings}.generate(log);
+    EXPECT_GT(countShapeTiles(atlas), 0ul);
+}
@@ -4,6 +4,7 @@
  * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
  */
 
+#include <atomic>
 #include <chrono>
 #include <thread>
 
@@ -68,3 +69,101 @@ TEST(Average, FloatAverageTime1Sec) {
     std::this_thread::sleep_for(std::chrono::milliseconds(1001));
     EXPECT_EQ(average.average(), 0.0);
 }
+
+
+TEST(Average, RingOverwritesOldest) {
+
+    AverageOverSize<int> average(3);
+    average << 1 << 2 << 3 << 4 << 5;
+    
+    auto items = average.items();
+    ASSERT_EQ(items.size(), 3);
+    EXPECT_EQ(items[0].value, 3);
+    EXPECT_EQ(items[2].value, 5);
+    EXPECT_EQ(average.sum(), 12);
+    EXPECT_EQ(average.capacity(), 3);
+}
+
+
+TEST(Average, TimeWindowKeepsAllValues) {
+
+    // the ring starts with 4 slots: values within the time frame make it grow, none is dropped
+    AverageOverTime<int> average(std::chrono::seconds{10}, 4);
+    average << 1 << 2 << 3 << 4 << 5 << 6;
+    
+    auto items = average.items();
+    ASSERT_EQ(items.size(), 6);
+    EXPECT_EQ(items[0].value, 1);
+    EXPECT_EQ(items[5].value, 6);
+    EXPECT_EQ(average.sum(), 21);
+    EXPECT_GE(average.capacity(), 6);
+}
+
+
+TEST(Average, TimeWindowDropsExpiredValues) {
+
+    // a full ring drops expired values first and only grows if there are none
+    AverageOverTime<int> average(std::chrono::milliseconds{50}, 2);
+    average << 1 << 2;
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    average << 3 << 4;
+    
+    auto items = average.items();
+    ASSERT_EQ(items.size(), 2);
+    EXPECT_EQ(items[0].value, 3);
+    EXPECT_EQ(items[1].value, 4);
+    EXPECT_EQ(average.capacity(), 2);
+}
+
+
+TEST(Average, Percentiles) {
+
+    AverageOverSize<float> average(100);
+    for (int i = 100; i > 0; --i) {
+        average << i;
+    }
+    EXPECT_EQ(average.percentile(0.0), 1.0);
+    EXPECT_EQ(average.percentile(0.5), 51.0);
+    EXPECT_EQ(average.percentile(0.95), 95.0);
+    EXPECT_EQ(average.percentile(0.99), 99.0);
+    EXPECT_EQ(average.percentile(1.0), 100.0);
+}
+
+
+TEST(Average, ConcurrentAverage) {
+
+    ConcurrentAverage<float, 16> average;
+    EXPECT_EQ(average.average(), 0.0);
+    EXPECT_EQ(average.percentile(0.5), 0.0);
+
+    average << 1 << 2 << 3;
+    EXPECT_EQ(average.size(), 3);
+    EXPECT_EQ(average.average(), 2.0);
+    
+    for (int i = 0; i < 16; ++i) {
+        average << 10;
+    }
+    EXPECT_EQ(average.size(), 16);
+    EXPECT_EQ(average.percentile(0.99), 10.0);
+}
+
+
+TEST(Average, ConcurrentAverageReaders) {
+
+    ConcurrentAverage<int, 64> average;
+    std::atomic<bool> done{false};
+    
+    std::thread writer{[&] {
+        for (int i = 0; i < 100000; ++i) {
+            average << 7;
+        }
+        done = true;
+    }};
+    
+    while (!done) {
+        auto value = average.percentile(0.5);
+        EXPECT_TRUE(value == 0 || value == 7);
+    }
+    writer.join();
+    EXPECT_EQ(average.average(), 7);
+}
@@ -7,12 +7,36 @@
 #include <gtest/gtest.h>
 
 #include <QApplication>
+#include <QCborStreamReader>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <rpgmapper/json/cbor_writer.hpp>
 
 #include <rpgmapper/layer/layer.hpp>
+#include <rpgmapper/layer/tile_layer.hpp>
+#include <rpgmapper/tile/tile.hpp>
+#include <rpgmapper/tile/tile_factory.hpp>
 #include <rpgmapper/field.hpp>
 #include <rpgmapper/map.hpp>
 
 using namespace rpgmapper::model;
+using namespace rpgmapper::model::tile;
+
+
+/**
+ * Adds a field with the given tiles to a tile layer.
+ *
+ * @param   layer       the layer to add to.
+ * @param   x           X-coordinate of the field.
+ * @param   y           Y-coordinate of the field.
+ * @param   tiles       the tiles of the field.
+ */
+static void addField(layer::TileLayer & layer, int x, int y, Tiles const & tiles) {
+    auto field = FieldPointer{new Field{x, y}};
+    field->getTiles() = tiles;
+    layer.addField(field);
+}
 
 
 TEST(LayerTest, BackgroundLayerHasColor) {
@@ -106,3 +130,115 @@ TEST(LayerTest, TileLayerAddFields) {
     EXPECT_EQ(field4->getIndex(), index);
     EXPECT_EQ(field5->getIndex(), index);
 }
+
+
+TEST(LayerTest, TileLayerRoundTrip) {
+    
+    Map map{"foo"};
+    auto & layer = *map.getLayers().getTileLayers().front();
+    addField(layer, 3, 4, {TileFactory::create(TileType::color, {{"color", "#ff0000"}})});
+    addField(layer, 4, 4, {TileFactory::create(TileType::color, {{"color", "#ff0000"}})});
+    addField(layer, 40, 17, {TileFactory::create(TileType::shape, {{"path", "/shapes/a"}, {"rotation", "90"}}),
+                             TileFactory::create(TileType::color, {{"color", "ä"}})});
+    addField(layer, 2, 90, {});
+    
+    Map loadedMap{"foo"};
+    auto & loadedLayer = *loadedMap.getLayers().getTileLayers().front();
+    ASSERT_TRUE(loadedLayer.applyJSON(layer.getJSON()));
+    
+    ASSERT_EQ(loadedLayer.getFields().size(), layer.getFields().size());
+    for (auto const & pair : layer.getFields()) {
+        auto field = loadedLayer.getField(pair.first);
+        ASSERT_TRUE(field->isValid());
+        EXPECT_EQ(field->getPosition(), pair.second->getPosition());
+        ASSERT_EQ(field->getTiles().size(), pair.second->getTiles().size());
+        for (std::size_t i = 0; i < field->getTiles().size(); ++i) {
+            EXPECT_TRUE(*field->getTiles()[i] == *pair.second->getTiles()[i]);
+            EXPECT_EQ(field->getTiles()[i]->getMap(), &loadedMap);
+            EXPECT_EQ(field->getTiles()[i]->getPosition(), QPointF(field->getPosition()));
+        }
+    }
+}
+
+
+TEST(LayerTest, TileLayerDenseEncoding) {
+    
+    Map map{"foo"};
+    auto & layer = *map.getLayers().getBaseLayers().front();
+    for (int y = 0; y < 256; ++y) {
+        for (int x = 0; x < 256; ++x) {
+            auto color = (x < 128) ? "#008000" : "#0000ff";
+            addField(layer, x, y, {TileFactory::create(TileType::color, {{"color", color}})});
+        }
+    }
+    
+    // two runs per row
+    auto json = layer.getJSON();
+    EXPECT_LT(json["fields"].toString().size(), 4096);
+    
+    Map loadedMap{"foo"};
+    auto & loadedLayer = *loadedMap.getLayers().getBaseLayers().front();
+    ASSERT_TRUE(loadedLayer.applyJSON(json));
+    EXPECT_EQ(loadedLayer.getFields().size(), 256u * 256u);
+    EXPECT_TRUE(*loadedLayer.getField(200, 255)->getTiles().front() == *layer.getField(200, 255)->getTiles().front());
+}
+
+
+TEST(LayerTest, TileLayerRejectsUnknownData) {
+    
+    Map map{"foo"};
+    auto & layer = *map.getLayers().getTileLayers().front();
+    addField(layer, 1, 1, {TileFactory::create(TileType::color, {{"color", "#ff0000"}})});
+    auto data = QByteArray::fromBase64(layer.getJSON()["fields"].toString().toLatin1());
+    
+    auto newer = data;
+    newer[4] = static_cast<char>(newer[4] + 1);
+    QJsonObject json;
+    json["fields"] = QString::fromLatin1(newer.toBase64());
+    EXPECT_FALSE(layer.applyJSON(json));
+    
+    json["fields"] = QString::fromLatin1(data.left(data.size() - 1).toBase64());
+    EXPECT_FALSE(layer.applyJSON(json));
+    
+    // the layer is untouched by data rejected
+    EXPECT_TRUE(layer.isFieldPresent(1, 1));
+}
+
+
+TEST(LayerTest, MapKeepsTileLayers) {
+    
+    Map map{"foo"};
+    addField(*map.getLayers().getTileLayers().front(), 5, 6,
+             {TileFactory::create(TileType::shape, {{"path", "/shapes/a"}})});
+    
+    Map loadedMap{"foo"};
+    loadedMap.applyJSON(map.getJSON());
+    ASSERT_EQ(loadedMap.getLayers().getBaseLayers().size(), 1u);
+    ASSERT_EQ(loadedMap.getLayers().getTileLayers().size(), 1u);
+    EXPECT_TRUE(loadedMap.getLayers().getTileLayers().front()->isFieldPresent(5, 6));
+}
+
+
+TEST(LayerTest, MapCBORRoundTrip) {
+    
+    Map map{"foo"};
+    addField(*map.getLayers().getBaseLayers().front(), 1, 2,
+             {TileFactory::create(TileType::color, {{"color", "#00ff00"}})});
+    addField(*map.getLayers().getTileLayers().front(), 5, 6,
+             {TileFactory::create(TileType::shape, {{"path", "/shapes/a"}, {"rotation", "90"}})});
+    
+    QByteArray data;
+    json::CBORWriter writer{&data};
+    map.writeJSON(writer);
+    EXPECT_LT(data.size(), QJsonDocument{map.getJSON()}.toJson(QJsonDocument::Compact).size());
+    
+    Map loadedMap{"bar"};
+    QCborStreamReader reader{data};
+    ASSERT_TRUE(loadedMap.readCBOR(reader));
+    EXPECT_EQ(loadedMap.getName(), "foo");
+    EXPECT_EQ(loadedMap.getJSON(), map.getJSON());
+    EXPECT_TRUE(loadedMap.getLayers().getTileLayers().front()->isFieldPresent(5, 6));
+    
+    QCborStreamReader truncated{data.left(data.size() / 2)};
+    EXPECT_FALSE(Map{"baz"}.readCBOR(truncated));
+}
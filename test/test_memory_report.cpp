@@ -0,0 +1,79 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#include <gtest/gtest.h>
+
+#include <rpgmapper/command/place_tile.hpp>
+#include <rpgmapper/command/processor.hpp>
+#include <rpgmapper/tile/tile_factory.hpp>
+#include <rpgmapper/atlas.hpp>
+#include <rpgmapper/map.hpp>
+#include <rpgmapper/memory_report.hpp>
+#include <rpgmapper/session.hpp>
+
+using namespace rpgmapper::model;
+using namespace rpgmapper::model::command;
+using namespace rpgmapper::model::tile;
+
+
+TEST(MemoryReport, Sum) {
+
+    MemoryReport report;
+    EXPECT_EQ(report.getTotal(), 0);
+
+    MemoryReport other;
+    other.fields = 10;
+    other.attributes = 20;
+    other.commandHistory = 30;
+    report += other;
+    report += other;
+
+    EXPECT_EQ(report.fields, 20);
+    EXPECT_EQ(report.attributes, 40);
+    EXPECT_EQ(report.commandHistory, 60);
+    EXPECT_EQ(report.getTotal(), 120);
+    EXPECT_EQ(report.toStringList().size(), 8);
+}
+
+
+TEST(MemoryReport, EmptyMap) {
+
+    Map map{"foo"};
+    auto report = map.getMemoryReport();
+    EXPECT_EQ(report.fields, 0);
+    EXPECT_EQ(report.tiles, 0);
+    EXPECT_EQ(report.attributes, 0);
+    EXPECT_EQ(report.backgroundPixmaps, 0);
+}
+
+
+TEST(MemoryReport, PlacedTiles) {
+
+    Session::setCurrentSession(Session::init());
+    auto session = Session::getCurrentSession();
+    auto processor = session->getCommandProcessor();
+    auto map = session->findMap(QObject::tr("New Map 1"));
+    ASSERT_TRUE(map->isValid());
+
+    auto before = session->getMemoryReport();
+
+    auto tile = TileFactory::create(TileType::color, {{"color", "#ff0000"}});
+    processor->execute(CommandPointer{new PlaceTile{map, tile, QPointF{1.0, 1.0}}});
+    auto oneTile = map->getMemoryReport();
+    EXPECT_GT(oneTile.fields, 0);
+    EXPECT_GT(oneTile.tiles, 0);
+    EXPECT_GT(oneTile.attributes, 0);
+
+    tile = TileFactory::create(TileType::color, {{"color", "#00ff00"}});
+    processor->execute(CommandPointer{new PlaceTile{map, tile, QPointF{2.0, 1.0}}});
+    auto twoTiles = map->getMemoryReport();
+    EXPECT_GT(twoTiles.fields, oneTile.fields);
+    EXPECT_GT(twoTiles.tiles, oneTile.tiles);
+
+    auto after = session->getMemoryReport();
+    EXPECT_GT(after.commandHistory, before.commandHistory);
+    EXPECT_GT(after.getTotal(), before.getTotal());
+}
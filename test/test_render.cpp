@@ -0,0 +1,291 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <QDir>
+#include <QFile>
+#include <QGuiApplication>
+#include <QImage>
+#include <QPainter>
+
+#include <rpgmapper/resource/resource_loader.hpp>
+#include <rpgmapper/atlas.hpp>
+#include <rpgmapper/atlas_generator.hpp>
+#include <rpgmapper/coordinate_system.hpp>
+#include <rpgmapper/field.hpp>
+#include <rpgmapper/map.hpp>
+#include <rpgmapper/region.hpp>
+#include <rpgmapper/session.hpp>
+
+using namespace rpgmapper::model;
+using namespace rpgmapper::model::resource;
+
+
+/**
+ * Where the golden images live.
+ */
+static QString const RENDER_DATA_PATH = SOURCE_PATH "/test/data/render";
+
+/**
+ * Number of frames rendered to get the median frame time.
+ */
+static int const FRAMES = 15;
+
+/**
+ * A pixel differs, if any channel differs by more than this.
+ */
+static int const PIXEL_TOLERANCE = 16;
+
+/**
+ * The test fails, if more than this ratio of pixels differ from the golden image.
+ */
+static double const MAX_DIFFERING_PIXELS = 0.005;
+
+
+/**
+ * Checks if the golden images should be rewritten instead of compared.
+ *
+ * @return  true, if RPGMAPPER_UPDATE_RENDER_BASELINE is set.
+ */
+static bool isUpdateRequested() {
+    return std::getenv("RPGMAPPER_UPDATE_RENDER_BASELINE") != nullptr;
+}
+
+
+/**
+ * Returns the allowed median frame time in relation to the reference frame time.
+ *
+ * Frame times depend on the load of the machine, so the budget is checked on request only.
+ *
+ * @return  the factor of RPGMAPPER_RENDER_BUDGET (0.0, if not set: the budget is not checked).
+ */
+static double getBudgetFactor() {
+    auto budget = std::getenv("RPGMAPPER_RENDER_BUDGET");
+    return budget ? std::atof(budget) : 0.0;
+}
+
+
+/**
+ * Counts the pixels differing between two images.
+ *
+ * @param   image       the rendered image.
+ * @param   golden      the golden image.
+ * @return  the number of pixels differing by more than PIXEL_TOLERANCE.
+ */
+static long countDifferingPixels(QImage const & image, QImage const & golden) {
+
+    long differing = 0;
+    for (int y = 0; y < image.height(); ++y) {
+        auto line = reinterpret_cast<QRgb const *>(image.constScanLine(y));
+        auto goldenLine = reinterpret_cast<QRgb const *>(golden.constScanLine(y));
+        for (int x = 0; x < image.width(); ++x) {
+            auto differs = (std::abs(qRed(line[x]) - qRed(goldenLine[x])) > PIXEL_TOLERANCE)
+                    || (std::abs(qGreen(line[x]) - qGreen(goldenLine[x])) > PIXEL_TOLERANCE)
+                    || (std::abs(qBlue(line[x]) - qBlue(goldenLine[x])) > PIXEL_TOLERANCE)
+                    || (std::abs(qAlpha(line[x]) - qAlpha(goldenLine[x])) > PIXEL_TOLERANCE);
+            differing += differs ? 1 : 0;
+        }
+    }
+    return differing;
+}
+
+
+/**
+ * Renders a map just like the map widget does, but into an image.
+ *
+ * The axis is left out: its font rendering differs between machines.
+ *
+ * @param   map         the map to render.
+ * @param   tileSize    the tile size to render.
+ * @return  the rendered map.
+ */
+static QImage renderMap(Map const & map, int tileSize) {
+
+    auto rect = map.getCoordinateSystem()->getOuterRect(tileSize);
+    QImage image{rect.size(), QImage::Format_ARGB32};
+    image.fill(Qt::white);
+
+    QPainter painter{&image};
+    painter.setRenderHint(QPainter::Antialiasing);
+    for (auto const & pair : map.getLayers().getVisibleLayers(true, false)) {
+        pair.second->draw(painter, tileSize);
+    }
+
+    return image;
+}
+
+
+/**
+ * Renders the reference frame of a map: each tile as a single prerendered image.
+ *
+ * This is what drawing the map costs at best, measured on the very same machine. The
+ * frame time budget is relative to it, so it holds on fast and slow machines alike.
+ *
+ * @param   map         the map to render.
+ * @param   tileSize    the tile size to render.
+ * @param   tileImage   the image drawn for each tile.
+ */
+static void renderReference(Map const & map, int tileSize, QImage const & tileImage) {
+
+    auto rect = map.getCoordinateSystem()->getOuterRect(tileSize);
+    auto innerRect = map.getCoordinateSystem()->getInnerRect(tileSize);
+    QImage image{rect.size(), QImage::Format_ARGB32};
+    image.fill(Qt::white);
+
+    QPainter painter{&image};
+    painter.setRenderHint(QPainter::Antialiasing);
+    auto drawFields = [&] (auto const & layers) {
+        for (auto const & layer : layers) {
+            for (auto const & pair : layer->getFields()) {
+                auto position = pair.second->getPosition();
+                QPoint topLeft{innerRect.left() + position.x() * tileSize, innerRect.top() + position.y() * tileSize};
+                for (std::size_t i = 0; i < pair.second->getTiles().size(); ++i) {
+                    painter.drawImage(topLeft, tileImage);
+                }
+            }
+        }
+    };
+    drawFields(map.getLayers().getBaseLayers());
+    drawFields(map.getLayers().getTileLayers());
+}
+
+
+/**
+ * Measures the median time of rendering a frame.
+ *
+ * @param   render      renders a single frame.
+ * @return  the median frame time in milliseconds.
+ */
+template <typename Render>
+static double measureMedianFrameTime(Render render) {
+
+    using Clock = std::chrono::steady_clock;
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+
+    // the first frame fills the caches
+    render();
+
+    std::vector<double> frames;
+    for (int i = 0; i < FRAMES; ++i) {
+        auto start = Clock::now();
+        render();
+        frames.push_back(Milliseconds{Clock::now() - start}.count());
+    }
+    std::sort(frames.begin(), frames.end());
+    return frames[frames.size() / 2];
+}
+
+
+/**
+ * Renders a generated atlas and checks the results against the golden images and the frame time budget.
+ */
+class RenderTest : public ::testing::TestWithParam<int> {
+
+protected:
+
+    static AtlasPointer atlas;              /**< The atlas rendered. */
+
+public:
+
+    /**
+     * Loads the shipped shapes and generates a small but dense atlas.
+     */
+    static void SetUpTestSuite() {
+
+        Session::setCurrentSession(Session::init());
+
+        QStringList log;
+        ResourceLoader loader{nullptr};
+        loader.setUserFolders({SOURCE_PATH "/share/rpgmapper"});
+        loader.load(log);
+
+        AtlasGenerator::Settings settings;
+        settings.seed = 4711;
+        settings.regions = 1;
+        settings.mapsPerRegion = 1;
+        settings.mapSize = QSize{24, 16};
+        settings.baseDensity = 0.8;
+        settings.tileDensity = 0.4;
+        atlas = AtlasGenerator{settings}.generate(log);
+    }
+
+    /**
+     * Drops the atlas.
+     */
+    static void TearDownTestSuite() {
+        atlas.clear();
+    }
+};
+
+
+AtlasPointer RenderTest::atlas;
+
+
+TEST_P(RenderTest, GoldenImage) {
+
+    auto tileSize = GetParam();
+    auto map = atlas->getRegion("Region 1")->getMap("Map 1-1");
+    ASSERT_TRUE(map->isValid());
+
+    auto image = renderMap(*map, tileSize);
+    auto goldenFileName = QString{"%1/map-%2.png"}.arg(RENDER_DATA_PATH).arg(tileSize);
+    if (isUpdateRequested()) {
+        ASSERT_TRUE(QDir{}.mkpath(RENDER_DATA_PATH));
+        ASSERT_TRUE(image.save(goldenFileName));
+        return;
+    }
+
+    QImage golden;
+    ASSERT_TRUE(golden.load(goldenFileName))
+            << "No golden image " << goldenFileName.toStdString()
+            << ", run with RPGMAPPER_UPDATE_RENDER_BASELINE=1 to create it.";
+    golden = golden.convertToFormat(QImage::Format_ARGB32);
+    ASSERT_EQ(image.size(), golden.size());
+
+    auto pixels = static_cast<double>(image.width()) * image.height();
+    EXPECT_LE(countDifferingPixels(image, golden) / pixels, MAX_DIFFERING_PIXELS);
+}
+
+
+TEST_P(RenderTest, FrameTimeBudget) {
+
+    if (getBudgetFactor() <= 0.0) {
+        GTEST_SKIP() << "Set RPGMAPPER_RENDER_BUDGET (e.g. 6.0) to check the frame time budget.";
+    }
+
+    auto tileSize = GetParam();
+    auto map = atlas->getRegion("Region 1")->getMap("Map 1-1");
+    ASSERT_TRUE(map->isValid());
+
+    QImage tileImage{tileSize, tileSize, QImage::Format_ARGB32_Premultiplied};
+    tileImage.fill(Qt::darkGray);
+    auto reference = measureMedianFrameTime([&] () { renderReference(*map, tileSize, tileImage); });
+    auto median = measureMedianFrameTime([&] () { renderMap(*map, tileSize); });
+
+    auto budget = reference * getBudgetFactor();
+    EXPECT_LE(median, budget) << "median frame time " << median << " ms exceeds budget of " << budget
+                              << " ms (" << getBudgetFactor() << " times the reference frame of " << reference << " ms)";
+}
+
+
+INSTANTIATE_TEST_SUITE_P(TileSizes, RenderTest, ::testing::Values(16, 32, 48));
+
+
+int main(int argc, char ** argv) {
+
+    // no display, no GPU: render with the offscreen platform
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+    QGuiApplication application{argc, argv};
+
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,59 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#include <gtest/gtest.h>
+
+#include <rpgmapper/render_statistics.hpp>
+
+using namespace rpgmapper::model;
+
+
+TEST(RenderStatistics, EmptyReport) {
+
+    RenderStatistics::reset();
+    auto report = RenderStatistics::getReport();
+    
+    EXPECT_EQ(report.frames, 0);
+    EXPECT_EQ(report.frameMillisecondsP99, 0.0);
+    EXPECT_EQ(report.getShapeCacheHitRate(), 0.0);
+    EXPECT_TRUE(report.layerMilliseconds.empty());
+}
+
+
+TEST(RenderStatistics, FramePercentiles) {
+
+    RenderStatistics::reset();
+    for (int i = 1; i <= 100; ++i) {
+        RenderStatistics::beginFrame();
+        RenderStatistics::addLayerTime("tile", 2.0);
+        RenderStatistics::addFields(10, static_cast<unsigned long>(i % 10));
+        RenderStatistics::endFrame(static_cast<float>(i));
+    }
+    
+    auto report = RenderStatistics::getReport();
+    EXPECT_EQ(report.frames, 100);
+    EXPECT_EQ(report.frameMillisecondsP50, 51.0);
+    EXPECT_EQ(report.frameMillisecondsP95, 95.0);
+    EXPECT_EQ(report.frameMillisecondsP99, 99.0);
+    EXPECT_EQ(report.layerMilliseconds["tile"], 2.0);
+    EXPECT_EQ(report.fieldsVisited, 10);
+    EXPECT_EQ(report.fieldsDrawn, 0);
+}
+
+
+TEST(RenderStatistics, ShapeCacheHitRate) {
+
+    RenderStatistics::reset();
+    RenderStatistics::addShapeCacheMiss();
+    RenderStatistics::addShapeCacheHit();
+    RenderStatistics::addShapeCacheHit();
+    RenderStatistics::addShapeCacheHit();
+    
+    auto report = RenderStatistics::getReport();
+    EXPECT_EQ(report.shapeCacheHits, 3);
+    EXPECT_EQ(report.shapeCacheMisses, 1);
+    EXPECT_DOUBLE_EQ(report.getShapeCacheHitRate(), 0.75);
+}
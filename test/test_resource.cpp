@@ -4,12 +4,39 @@
  * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
  */
 
+#include <algorithm>
+
 #include <gtest/gtest.h>
 
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QGuiApplication>
+#include <QRunnable>
+#include <QTemporaryDir>
+#include <QTemporaryFile>
+#include <QThreadPool>
+
+#include <rpgmapper/resource/blob_store.hpp>
+#include <rpgmapper/resource/colorpalette.hpp>
+#include <rpgmapper/resource/raster_cache.hpp>
 #include <rpgmapper/resource/resource.hpp>
+#include <rpgmapper/resource/resource_bundle.hpp>
 #include <rpgmapper/resource/resource_collection.hpp>
+#include <rpgmapper/resource/resource_db.hpp>
+#include <rpgmapper/resource/resource_loader.hpp>
 #include <rpgmapper/resource/resource_pointer.hpp>
+#include <rpgmapper/resource/resource_watcher.hpp>
+#include <rpgmapper/resource/shape.hpp>
+#include <rpgmapper/resource/shape_index.hpp>
+#include <rpgmapper/atlas.hpp>
+#include <rpgmapper/render_statistics.hpp>
+#include <rpgmapper/session.hpp>
 
+using namespace rpgmapper::model;
 using namespace rpgmapper::model::resource;
 
 
@@ -34,3 +61,487 @@ TEST(ResoucrceDB, InsertResource) {
     EXPECT_EQ((*pair).second->getHash(), Resource::getHash(data));
     EXPECT_EQ((*pair).second->getData().toHex().toStdString(), "0102030405060708090a0b0c0d0e0f10");
 }
+
+
+TEST(ResoucrceDB, PrefixQuery) {
+
+    auto resources = QSharedPointer<ResourceCollection>{new ResourceCollection};
+    auto data = QByteArray::fromHex("01");
+    for (auto const & path : {"/backgrounds/a.png", "/shapes/a.svg", "/shapes/b/c.svg", "/shapesx.svg", "/a"}) {
+        resources->addResource(ResourcePointer{new Resource{path, data}});
+    }
+
+    std::set<QString> paths;
+    resources->collectPaths(paths, "/shapes/");
+    EXPECT_EQ(paths, (std::set<QString>{"/shapes/a.svg", "/shapes/b/c.svg"}));
+
+    EXPECT_TRUE(resources->removeResource("/shapes/a.svg"));
+    EXPECT_FALSE(resources->removeResource("/shapes/a.svg"));
+
+    paths.clear();
+    resources->collectPaths(paths, "/shapes");
+    EXPECT_EQ(paths, (std::set<QString>{"/shapes/b/c.svg", "/shapesx.svg"}));
+}
+
+
+TEST(ResoucrceDB, LazyResource) {
+
+    auto data = QByteArray::fromHex("0102030405060708090a0b0c0d0e0f10");
+    QTemporaryFile file;
+    ASSERT_TRUE(file.open());
+    file.write(data);
+    file.close();
+
+    QFileInfo fileInfo{file.fileName()};
+    Resource::Source source{fileInfo.absoluteFilePath(), fileInfo.size(), fileInfo.lastModified()};
+    auto resource = ResourcePointer{new Resource{"lazy", source}};
+    EXPECT_FALSE(resource->isLoaded());
+    EXPECT_EQ(resource->getSize(), data.size());
+
+    auto resources = QSharedPointer<ResourceCollection>{new ResourceCollection};
+    resources->addResource(resource);
+    EXPECT_FALSE(resource->isLoaded());
+
+    EXPECT_EQ(resource->getData(), data);
+    EXPECT_TRUE(resource->isLoaded());
+    EXPECT_EQ(resource->getHash(), Resource::getHash(data));
+}
+
+
+TEST(ResoucrceDB, LazyShapeValidation) {
+
+    QTemporaryDir folder;
+    ASSERT_TRUE(folder.isValid());
+    QFile file{folder.filePath("broken.svg")};
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.write(R"(<svg xmlns="http://www.w3.org/2000/svg" width="10" height="10"><circle cx="5")");
+    file.close();
+
+    QFileInfo fileInfo{file.fileName()};
+    Resource::Source source{fileInfo.absoluteFilePath(), fileInfo.size(), fileInfo.lastModified()};
+    Shape shape{"/shapes/broken.svg", source};
+
+    // the SVG is checked once it has been read
+    EXPECT_TRUE(shape.isValid());
+    shape.loadData();
+    EXPECT_FALSE(shape.isValid());
+
+    shape.setData(R"(<svg xmlns="http://www.w3.org/2000/svg" width="10" height="10"><circle cx="5" cy="5" r="2"/></svg>)");
+    EXPECT_TRUE(shape.isValid());
+}
+
+
+TEST(ResoucrceDB, MappedResource) {
+
+    auto data = QByteArray::fromHex("0102030405060708090a0b0c0d0e0f10");
+    QTemporaryFile file;
+    ASSERT_TRUE(file.open());
+    file.write(data);
+    file.close();
+
+    QFileInfo fileInfo{file.fileName()};
+    Resource::Source source{fileInfo.absoluteFilePath(), fileInfo.size(), fileInfo.lastModified()};
+    source.mapped = true;
+    auto resource = ResourcePointer{new Resource{"mapped", source}};
+
+    auto copy = resource->getData();
+    EXPECT_EQ(copy, data);
+    EXPECT_TRUE(resource->isMapped());
+    resource->withData([&] (QByteArray const & bytes) { EXPECT_EQ(bytes, data); });
+
+    // copies handed out survive the mapping
+    auto replaced = QByteArray::fromHex("1112");
+    resource->setData(replaced);
+    EXPECT_FALSE(resource->isMapped());
+    EXPECT_EQ(resource->getData(), replaced);
+    resource.clear();
+    EXPECT_EQ(copy, data);
+}
+
+
+TEST(ResoucrceDB, ClassifyColorPalette) {
+
+    QByteArray data{R"({"name": "Test", "colors": ["#ff0000", "#00ff00"]})"};
+    auto classification = ResourceLoader::classify("/colorpalettes/test.json", data);
+    EXPECT_EQ(classification.type, ResourceType::colorpalette);
+    EXPECT_TRUE(classification.mimeType.isValid());
+    EXPECT_TRUE(ColorPalette::isColorPalette(classification.json));
+
+    QStringList log;
+    auto resource = ResourceLoader::createResource(classification, log);
+    auto colorPalette = dynamic_cast<ColorPalette *>(resource.data());
+    ASSERT_NE(colorPalette, nullptr);
+    EXPECT_TRUE(colorPalette->isValid());
+    EXPECT_EQ(colorPalette->getName().toStdString(), "Test");
+    EXPECT_EQ(colorPalette->getPalette()[1], QColor{"#00ff00"});
+    EXPECT_EQ(colorPalette->getMimeType(), classification.mimeType);
+}
+
+
+TEST(ResoucrceDB, ResolutionGeneration) {
+
+    Session::setCurrentSession(Session::init());
+    auto data = QByteArray::fromHex("01");
+    auto userResource = ResourcePointer{new Resource{"/test/resolve", data}};
+    auto localResource = ResourcePointer{new Resource{"/test/resolve", data}};
+
+    ResourceDB::getUserResources()->addResource(userResource);
+    auto generation = ResourceDB::getGeneration();
+    EXPECT_EQ(ResourceDB::getResource("/test/resolve"), userResource);
+    EXPECT_EQ(ResourceDB::getGeneration(), generation);
+
+    // modifying another path leaves the generation of this path alone
+    auto pathGeneration = ResourceDB::getGeneration("/test/resolve");
+    ResourceDB::getUserResources()->addResource(ResourcePointer{new Resource{"/test/other", data}});
+    EXPECT_NE(ResourceDB::getGeneration(), generation);
+    EXPECT_EQ(ResourceDB::getGeneration("/test/resolve"), pathGeneration);
+    EXPECT_EQ(ResourceDB::getResource("/test/resolve"), userResource);
+    EXPECT_TRUE(ResourceDB::getUserResources()->removeResource("/test/other"));
+
+    ResourceDB::getLocalResources()->addResource(localResource);
+    EXPECT_GT(ResourceDB::getGeneration("/test/resolve"), pathGeneration);
+    EXPECT_NE(ResourceDB::getGeneration(), generation);
+    EXPECT_EQ(ResourceDB::getResource("/test/resolve"), localResource);
+
+    Session::setCurrentSession(Session::init());
+    EXPECT_EQ(ResourceDB::getResource("/test/resolve"), userResource);
+
+    EXPECT_TRUE(ResourceDB::getUserResources()->removeResource("/test/resolve"));
+    EXPECT_FALSE(ResourceDB::getResource("/test/resolve"));
+}
+
+
+TEST(ResoucrceDB, Bundle) {
+
+    QTemporaryDir folder;
+    ASSERT_TRUE(folder.isValid());
+    auto bundleFile = folder.filePath(ResourceBundle::getFileName());
+
+    QStringList log;
+    QString resourceFolder = SOURCE_PATH "/share/rpgmapper/resources";
+    ASSERT_TRUE(ResourceBundle::write(bundleFile, resourceFolder, log));
+
+    std::size_t files = 0;
+    QDirIterator iter{resourceFolder, QDir::Files, QDirIterator::Subdirectories};
+    while (iter.hasNext()) {
+        iter.next();
+        ++files;
+    }
+
+    ResourceLoader::LoadedFiles loadedFiles;
+    ASSERT_TRUE(ResourceBundle::read(bundleFile, loadedFiles, log));
+    ASSERT_EQ(loadedFiles.size(), files);
+
+    auto findFile = [&] (QString const & path) {
+        return std::find_if(loadedFiles.begin(), loadedFiles.end(), [&] (auto const & f) { return f.path == path; });
+    };
+
+    auto palette = findFile("/colorpalettes/standard.json");
+    ASSERT_NE(palette, loadedFiles.end());
+    ASSERT_TRUE(palette->resource);
+    EXPECT_TRUE(palette->resource->isValid());
+
+    auto shape = findFile("/shapes/markers/star.svg");
+    ASSERT_NE(shape, loadedFiles.end());
+    ASSERT_TRUE(shape->resource);
+    EXPECT_TRUE(shape->resource->isMapped());
+    EXPECT_EQ(shape->resource->getMimeType().name().toStdString(), "image/svg+xml");
+
+    auto catalog = findFile("/shapes/markers/catalog.json");
+    ASSERT_NE(catalog, loadedFiles.end());
+    EXPECT_TRUE(catalog->shapeCatalog);
+    EXPECT_FALSE(catalog->classification.json.isEmpty());
+}
+
+
+TEST(ResoucrceDB, BundleIndexSize) {
+
+    QTemporaryDir folder;
+    ASSERT_TRUE(folder.isValid());
+    auto bundleFile = folder.filePath(ResourceBundle::getFileName());
+
+    QStringList log;
+    ASSERT_TRUE(ResourceBundle::write(bundleFile, SOURCE_PATH "/share/rpgmapper/resources", log));
+
+    // the index size follows the magic and the version: declare an index shorter than the entries
+    QFile file{bundleFile};
+    ASSERT_TRUE(file.open(QIODevice::ReadWrite));
+    ASSERT_TRUE(file.seek(12));
+    QDataStream stream{&file};
+    qint64 indexSize = 0;
+    stream >> indexSize;
+    ASSERT_TRUE(file.seek(12));
+    stream << (indexSize - 8);
+    file.close();
+
+    ResourceLoader::LoadedFiles loadedFiles;
+    EXPECT_FALSE(ResourceBundle::read(bundleFile, loadedFiles, log));
+    EXPECT_TRUE(loadedFiles.empty());
+}
+
+
+TEST(ResoucrceDB, WatcherRescan) {
+
+    Session::setCurrentSession(Session::init());
+
+    QTemporaryDir folder;
+    ASSERT_TRUE(folder.isValid());
+    ASSERT_TRUE(QDir{folder.path()}.mkpath("shapes/watched"));
+    auto fileName = folder.filePath("shapes/watched/dot.svg");
+    auto writeShape = [&] (int radius) {
+        QFile file{fileName};
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        file.write(QString{R"(<svg xmlns="http://www.w3.org/2000/svg" width="10" height="10">)"
+                           R"(<circle cx="5" cy="5" r="%1"/></svg>)"}.arg(radius).toUtf8());
+    };
+
+    writeShape(2);
+    ResourceWatcher watcher;
+    watcher.watch({folder.path()});
+    EXPECT_TRUE(watcher.rescan().isEmpty());
+
+    writeShape(4000);
+    auto changed = watcher.rescan();
+    ASSERT_EQ(changed.size(), 1);
+    EXPECT_EQ(changed.front().toStdString(), "/shapes/watched/dot.svg");
+    auto shape = ResourceDB::getResource("/shapes/watched/dot.svg");
+    ASSERT_TRUE(shape);
+    EXPECT_TRUE(shape->getData().contains("4000"));
+
+    // a half written file keeps the previous resource
+    {
+        QFile file{fileName};
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        file.write(R"(<svg xmlns="http://www.w3.org/2000/svg" wid)");
+    }
+    EXPECT_TRUE(watcher.rescan().isEmpty());
+    EXPECT_EQ(ResourceDB::getResource("/shapes/watched/dot.svg"), shape);
+    EXPECT_TRUE(watcher.getLog().back().startsWith("Failed to reload"));
+
+    writeShape(3);
+    EXPECT_EQ(watcher.rescan().size(), 1);
+    EXPECT_NE(ResourceDB::getResource("/shapes/watched/dot.svg"), shape);
+
+    ASSERT_TRUE(QFile::remove(fileName));
+    EXPECT_EQ(watcher.rescan().size(), 1);
+    EXPECT_FALSE(ResourceDB::getResource("/shapes/watched/dot.svg"));
+}
+
+
+TEST(ResoucrceDB, RasterCache) {
+
+    QTemporaryDir folder;
+    ASSERT_TRUE(folder.isValid());
+    RasterCache::setFolder(folder.path());
+
+    QImage image{32, 32, QImage::Format_ARGB32_Premultiplied};
+    image.fill(qRgba(10, 20, 30, 255));
+    auto hash = Resource::getHash("shape");
+
+    EXPECT_TRUE(RasterCache::load(hash, 32, 0.0, 1.0).isNull());
+    RasterCache::store(hash, 32, 0.0, 1.0, image);
+    EXPECT_EQ(RasterCache::load(hash, 32, 0.0, 1.0), image);
+    EXPECT_TRUE(RasterCache::load(hash, 32, 90.0, 1.0).isNull());
+
+    // backdate the files explicitly, the file system may have a coarse time resolution
+    QDir dir{folder.path()};
+    auto setModified = [&] (QString const & fileName, int secondsAgo) {
+        QFile file{dir.filePath(fileName)};
+        ASSERT_TRUE(file.open(QIODevice::ReadWrite));
+        ASSERT_TRUE(file.setFileTime(QDateTime::currentDateTime().addSecs(-secondsAgo), QFileDevice::FileModificationTime));
+    };
+    auto upright = dir.entryList(QDir::Files);
+    ASSERT_EQ(upright.size(), 1);
+    setModified(upright.front(), 120);
+
+    RasterCache::store(hash, 32, 90.0, 1.0, image);
+    auto rotated = dir.entryList(QDir::Files);
+    rotated.removeAll(upright.front());
+    ASSERT_EQ(rotated.size(), 1);
+    setModified(rotated.front(), 60);
+
+    // the hit refreshes the upright image, the rotated one is now least recently used
+    EXPECT_EQ(RasterCache::load(hash, 32, 0.0, 1.0), image);
+
+    // a cap below three images evicts exactly the least recently used one
+    auto maximumSize = RasterCache::getMaximumSize();
+    RasterCache::setMaximumSize(QFileInfo{dir.filePath(upright.front())}.size() * 29 / 10);
+    RasterCache::store(hash, 32, 180.0, 1.0, image);
+    auto files = dir.entryList(QDir::Files);
+    EXPECT_EQ(files.size(), 2);
+    EXPECT_FALSE(files.contains(rotated.front()));
+    EXPECT_TRUE(RasterCache::load(hash, 32, 90.0, 1.0).isNull());
+    EXPECT_EQ(RasterCache::load(hash, 32, 0.0, 1.0), image);
+    EXPECT_EQ(RasterCache::load(hash, 32, 180.0, 1.0), image);
+
+    RasterCache::setMaximumSize(maximumSize);
+    RasterCache::setFolder(QString{});
+    EXPECT_FALSE(RasterCache::isEnabled());
+}
+
+
+TEST(ResoucrceDB, SharedBlobs) {
+
+    QByteArray data{"<svg xmlns=\"http://www.w3.org/2000/svg\"/>"};
+    auto first = ResourcePointer{new Resource{"/shapes/first.svg", QByteArray{data.constData(), data.size()}}};
+    auto second = ResourcePointer{new Resource{"/shapes/second.svg", QByteArray{data.constData(), data.size()}}};
+    EXPECT_NE(first->getData().constData(), second->getData().constData());
+
+    ResourceCollection user;
+    ResourceCollection local;
+    user.addResource(first);
+    local.addResource(second);
+    EXPECT_EQ(first->getData().constData(), second->getData().constData());
+    EXPECT_EQ(first->getHash(), Resource::getSHA256(data));
+
+    QTemporaryDir folder;
+    ASSERT_TRUE(folder.isValid());
+    BlobStore::setFolder(folder.path());
+    EXPECT_TRUE(BlobStore::write(first->getHash(), first->getData()));
+    EXPECT_EQ(BlobStore::read(first->getHash()), data);
+
+    // a corrupted file of the same size is replaced
+    auto blobFolders = QDir{folder.path()}.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot);
+    ASSERT_EQ(blobFolders.size(), 1);
+    QFile blobFile{QDir{blobFolders.front().absoluteFilePath()}.filePath(first->getHash())};
+    ASSERT_TRUE(blobFile.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    blobFile.write(QByteArray(data.size(), 'x'));
+    blobFile.close();
+    EXPECT_TRUE(BlobStore::read(first->getHash()).isEmpty());
+    EXPECT_TRUE(BlobStore::write(first->getHash(), first->getData()));
+    EXPECT_EQ(BlobStore::read(first->getHash()), data);
+    EXPECT_TRUE(BlobStore::read(Resource::getSHA256("missing")).isEmpty());
+    BlobStore::setFolder(QString{});
+}
+
+
+TEST(ResoucrceDB, ShapeIndexSearch) {
+
+    Session::setCurrentSession(Session::init());
+    QByteArray dungeon{R"({"name": "Dungeon", "shapes": [
+            {"name": "Dragon", "file": "dragon.svg"},
+            {"name": "Treasure Chest", "file": "chest.svg"},
+            {"name": "Skull", "file": "skull.svg"}]})"};
+    QByteArray forest{R"({"name": "Forest", "shapes": [{"name": "Oak Tree", "file": "oak.svg"}]})"};
+
+    ShapeIndex index;
+    index.addCatalog(ShapeCatalog{"/shapes/dungeon/catalog.json", dungeon});
+    index.addCatalog(ShapeCatalog{"/shapes/forest/catalog.json", forest});
+    EXPECT_EQ(index.getSize(), 4u);
+
+    auto matches = index.search("chest");
+    ASSERT_FALSE(matches.empty());
+    EXPECT_EQ(matches.front().shapePath, "/shapes/dungeon/chest.svg");
+
+    // typo and prefix
+    matches = index.search("dargon");
+    ASSERT_FALSE(matches.empty());
+    EXPECT_EQ(matches.front().shapeName, "Dragon");
+    matches = index.search("sk");
+    ASSERT_FALSE(matches.empty());
+    EXPECT_EQ(matches.front().shapeName, "Skull");
+
+    // catalog names are searched as well
+    matches = index.search("forest");
+    ASSERT_FALSE(matches.empty());
+    EXPECT_EQ(matches.front().shapeName, "Oak Tree");
+
+    EXPECT_TRUE(index.removeCatalog("/shapes/forest/catalog.json"));
+    EXPECT_EQ(index.getSize(), 3u);
+    for (auto const & match : index.search("oak tree")) {
+        EXPECT_NE(match.catalogName, "Forest");
+    }
+}
+
+
+/**
+ * Shape drawing tests: pixmaps need a (headless) QGuiApplication.
+ */
+class ShapeDrawing : public ::testing::Test {
+
+    static int argc;                                /**< Argument count of the application. */
+    static char * argv[];                           /**< Arguments of the application. */
+    static QGuiApplication * application;           /**< The application running the tests. */
+
+public:
+
+    static void SetUpTestSuite() {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+        application = new QGuiApplication{argc, argv};
+    }
+
+    static void TearDownTestSuite() {
+        delete application;
+        application = nullptr;
+    }
+};
+
+static char shapeDrawingName[] = "test-units";
+int ShapeDrawing::argc = 1;
+char * ShapeDrawing::argv[] = {shapeDrawingName, nullptr};
+QGuiApplication * ShapeDrawing::application = nullptr;
+
+
+/**
+ * Rasterizes a shape on a worker thread.
+ */
+class RasterizeRunnable : public QRunnable {
+
+    Shape const & shape;        /**< The shape to rasterize. */
+    QImage & image;             /**< Receives the rasterized image. */
+
+public:
+
+    RasterizeRunnable(Shape const & shape, QImage & image) : shape{shape}, image{image} {}
+
+    void run() override {
+        image = shape.rasterize(32);
+    }
+};
+
+
+static QByteArray const halfRedSvg{R"(<svg xmlns="http://www.w3.org/2000/svg" width="10" height="10">
+        <rect x="0" y="0" width="5" height="10" fill="#ff0000"/></svg>)"};
+
+
+TEST_F(ShapeDrawing, RasterizeOnWorkerThread) {
+
+    Shape shape{"/shapes/test/half.svg", halfRedSvg};
+
+    QImage rasterized;
+    QThreadPool pool;
+    pool.start(new RasterizeRunnable{shape, rasterized});
+    pool.waitForDone();
+
+    ASSERT_FALSE(rasterized.isNull());
+    EXPECT_FALSE(shape.isPrepared(32));
+    EXPECT_EQ(rasterized, shape.getImage(32));
+}
+
+
+TEST_F(ShapeDrawing, AddImagePrepares) {
+
+    Shape shape{"/shapes/test/half.svg", halfRedSvg};
+
+    auto image = shape.rasterize(48);
+    ASSERT_FALSE(image.isNull());
+    EXPECT_FALSE(shape.isPrepared(48));
+
+    shape.addImage(image, 48);
+    EXPECT_TRUE(shape.isPrepared(48));
+
+    RenderStatistics::reset();
+    EXPECT_EQ(shape.getImage(48), image);
+    auto report = RenderStatistics::getReport();
+    EXPECT_EQ(report.shapeCacheHits, 1ul);
+    EXPECT_EQ(report.shapeCacheMisses, 0ul);
+}
+
+
+TEST_F(ShapeDrawing, AddNullImage) {
+
+    Shape shape{"/shapes/test/half.svg", halfRedSvg};
+
+    shape.addImage(QImage{}, 32);
+    EXPECT_FALSE(shape.isPrepared(32));
+}
@@ -8,7 +8,19 @@
 
 #include <gtest/gtest.h>
 
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QTemporaryDir>
+#include <QTimer>
+
+#include <rpgmapper/resource/resource.hpp>
+#include <rpgmapper/resource/resource_collection.hpp>
+#include <rpgmapper/resource/resource_db.hpp>
+#include <rpgmapper/tile/tile_factory.hpp>
+#include <rpgmapper/tile/tiles.hpp>
 #include <rpgmapper/atlas.hpp>
+#include <rpgmapper/atlas_loader.hpp>
+#include <rpgmapper/coordinate_system.hpp>
 #include <rpgmapper/map.hpp>
 #include <rpgmapper/map_name_validator.hpp>
 #include <rpgmapper/region.hpp>
@@ -16,6 +28,7 @@
 #include <rpgmapper/session.hpp>
 
 using namespace rpgmapper::model;
+using namespace rpgmapper::model::tile;
 
 
 TEST(SessionTest, InitAndSetSession) {
@@ -286,3 +299,283 @@ TEST(SessionTest, SelectMap) {
     EXPECT_EQ(session->getCurrentRegionName().toStdString(), "regionB");
     EXPECT_EQ(session->getCurrentMapName().toStdString(), "map-B3");
 }
+
+
+TEST(SessionTest, SaveAndLoad) {
+
+    auto session = Session::init();
+    Session::setCurrentSession(session);
+    session->getAtlas()->setName("Saved Atlas");
+    auto data = QByteArray{"some local resource"};
+    rpgmapper::model::resource::ResourceDB::getLocalResources()->addResource(
+            rpgmapper::model::resource::ResourcePointer{new rpgmapper::model::resource::Resource{"/misc/a", data}});
+    rpgmapper::model::resource::ResourceDB::getLocalResources()->addResource(
+            rpgmapper::model::resource::ResourcePointer{new rpgmapper::model::resource::Resource{"/misc/b", data}});
+
+    QTemporaryDir folder;
+    ASSERT_TRUE(folder.isValid());
+    QFile file{folder.filePath("test.atlas")};
+    QStringList log;
+    ASSERT_TRUE(session->save(file, log));
+
+    SessionPointer loadedSession;
+    ASSERT_TRUE(Session::load(loadedSession, file, log));
+    EXPECT_EQ(loadedSession->getAtlas()->getName(), "Saved Atlas");
+
+    // the local resources go to the loaded atlas, not to the current session
+    auto const & resources = loadedSession->getAtlas()->getResources()->getResources();
+    ASSERT_EQ(resources.size(), 2u);
+    EXPECT_EQ(resources.at("/misc/a")->getData(), data);
+    EXPECT_EQ(resources.at("/misc/b")->getData(), data);
+}
+
+
+TEST(SessionTest, LazyMaps) {
+
+    auto session = Session::init();
+    Session::setCurrentSession(session);
+    auto region = session->findRegion("New Region 1");
+    auto secondMap = MapPointer{new Map{"Second Map"}};
+    region->addMap(secondMap);
+    session->findMap("New Map 1")->getCoordinateSystem()->resize(12, 7);
+
+    QTemporaryDir folder;
+    ASSERT_TRUE(folder.isValid());
+    QFile file{folder.filePath("test.atlas")};
+    QStringList log;
+    ASSERT_TRUE(session->save(file, log));
+
+    SessionPointer loadedSession;
+    ASSERT_TRUE(Session::load(loadedSession, file, log));
+    auto map = loadedSession->findMap("New Map 1");
+    ASSERT_TRUE(map->isValid());
+    EXPECT_FALSE(map->isLoaded());
+    EXPECT_FALSE(loadedSession->findMap("Second Map")->isLoaded());
+
+    // first access loads the map
+    EXPECT_EQ(map->getCoordinateSystem()->getSize(), QSize(12, 7));
+    EXPECT_TRUE(map->isLoaded());
+    EXPECT_FALSE(map->isModified());
+    EXPECT_FALSE(loadedSession->findMap("Second Map")->isLoaded());
+
+    // unmodified maps unload, modified ones stay
+    EXPECT_TRUE(map->unload());
+    EXPECT_FALSE(map->isLoaded());
+    map->getCoordinateSystem()->resize(20, 20);
+    EXPECT_TRUE(map->isModified());
+    EXPECT_FALSE(map->unload());
+
+    // maps renamed or not loaded survive saving over the very file they are loaded from
+    map->setName("Renamed Map");
+    ASSERT_TRUE(loadedSession->save(file, log));
+    EXPECT_FALSE(map->isModified());
+    EXPECT_TRUE(map->unload());
+    EXPECT_EQ(map->getCoordinateSystem()->getSize(), QSize(20, 20));
+    EXPECT_EQ(map->getName(), "Renamed Map");
+
+    SessionPointer reloadedSession;
+    ASSERT_TRUE(Session::load(reloadedSession, file, log));
+    EXPECT_EQ(reloadedSession->findMap("Renamed Map")->getCoordinateSystem()->getSize(), QSize(20, 20));
+    EXPECT_TRUE(reloadedSession->findMap("Second Map")->isValid());
+
+    // a tile placed is a modification, even if the map JSON stays the same
+    auto reloadedMap = reloadedSession->findMap("Renamed Map");
+    EXPECT_FALSE(reloadedMap->isModified());
+    Tiles replaced;
+    auto tile = TileFactory::create(TileType::color, {{"color", "#808080"}});
+    ASSERT_TRUE(tile->isPlaceable(reloadedMap.data(), QPointF{1.0, 1.0}));
+    tile->place(replaced, reloadedMap.data(), QPointF{1.0, 1.0});
+    EXPECT_TRUE(reloadedMap->isModified());
+    EXPECT_FALSE(reloadedMap->unload());
+}
+
+
+TEST(SessionTest, LazyMapLoadFailure) {
+
+    auto session = Session::init();
+    Session::setCurrentSession(session);
+    session->findMap("New Map 1")->getCoordinateSystem()->resize(12, 7);
+
+    QTemporaryDir folder;
+    ASSERT_TRUE(folder.isValid());
+    QFile file{folder.filePath("test.atlas")};
+    QStringList log;
+    ASSERT_TRUE(session->save(file, log));
+
+    SessionPointer loadedSession;
+    ASSERT_TRUE(Session::load(loadedSession, file, log));
+    auto map = loadedSession->findMap("New Map 1");
+    ASSERT_FALSE(map->isLoaded());
+
+    // the atlas file is gone: the failure is remembered and the map stays empty
+    ASSERT_TRUE(file.remove());
+    EXPECT_NE(map->getCoordinateSystem()->getSize(), QSize(12, 7));
+    EXPECT_FALSE(map->isLoaded());
+    EXPECT_FALSE(map->getLoadError().isEmpty());
+
+    // the file is back, but the map is not read again
+    ASSERT_TRUE(session->save(file, log));
+    EXPECT_FALSE(map->load(log));
+    EXPECT_EQ(log.back(), map->getLoadError());
+    EXPECT_FALSE(map->isLoaded());
+}
+
+
+TEST(SessionTest, SaveWithUnreadableMap) {
+
+    auto session = Session::init();
+    Session::setCurrentSession(session);
+    session->findRegion("New Region 1")->addMap(MapPointer{new Map{"Second Map"}});
+    session->findMap("Second Map")->getCoordinateSystem()->resize(9, 5);
+
+    QTemporaryDir folder;
+    ASSERT_TRUE(folder.isValid());
+    QFile file{folder.filePath("test.atlas")};
+    QStringList log;
+    ASSERT_TRUE(session->save(file, log));
+
+    SessionPointer loadedSession;
+    ASSERT_TRUE(Session::load(loadedSession, file, log));
+    EXPECT_EQ(loadedSession->findMap("Second Map")->getCoordinateSystem()->getSize(), QSize(9, 5));
+    ASSERT_FALSE(loadedSession->findMap("New Map 1")->isLoaded());
+
+    // the map not loaded can be neither copied nor loaded: the rest of the atlas is still saved
+    ASSERT_TRUE(file.remove());
+    QFile savedFile{folder.filePath("saved.atlas")};
+    log.clear();
+    ASSERT_TRUE(loadedSession->save(savedFile, log));
+    EXPECT_TRUE(log.contains("Failed to add map: New Map 1, it is left out."));
+
+    SessionPointer savedSession;
+    ASSERT_TRUE(Session::load(savedSession, savedFile, log));
+    EXPECT_EQ(savedSession->findMap("Second Map")->getCoordinateSystem()->getSize(), QSize(9, 5));
+}
+
+
+/**
+ * AtlasLoader tests: the loader reports back through the event loop of a QCoreApplication.
+ */
+class AtlasLoaderTest : public ::testing::Test {
+
+    static int argc;                                /**< Argument count of the application. */
+    static char * argv[];                           /**< Arguments of the application. */
+    static QCoreApplication * application;          /**< The application running the tests. */
+
+public:
+
+    static void SetUpTestSuite() {
+        application = new QCoreApplication{argc, argv};
+    }
+
+    static void TearDownTestSuite() {
+        delete application;
+        application = nullptr;
+    }
+
+protected:
+
+    QTemporaryDir folder;                           /**< Holds the atlas file. */
+    QString fileName;                               /**< The atlas file to load. */
+    SessionPointer currentSession;                  /**< The current session while loading. */
+
+    void SetUp() override {
+        currentSession = Session::init();
+        Session::setCurrentSession(currentSession);
+        currentSession->getAtlas()->setName("Current Atlas");
+
+        auto session = Session::init();
+        session->getAtlas()->setName("Loaded Atlas");
+        session->findRegion("New Region 1")->addMap(MapPointer{new Map{"Second Map"}});
+        ASSERT_TRUE(folder.isValid());
+        fileName = folder.filePath("test.atlas");
+        QFile file{fileName};
+        QStringList log;
+        ASSERT_TRUE(session->save(file, log));
+    }
+
+    /**
+     * Runs a local event loop until the loader finished or failed (or a timeout).
+     *
+     * @param   loader      the loader started.
+     */
+    static void waitFor(AtlasLoader & loader) {
+        QEventLoop loop;
+        QObject::connect(&loader, &AtlasLoader::finished, &loop, &QEventLoop::quit);
+        QObject::connect(&loader, &AtlasLoader::failed, &loop, &QEventLoop::quit);
+        QTimer::singleShot(10000, &loop, &QEventLoop::quit);
+        loop.exec();
+    }
+};
+
+static char atlasLoaderTestName[] = "test-units";
+int AtlasLoaderTest::argc = 1;
+char * AtlasLoaderTest::argv[] = {atlasLoaderTestName, nullptr};
+QCoreApplication * AtlasLoaderTest::application = nullptr;
+
+
+TEST_F(AtlasLoaderTest, Load) {
+
+    AtlasLoader loader;
+    int lastDone = -1;
+    int lastTotal = -1;
+    QObject::connect(&loader, &AtlasLoader::progress, &loader, [&] (int done, int total) {
+        lastDone = done;
+        lastTotal = total;
+    });
+    SessionPointer loadedSession;
+    bool failed = false;
+    QObject::connect(&loader, &AtlasLoader::finished, [&] (SessionPointer session, QStringList) {
+        loadedSession = session;
+    });
+    QObject::connect(&loader, &AtlasLoader::failed, [&] (QStringList, bool) {
+        failed = true;
+    });
+
+    ASSERT_TRUE(loader.start(fileName));
+    EXPECT_TRUE(loader.isRunning());
+    EXPECT_FALSE(loader.start(fileName));
+    waitFor(loader);
+
+    EXPECT_FALSE(loader.isRunning());
+    EXPECT_FALSE(failed);
+    EXPECT_GT(lastTotal, 0);
+    EXPECT_EQ(lastDone, lastTotal);
+    ASSERT_TRUE(loadedSession.data() != nullptr);
+    EXPECT_EQ(loadedSession->getAtlas()->getName(), "Loaded Atlas");
+    EXPECT_TRUE(loadedSession->findMap("Second Map")->isValid());
+
+    // the receiver swaps the session in, not the loader
+    EXPECT_EQ(Session::getCurrentSession().data(), currentSession.data());
+    EXPECT_EQ(currentSession->getAtlas()->getName(), "Current Atlas");
+}
+
+
+TEST_F(AtlasLoaderTest, Cancel) {
+
+    AtlasLoader loader;
+
+    // cancel on the worker thread as soon as it reports, so it stops at the very next entry
+    QObject::connect(&loader, &AtlasLoader::progress, [&loader] (int, int) {
+        loader.cancel();
+    });
+    bool finished = false;
+    bool failed = false;
+    bool cancelled = false;
+    QObject::connect(&loader, &AtlasLoader::finished, [&] (SessionPointer, QStringList) {
+        finished = true;
+    });
+    QObject::connect(&loader, &AtlasLoader::failed, [&] (QStringList, bool wasCancelled) {
+        failed = true;
+        cancelled = wasCancelled;
+    });
+
+    ASSERT_TRUE(loader.start(fileName));
+    waitFor(loader);
+
+    EXPECT_FALSE(loader.isRunning());
+    EXPECT_FALSE(finished);
+    EXPECT_TRUE(failed);
+    EXPECT_TRUE(cancelled);
+    EXPECT_EQ(Session::getCurrentSession().data(), currentSession.data());
+    EXPECT_EQ(currentSession->getAtlas()->getName(), "Current Atlas");
+}
@@ -0,0 +1,59 @@
+/*
+ * This file is part of rpgmapper.
+ * See the LICENSE file for the software license.
+ * (C) Copyright 2018-2019, Oliver Maurhart, dyle71@gmail.com
+ */
+
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringList>
+
+#include <rpgmapper/trace.hpp>
+
+using namespace rpgmapper::model;
+
+
+TEST(Trace, DisabledTraceRecordsNothing) {
+
+    Trace::enable(false);
+    Trace::clear();
+    {
+        RPGMAPPER_TRACE_SCOPE("disabled");
+    }
+    
+    auto json = QJsonDocument::fromJson(Trace::getChromeTrace());
+    EXPECT_TRUE(json.object()["traceEvents"].toArray().isEmpty());
+}
+
+
+TEST(Trace, SpansOfMultipleThreads) {
+
+    Trace::enable();
+    Trace::clear();
+    {
+        RPGMAPPER_TRACE_SCOPE("main");
+        std::thread worker{[] { RPGMAPPER_TRACE_SCOPE("worker"); }};
+        worker.join();
+    }
+    Trace::enable(false);
+    
+    auto json = QJsonDocument::fromJson(Trace::getChromeTrace());
+    auto events = json.object()["traceEvents"].toArray();
+    ASSERT_EQ(events.size(), 2);
+    
+    QStringList names;
+    for (auto const & event : events) {
+        auto object = event.toObject();
+        EXPECT_EQ(object["ph"].toString(), "X");
+        EXPECT_GE(object["dur"].toDouble(), 0.0);
+        names << object["name"].toString();
+    }
+    EXPECT_TRUE(names.contains("main"));
+    EXPECT_TRUE(names.contains("worker"));
+    EXPECT_NE(events[0].toObject()["tid"].toInt(), events[1].toObject()["tid"].toInt());
+}